@@ -0,0 +1,55 @@
+/*
+ * Copyright 2021-2025 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdint.h>
+
+#include <esp_random.h>
+
+#include "backoff.h"
+
+void backoff_init(backoff_t *backoff,
+                  uint32_t base_ms,
+                  uint32_t max_ms,
+                  uint32_t jitter_percent) {
+    backoff->base_ms = base_ms;
+    backoff->max_ms = max_ms < base_ms ? base_ms : max_ms;
+    backoff->jitter_percent = jitter_percent > 100 ? 100 : jitter_percent;
+    backoff->attempt = 0;
+}
+
+uint32_t backoff_next_ms(backoff_t *backoff) {
+    uint64_t delay_ms = backoff->base_ms;
+    for (uint32_t i = 0; i < backoff->attempt && delay_ms < backoff->max_ms;
+         i++) {
+        delay_ms *= 2;
+    }
+    if (delay_ms > backoff->max_ms) {
+        delay_ms = backoff->max_ms;
+    }
+    if (backoff->attempt < UINT32_MAX) {
+        backoff->attempt++;
+    }
+
+    uint32_t jitter_ms = (uint32_t) (delay_ms * backoff->jitter_percent / 100);
+    if (jitter_ms) {
+        delay_ms -= esp_random() % (jitter_ms + 1);
+    }
+    return (uint32_t) delay_ms;
+}
+
+void backoff_reset(backoff_t *backoff) {
+    backoff->attempt = 0;
+}
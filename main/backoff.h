@@ -0,0 +1,50 @@
+/*
+ * Copyright 2021-2025 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef BACKOFF_H
+#define BACKOFF_H
+
+#include <stdint.h>
+
+/**
+ * Exponential backoff with jitter. The n-th consecutive delay is
+ * base_ms * 2^(n-1), capped at max_ms, and then reduced by a random amount of
+ * up to jitter_percent percent, so that many devices losing the same access
+ * point do not retry in lockstep.
+ */
+typedef struct {
+    uint32_t base_ms;
+    uint32_t max_ms;
+    uint32_t jitter_percent;
+    uint32_t attempt;
+} backoff_t;
+
+void backoff_init(backoff_t *backoff,
+                  uint32_t base_ms,
+                  uint32_t max_ms,
+                  uint32_t jitter_percent);
+
+/**
+ * Returns the delay before the next attempt and advances to the following one.
+ */
+uint32_t backoff_next_ms(backoff_t *backoff);
+
+/**
+ * Starts over from base_ms; to be called after a successful attempt.
+ */
+void backoff_reset(backoff_t *backoff);
+
+#endif // BACKOFF_H
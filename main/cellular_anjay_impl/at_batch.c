@@ -0,0 +1,118 @@
+/*
+ * Copyright 2021-2025 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <avsystem/commons/avs_log.h>
+
+#include <cellular_api.h>
+#include <cellular_common.h>
+
+#include "at_batch.h"
+#include "net_impl.h"
+
+#define AT_BATCH_PREFIX "AT"
+#define AT_BATCH_SEPARATOR ';'
+
+static bool send_line(const char *line) {
+    return Cellular_ATCommandRaw(CellularHandle, NULL, line,
+                                 CELLULAR_AT_NO_RESULT, NULL, NULL, 0)
+           == CELLULAR_SUCCESS;
+}
+
+// Resends the commands of a rejected batch separately. Separators are not
+// expected inside arguments of the batched commands.
+static int send_separately(char *line) {
+    char command[CELLULAR_AT_CMD_MAX_SIZE];
+    int result = 0;
+    char *save_ptr = NULL;
+
+    static const char SEPARATORS[] = { AT_BATCH_SEPARATOR, '\0' };
+
+    for (char *token = strtok_r(line + strlen(AT_BATCH_PREFIX), SEPARATORS,
+                                &save_ptr);
+         token;
+         token = strtok_r(NULL, SEPARATORS, &save_ptr)) {
+        snprintf(command, sizeof(command), AT_BATCH_PREFIX "%s", token);
+        if (!send_line(command)) {
+            avs_log(at_batch, ERROR, "%s rejected", command);
+            result = -1;
+        }
+    }
+    return result;
+}
+
+void at_batch_init(at_batch_t *batch) {
+    memset(batch, 0, sizeof(*batch));
+}
+
+static void send_pending(at_batch_t *batch) {
+    if (!batch->count) {
+        return;
+    }
+    if (!send_line(batch->line)) {
+        if (batch->count > 1) {
+            batch->result |= send_separately(batch->line);
+        } else {
+            avs_log(at_batch, ERROR, "%s rejected", batch->line);
+            batch->result = -1;
+        }
+    }
+    batch->length = 0;
+    batch->count = 0;
+}
+
+void at_batch_add(at_batch_t *batch, const char *format, ...) {
+    char command[CELLULAR_AT_CMD_MAX_SIZE];
+    va_list ap;
+    va_start(ap, format);
+    int command_length = vsnprintf(command, sizeof(command), format, ap);
+    va_end(ap);
+
+    size_t max_command_length =
+            sizeof(batch->line) - strlen(AT_BATCH_PREFIX) - 1;
+    if (command_length < 0 || (size_t) command_length > max_command_length) {
+        avs_log(at_batch, ERROR, "AT command too long");
+        batch->result = -1;
+        return;
+    }
+
+    // One byte for the separator, one for the terminating nul
+    if (batch->count
+            && batch->length + 1 + (size_t) command_length + 1
+                           > sizeof(batch->line)) {
+        send_pending(batch);
+    }
+    if (!batch->count) {
+        batch->length = (size_t) snprintf(batch->line, sizeof(batch->line),
+                                          AT_BATCH_PREFIX "%s", command);
+    } else {
+        batch->line[batch->length++] = AT_BATCH_SEPARATOR;
+        memcpy(&batch->line[batch->length], command,
+               (size_t) command_length + 1);
+        batch->length += (size_t) command_length;
+    }
+    batch->count++;
+}
+
+int at_batch_flush(at_batch_t *batch) {
+    send_pending(batch);
+    return batch->result;
+}
@@ -0,0 +1,55 @@
+/*
+ * Copyright 2021-2025 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef AT_BATCH_H
+#define AT_BATCH_H
+
+#include <stddef.h>
+
+#include <cellular_config_defaults.h>
+
+/**
+ * Accumulates AT commands that do not return data and sends them
+ * concatenated ("AT+A=1;+B=2"), so that a sequence of settings costs one
+ * request/response exchange instead of one per command. The batch is flushed
+ * automatically when the next command would exceed the modem line length.
+ */
+typedef struct {
+    char line[CELLULAR_AT_CMD_MAX_SIZE];
+    size_t length;
+    size_t count;
+    // Sticky, -1 after any command has failed
+    int result;
+} at_batch_t;
+
+void at_batch_init(at_batch_t *batch);
+
+/**
+ * Appends a command given without the "AT" prefix, e.g. "+QSSLCFG=...".
+ */
+void at_batch_add(at_batch_t *batch, const char *format, ...)
+        __attribute__((format(printf, 2, 3)));
+
+/**
+ * Sends pending commands. If the modem rejects the concatenated line, the
+ * commands are retried one by one so that the failing one can be reported.
+ *
+ * @returns 0 if every command added since @ref at_batch_init succeeded, -1
+ * otherwise.
+ */
+int at_batch_flush(at_batch_t *batch);
+
+#endif // AT_BATCH_H
@@ -14,66 +14,31 @@
  * limitations under the License.
  */
 
-#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 
-#include <freertos/FreeRTOS.h>
-#include <freertos/task.h>
-
-#include <avsystem/commons/avs_list.h>
-#include <avsystem/commons/avs_log.h>
 #include <avsystem/commons/avs_socket.h>
 
-#include <anjay/anjay.h>
-
-#include "cellular_event_loop.h"
+#include "../event_loop.h"
 #include "net_impl.h"
 
-#define CELLULAR_EVENT_LOOP_MAX_WAIT_TIME 100
-
-static volatile atomic_bool event_loop_status;
-
-int cellular_event_loop_run(anjay_t *anjay) {
-    if (!atomic_compare_exchange_strong(&event_loop_status, &(bool) { false },
-                                        true)) {
-        avs_log(cellular_event_loop, ERROR, "Event loop is already running");
-        return -1;
-    }
-
-    while (atomic_load(&event_loop_status)) {
-        AVS_LIST(avs_net_socket_t *const) sockets = anjay_get_sockets(anjay);
-        AVS_LIST(avs_net_socket_t *const) socket = NULL;
-
-        int wait_ms = anjay_sched_calculate_wait_time_ms(
-                anjay, CELLULAR_EVENT_LOOP_MAX_WAIT_TIME);
-
-        if (sockets) {
-            AVS_LIST_FOREACH(socket, sockets) {
-                if (socket != NULL) {
-                    bool data_received = false;
-                    net_impl_check_modem_buffer(
-                            (avs_net_socket_t *) avs_net_socket_get_system(
-                                    *socket),
-                            &data_received, wait_ms / AVS_LIST_SIZE(sockets));
-                    if (data_received) {
-                        int error = anjay_serve(anjay, *socket);
-                        if (error) {
-                            avs_log(cellular_event_loop, ERROR,
-                                    "anjay_serve failed, error code %d", error);
-                        }
-                    }
-                }
-            }
-        } else {
-            vTaskDelay(pdMS_TO_TICKS(wait_ms));
-        }
-        anjay_sched_run(anjay);
-    }
-    return 0;
+static int bg96_select(const void *const *system_sockets,
+                       size_t sockets_count,
+                       bool *out_ready,
+                       uint32_t timeout_ms) {
+    return net_impl_select((avs_net_socket_t *const *) system_sockets,
+                           sockets_count, out_ready, timeout_ms);
 }
 
-int cellular_event_loop_interrupt(void) {
-    return atomic_compare_exchange_strong(&event_loop_status, &(bool) { true },
-                                          false)
-                   ? 0
-                   : -1;
+static void bg96_served(const void *system_socket) {
+    // The modem does not repeat +QIURC: "recv" until its buffer is drained
+    net_impl_rearm_data_ready((avs_net_socket_t *) system_socket);
 }
+
+const event_loop_backend_t EVENT_LOOP_BACKEND_BG96 = {
+    .name = "bg96",
+    .select = bg96_select,
+    .served = bg96_served,
+    .wakeup = net_impl_wakeup
+};
@@ -0,0 +1,215 @@
+/*
+ * Copyright 2021-2025 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <nvs.h>
+
+#include <avsystem/commons/avs_defs.h>
+#include <avsystem/commons/avs_log.h>
+#include <avsystem/commons/avs_time.h>
+#include <avsystem/commons/avs_utils.h>
+
+#include <cellular_types.h>
+
+#include "../storage.h"
+#include "dns_cache.h"
+#include "sdkconfig.h"
+
+#define DNS_CACHE_SIZE 4
+#define DNS_CACHE_NVS_NAMESPACE "dns_cache"
+// Longest hostname that fits a single storage_write_str() value
+#define DNS_CACHE_PERSISTED_HOST_MAX_SIZE 65
+
+typedef struct {
+    char host[256];
+    char ip[CELLULAR_IP_ADDRESS_MAX_SIZE + 1];
+    avs_time_monotonic_t expires;
+} dns_cache_entry_t;
+
+static dns_cache_entry_t entries[DNS_CACHE_SIZE];
+static bool entries_loaded;
+// Host whose most recent lookup was answered from the cache
+static char last_hit_host[sizeof(entries[0].host)];
+
+static bool entry_valid(const dns_cache_entry_t *entry) {
+    return entry->host[0]
+           && avs_time_monotonic_before(avs_time_monotonic_now(),
+                                        entry->expires);
+}
+
+static avs_time_monotonic_t new_expiration_time(void) {
+    return avs_time_monotonic_add(
+            avs_time_monotonic_now(),
+            avs_time_duration_from_scalar(CONFIG_ANJAY_CLIENT_DNS_CACHE_TTL,
+                                          AVS_TIME_S));
+}
+
+static dns_cache_entry_t *find_entry(const char *host) {
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(entries); i++) {
+        if (entries[i].host[0] && !strcmp(entries[i].host, host)) {
+            return &entries[i];
+        }
+    }
+    return NULL;
+}
+
+#ifdef CONFIG_ANJAY_CLIENT_DNS_CACHE_PERSIST
+static void make_keys(size_t index,
+                      char *host_key,
+                      char *ip_key,
+                      size_t key_size) {
+    snprintf(host_key, key_size, "host%u", (unsigned) index);
+    snprintf(ip_key, key_size, "ip%u", (unsigned) index);
+}
+
+// Persisted entries carry no timestamp, as there is no reliable wall clock
+// before the modem registers; they are loaded as already expired, so they are
+// only used when resolving the host fails
+static void load_entries(void) {
+    nvs_handle_t nvs_h;
+    if (nvs_open(DNS_CACHE_NVS_NAMESPACE, NVS_READONLY, &nvs_h)) {
+        return;
+    }
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(entries); i++) {
+        char host_key[NVS_KEY_NAME_MAX_SIZE];
+        char ip_key[NVS_KEY_NAME_MAX_SIZE];
+        make_keys(i, host_key, ip_key, sizeof(host_key));
+        if (nvs_get_str(nvs_h, host_key, entries[i].host,
+                        &(size_t) { sizeof(entries[i].host) })
+                || nvs_get_str(nvs_h, ip_key, entries[i].ip,
+                               &(size_t) { sizeof(entries[i].ip) })) {
+            memset(&entries[i], 0, sizeof(entries[i]));
+            continue;
+        }
+        entries[i].expires = avs_time_monotonic_now();
+    }
+    nvs_close(nvs_h);
+}
+
+static void persist_entry(const dns_cache_entry_t *entry) {
+    size_t index = (size_t) (entry - entries);
+    char host_key[NVS_KEY_NAME_MAX_SIZE];
+    char ip_key[NVS_KEY_NAME_MAX_SIZE];
+    make_keys(index, host_key, ip_key, sizeof(host_key));
+
+    if (strlen(entry->host) >= DNS_CACHE_PERSISTED_HOST_MAX_SIZE) {
+        storage_write_str(DNS_CACHE_NVS_NAMESPACE, host_key, "");
+        return;
+    }
+    storage_write_str(DNS_CACHE_NVS_NAMESPACE, ip_key, entry->ip);
+    storage_write_str(DNS_CACHE_NVS_NAMESPACE, host_key, entry->host);
+}
+#else  // CONFIG_ANJAY_CLIENT_DNS_CACHE_PERSIST
+static void load_entries(void) {}
+
+static void persist_entry(const dns_cache_entry_t *entry) {
+    (void) entry;
+}
+#endif // CONFIG_ANJAY_CLIENT_DNS_CACHE_PERSIST
+
+static int lookup(const char *host,
+                  bool allow_expired,
+                  char *out_ip,
+                  size_t out_ip_size) {
+    if (CONFIG_ANJAY_CLIENT_DNS_CACHE_TTL <= 0) {
+        return -1;
+    }
+    if (!entries_loaded) {
+        load_entries();
+        entries_loaded = true;
+    }
+
+    const dns_cache_entry_t *entry = find_entry(host);
+    if (!entry || (!allow_expired && !entry_valid(entry))
+            || avs_simple_snprintf(out_ip, out_ip_size, "%s", entry->ip) < 0) {
+        return -1;
+    }
+    strcpy(last_hit_host, entry->host);
+    return 0;
+}
+
+int dns_cache_lookup(const char *host, char *out_ip, size_t out_ip_size) {
+    return lookup(host, false, out_ip, out_ip_size);
+}
+
+int dns_cache_lookup_fallback(const char *host,
+                              char *out_ip,
+                              size_t out_ip_size) {
+    return lookup(host, true, out_ip, out_ip_size);
+}
+
+void dns_cache_store(const char *host, const char *ip) {
+    if (CONFIG_ANJAY_CLIENT_DNS_CACHE_TTL <= 0
+            || strlen(host) >= sizeof(entries[0].host)
+            || strlen(ip) >= sizeof(entries[0].ip)) {
+        return;
+    }
+
+    dns_cache_entry_t *entry = find_entry(host);
+    if (!entry) {
+        entry = &entries[0];
+        for (size_t i = 1; i < AVS_ARRAY_SIZE(entries); i++) {
+            if (!entries[i].host[0]) {
+                entry = &entries[i];
+                break;
+            }
+            if (avs_time_monotonic_before(entries[i].expires,
+                                          entry->expires)) {
+                entry = &entries[i];
+            }
+        }
+        if (entry->host[0]) {
+            avs_log(dns_cache, DEBUG, "Evicting %s", entry->host);
+        }
+    }
+
+    if (!strcmp(last_hit_host, host)) {
+        last_hit_host[0] = '\0';
+    }
+    bool changed = strcmp(entry->host, host) || strcmp(entry->ip, ip);
+    strcpy(entry->host, host);
+    strcpy(entry->ip, ip);
+    entry->expires = new_expiration_time();
+    if (changed) {
+        persist_entry(entry);
+    }
+}
+
+void dns_cache_invalidate(const char *host) {
+    if (!strcmp(last_hit_host, host)) {
+        last_hit_host[0] = '\0';
+    }
+    dns_cache_entry_t *entry = find_entry(host);
+    if (entry) {
+        avs_log(dns_cache, DEBUG, "Invalidating %s (%s)", host, entry->ip);
+        memset(entry, 0, sizeof(*entry));
+        persist_entry(entry);
+    }
+}
+
+int dns_cache_invalidate_last_hit(void) {
+    if (!last_hit_host[0]) {
+        return -1;
+    }
+    char host[sizeof(last_hit_host)];
+    strcpy(host, last_hit_host);
+    dns_cache_invalidate(host);
+    return 0;
+}
@@ -0,0 +1,62 @@
+/*
+ * Copyright 2021-2025 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DNS_CACHE_H
+#define DNS_CACHE_H
+
+#include <stddef.h>
+
+/**
+ * Looks up a previously resolved address of @p host. Entries expire after
+ * CONFIG_ANJAY_CLIENT_DNS_CACHE_TTL seconds; with
+ * CONFIG_ANJAY_CLIENT_DNS_CACHE_PERSIST they are restored from NVS on first
+ * use after boot, already expired.
+ *
+ * @returns 0 if a valid entry was found and copied to @p out_ip, -1 otherwise.
+ */
+int dns_cache_lookup(const char *host, char *out_ip, size_t out_ip_size);
+
+/**
+ * Same as dns_cache_lookup(), but returns expired entries as well. Meant as a
+ * last resort when resolving @p host fails.
+ */
+int dns_cache_lookup_fallback(const char *host,
+                              char *out_ip,
+                              size_t out_ip_size);
+
+/**
+ * Stores a resolved address of @p host, replacing the entry closest to
+ * expiration if the cache is full.
+ */
+void dns_cache_store(const char *host, const char *ip);
+
+/**
+ * Drops the entry for @p host, e.g. after connecting to the cached address
+ * failed.
+ */
+void dns_cache_invalidate(const char *host);
+
+/**
+ * Drops the entry of the host whose most recent lookup was answered from the
+ * cache, unless it has been resolved again since. Used when the connection
+ * failed past the connect call, e.g. in the DTLS handshake or registration.
+ *
+ * @returns 0 if an entry was dropped, -1 if the last lookup was not a cache
+ *          hit.
+ */
+int dns_cache_invalidate_last_hit(void);
+
+#endif // DNS_CACHE_H
@@ -0,0 +1,68 @@
+/*
+ * Copyright 2021-2025 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <inttypes.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <esp_timer.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <avsystem/commons/avs_log.h>
+#include <avsystem/commons/avs_time.h>
+
+#include <cellular_api.h>
+#include <cellular_setup.h>
+
+#include "modem_bringup.h"
+#include "net_impl.h"
+#include "uart_link.h"
+
+#define MODEM_BRINGUP_RETRY_DELAY_MS 100
+
+static int64_t elapsed_ms(avs_time_monotonic_t since) {
+    int64_t result = 0;
+    avs_time_duration_to_scalar(
+            &result, AVS_TIME_MS,
+            avs_time_monotonic_diff(avs_time_monotonic_now(), since));
+    return result;
+}
+
+void modem_bringup_run(void) {
+    avs_time_monotonic_t start = avs_time_monotonic_now();
+    unsigned attempts = 1;
+
+    while (!setupCellular()) {
+        avs_log(modem_bringup, WARNING, "Cellular setup has failed");
+        uart_link_restore_defaults();
+        Cellular_Cleanup(CellularHandle);
+        vTaskDelay(pdMS_TO_TICKS(MODEM_BRINGUP_RETRY_DELAY_MS));
+        attempts++;
+    }
+    int64_t setup_ms = elapsed_ms(start);
+    int64_t registered_since_boot_ms = esp_timer_get_time() / 1000;
+
+    avs_time_monotonic_t phase_start = avs_time_monotonic_now();
+    uint32_t baud_rate = uart_link_negotiate();
+    int64_t uart_ms = elapsed_ms(phase_start);
+
+    avs_log(modem_bringup, INFO,
+            "Registered %" PRId64 " ms after boot; setup %" PRId64
+            " ms (%u attempt(s)), UART %" PRIu32 " baud in %" PRId64 " ms",
+            registered_since_boot_ms, setup_ms, attempts, baud_rate, uart_ms);
+}
@@ -13,13 +13,15 @@
  * See the License for the specific language governing permissions and
  * limitations under the License.
  */
-#ifndef CELLULAR_EVENT_LOOP_H
-#define CELLULAR_EVENT_LOOP_H
 
-#include <anjay/core.h>
+#ifndef MODEM_BRINGUP_H
+#define MODEM_BRINGUP_H
 
-int cellular_event_loop_run(anjay_t *anjay);
-
-int cellular_event_loop_interrupt(void);
+/**
+ * Brings the modem up to a registered state with an active PDN and tunes the
+ * UART link, retrying until it succeeds. The time of each phase, and of the
+ * whole bring-up since boot, is logged.
+ */
+void modem_bringup_run(void);
 
-#endif // CELLULAR_EVENT_LOOP_H
+#endif // MODEM_BRINGUP_H
@@ -0,0 +1,176 @@
+/*
+ * Copyright 2021-2025 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <avsystem/commons/avs_log.h>
+#include <avsystem/commons/avs_time.h>
+
+#include <cellular_api.h>
+#include <cellular_at_core.h>
+#include <cellular_common.h>
+
+#include "modem_status.h"
+#include "net_impl.h"
+#include "power_saving.h"
+#include "sdkconfig.h"
+
+// Lower bound on the refresh period for on-demand refreshes
+#define MODEM_STATUS_MIN_REFRESH_PERIOD_S 5
+
+// Field positions in +QENG: "servingcell" for LTE (eMTC and NB-IoT) after the
+// prefix: "servingcell",<state>,<rat>,<is_tdd>,<mcc>,<mnc>,<cellid>,<pcid>,
+// <earfcn>,<band>,<ul_bw>,<dl_bw>,<tac>,<rsrp>,<rsrq>,<rssi>,<sinr>,...
+#define QENG_FIELD_RAT 2
+#define QENG_FIELD_MCC 4
+#define QENG_FIELD_MNC 5
+#define QENG_FIELD_CELL_ID 6
+#define QENG_FIELD_TAC 12
+#define QENG_FIELD_RSRP 13
+#define QENG_FIELD_RSRQ 14
+#define QENG_FIELD_SINR 16
+#define QENG_FIELD_COUNT 17
+
+static modem_status_t status;
+static avs_time_monotonic_t last_refresh;
+static bool refresh_requested;
+
+static modem_status_rat_t parse_rat(const char *rat) {
+    if (!strcmp(rat, "CAT-M") || !strcmp(rat, "eMTC")) {
+        return MODEM_STATUS_RAT_LTE_M;
+    } else if (!strcmp(rat, "CAT-NB") || !strcmp(rat, "NBIoT")) {
+        return MODEM_STATUS_RAT_NB_IOT;
+    } else if (!strcmp(rat, "GSM")) {
+        return MODEM_STATUS_RAT_GSM;
+    }
+    return MODEM_STATUS_RAT_UNKNOWN;
+}
+
+static CellularPktStatus_t
+serving_cell_callback(CellularHandle_t cellular_handle,
+                      const CellularATCommandResponse_t *at_resp,
+                      void *data,
+                      uint16_t data_len) {
+    (void) cellular_handle;
+    (void) data_len;
+    modem_status_t *out = (modem_status_t *) data;
+    char *fields[QENG_FIELD_COUNT] = { NULL };
+    char *line;
+    size_t count = 0;
+
+    if (!at_resp || !at_resp->status || !at_resp->pItm
+            || !(line = at_resp->pItm->pLine)
+            || Cellular_ATRemovePrefix(&line) != CELLULAR_AT_SUCCESS
+            || Cellular_ATRemoveAllDoubleQuote(line) != CELLULAR_AT_SUCCESS) {
+        return CELLULAR_PKT_STATUS_BAD_RESPONSE;
+    }
+    while (count < QENG_FIELD_COUNT
+           && Cellular_ATGetNextTok(&line, &fields[count])
+                      == CELLULAR_AT_SUCCESS) {
+        count++;
+    }
+    if (count <= QENG_FIELD_RAT) {
+        return CELLULAR_PKT_STATUS_BAD_RESPONSE;
+    }
+
+    out->rat = parse_rat(fields[QENG_FIELD_RAT]);
+    if (out->rat != MODEM_STATUS_RAT_LTE_M
+            && out->rat != MODEM_STATUS_RAT_NB_IOT) {
+        // Not camped on an LTE cell, e.g. "SEARCH" or GSM fallback
+        out->valid = false;
+        return CELLULAR_PKT_STATUS_OK;
+    }
+    if (count < QENG_FIELD_COUNT) {
+        return CELLULAR_PKT_STATUS_BAD_RESPONSE;
+    }
+    out->mcc = (uint16_t) strtoul(fields[QENG_FIELD_MCC], NULL, 10);
+    out->mnc = (uint16_t) strtoul(fields[QENG_FIELD_MNC], NULL, 10);
+    out->cell_id = (uint32_t) strtoul(fields[QENG_FIELD_CELL_ID], NULL, 16);
+    out->tac = (uint16_t) strtoul(fields[QENG_FIELD_TAC], NULL, 16);
+    out->rsrp_dbm = (int32_t) strtol(fields[QENG_FIELD_RSRP], NULL, 10);
+    out->rsrq_db = (int32_t) strtol(fields[QENG_FIELD_RSRQ], NULL, 10);
+    // Reported as 0..250, mapping linearly to -20..30 dB
+    out->sinr_db =
+            (int32_t) strtol(fields[QENG_FIELD_SINR], NULL, 10) / 5 - 20;
+    out->valid = true;
+    return CELLULAR_PKT_STATUS_OK;
+}
+
+static bool refresh_due(void) {
+    avs_time_duration_t age =
+            avs_time_monotonic_diff(avs_time_monotonic_now(), last_refresh);
+    if (!avs_time_monotonic_valid(last_refresh)
+            || !avs_time_duration_less(
+                       age,
+                       avs_time_duration_from_scalar(
+                               CONFIG_ANJAY_CLIENT_MODEM_STATUS_INTERVAL,
+                               AVS_TIME_S))) {
+        return true;
+    }
+    return refresh_requested
+           && !avs_time_duration_less(
+                      age, avs_time_duration_from_scalar(
+                                   MODEM_STATUS_MIN_REFRESH_PERIOD_S,
+                                   AVS_TIME_S));
+}
+
+const modem_status_t *modem_status_get(void) {
+    return &status;
+}
+
+void modem_status_request_refresh(void) {
+    refresh_requested = true;
+}
+
+bool modem_status_refresh(void) {
+    if (!refresh_due() || power_saving_modem_may_sleep()) {
+        return false;
+    }
+    last_refresh = avs_time_monotonic_now();
+    refresh_requested = false;
+
+    modem_status_t updated = status;
+    if (Cellular_ATCommandRaw(CellularHandle, "+QENG",
+                              "AT+QENG=\"servingcell\"",
+                              CELLULAR_AT_WITH_PREFIX, serving_cell_callback,
+                              &updated, sizeof(updated))
+            != CELLULAR_SUCCESS) {
+        avs_log(modem_status, DEBUG, "Could not read serving cell");
+        return false;
+    }
+
+    // A new serving cell may mean a new attach, and so a new address
+    if (!status.valid || !updated.valid || updated.cell_id != status.cell_id
+            || !updated.ip_address[0]) {
+        memset(updated.ip_address, 0, sizeof(updated.ip_address));
+        if (Cellular_GetIPAddress(CellularHandle, CellularSocketPdnContextId,
+                                  updated.ip_address,
+                                  sizeof(updated.ip_address))
+                != CELLULAR_SUCCESS) {
+            updated.ip_address[0] = '\0';
+        }
+    }
+
+    if (!memcmp(&updated, &status, sizeof(status))) {
+        return false;
+    }
+    status = updated;
+    return true;
+}
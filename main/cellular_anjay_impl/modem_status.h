@@ -0,0 +1,71 @@
+/*
+ * Copyright 2021-2025 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MODEM_STATUS_H
+#define MODEM_STATUS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <cellular_config_defaults.h>
+
+typedef enum {
+    MODEM_STATUS_RAT_UNKNOWN,
+    MODEM_STATUS_RAT_GSM,
+    MODEM_STATUS_RAT_LTE_M,
+    MODEM_STATUS_RAT_NB_IOT
+} modem_status_rat_t;
+
+typedef struct {
+    // false until the serving cell has been read successfully
+    bool valid;
+    modem_status_rat_t rat;
+    int32_t rsrp_dbm;
+    int32_t rsrq_db;
+    int32_t sinr_db;
+    uint32_t cell_id;
+    uint16_t tac;
+    uint16_t mcc;
+    uint16_t mnc;
+    char ip_address[CELLULAR_IP_ADDRESS_MAX_SIZE + 1];
+} modem_status_t;
+
+/**
+ * Returns the cached radio status. Never talks to the modem, so it is safe to
+ * call from data model handlers.
+ */
+const modem_status_t *modem_status_get(void);
+
+/**
+ * Refreshes the cache if it is older than CONFIG_ANJAY_CLIENT_MODEM_STATUS_
+ * INTERVAL seconds, or if @ref modem_status_request_refresh has been called
+ * and at least the minimum refresh period has passed. Serving cell parameters
+ * and signal quality come from a single AT+QENG query; the IP address is only
+ * queried again when the serving cell changes.
+ *
+ * Skipped while the modem may be in PSM.
+ *
+ * @returns true if the cached values have changed.
+ */
+bool modem_status_refresh(void);
+
+/**
+ * Marks the cache as wanted, e.g. after a server read of stale values, so
+ * that the next @ref modem_status_refresh call updates it early.
+ */
+void modem_status_request_refresh(void);
+
+#endif // MODEM_STATUS_H
@@ -26,6 +26,7 @@
 
 #include <freertos/FreeRTOS.h>
 #include <freertos/event_groups.h>
+#include <freertos/task.h>
 
 #include <avsystem/commons/avs_errno.h>
 #include <avsystem/commons/avs_log.h>
@@ -33,19 +34,31 @@
 #include <avsystem/commons/avs_time.h>
 #include <avsystem/commons/avs_utils.h>
 
+#include <cellular_api.h>
 #include <cellular_common.h>
+#include <cellular_config_defaults.h>
 #include <cellular_setup.h>
 #include <sockets_wrapper.h>
 
+#include "dns_cache.h"
 #include "net_impl.h"
+#include "power_saving.h"
+#include "tls_offload.h"
 
 #define QIRD_COMMA_COUNT 2U
 #define SOCKET_HAS_BUFFERED_DATA_EVENT_BIT (1UL << 0)
 #define SOCKET_HAS_BUFFERED_DATA_VAL_BIT (1UL << 1)
+#define SOCKET_TLS_DATA_READY_BIT (1UL << 2)
 #define SOCKET_HAS_BUFFERED_EVENT_TIMEOUT_MS 50U
+#define DATA_READY_WAKEUP_BIT (1UL << 23)
+AVS_STATIC_ASSERT(CELLULAR_NUM_SOCKET_MAX <= 23, socket_bits_fit_event_group);
 
 static const avs_net_socket_v_table_t NET_SOCKET_VTABLE;
 
+static avs_error_t net_remote_hostname(avs_net_socket_t *sock_,
+                                       char *out_buffer,
+                                       size_t out_buffer_size);
+
 avs_error_t _avs_net_initialize_global_compat_state(void);
 void _avs_net_cleanup_global_compat_state(void);
 avs_error_t _avs_net_create_tcp_socket(avs_net_socket_t **socket,
@@ -63,8 +76,90 @@ typedef struct {
     char remote_hostname[256];
     size_t bytes_sent;
     size_t bytes_received;
+    EventBits_t data_ready_bit;
+    CellularSocketDataReadyCallback_t prev_data_ready_callback;
+    void *prev_data_ready_callback_context;
+    // TLS is terminated in the modem, see tls_offload.h. The handle only
+    // reserves the connect ID in the cellular library.
+    bool tls_offload;
+    CellularSocketHandle_t tls_handle;
+    uint16_t remote_port;
+    bool tls_maybe_buffered;
 } net_socket_impl_t;
 
+// Shared by all sockets, so that the event loop can sleep on a single wait
+// until the modem reports incoming data on any of them
+static EventGroupHandle_t data_ready_event_group;
+
+static net_impl_traffic_stats_t traffic_stats;
+
+static void account_traffic(net_socket_impl_t *sock, size_t size, bool sent) {
+    if (sent) {
+        sock->bytes_sent += size;
+        traffic_stats.bytes_sent += size;
+        traffic_stats.messages_sent++;
+    } else {
+        sock->bytes_received += size;
+        traffic_stats.bytes_received += size;
+        traffic_stats.messages_received++;
+    }
+    traffic_stats.max_message_size =
+            AVS_MAX(traffic_stats.max_message_size, size);
+}
+
+static EventGroupHandle_t get_data_ready_event_group(void) {
+    if (!data_ready_event_group) {
+        data_ready_event_group = xEventGroupCreate();
+    }
+    return data_ready_event_group;
+}
+
+// Called from the cellular library context on +QIURC: "recv"
+static void data_ready_callback(CellularSocketHandle_t socket_handle,
+                                void *context) {
+    net_socket_impl_t *sock = (net_socket_impl_t *) context;
+
+    xEventGroupSetBits(data_ready_event_group, sock->data_ready_bit);
+    // sockets_wrapper relies on its own callback to wake up blocking receives
+    if (sock->prev_data_ready_callback) {
+        sock->prev_data_ready_callback(socket_handle,
+                                       sock->prev_data_ready_callback_context);
+    }
+}
+
+// Sockets with offloaded TLS, indexed by connect ID
+static net_socket_impl_t *tls_sockets[CELLULAR_NUM_SOCKET_MAX];
+
+// Called from the cellular library context on +QSSLURC: "recv" or "closed"
+static void tls_data_ready_callback(uint8_t connect_id, void *context) {
+    (void) context;
+    net_socket_impl_t *sock = tls_sockets[connect_id];
+
+    if (sock) {
+        xEventGroupSetBits(sock->event_group, SOCKET_TLS_DATA_READY_BIT);
+        xEventGroupSetBits(data_ready_event_group, sock->data_ready_bit);
+    }
+}
+
+static int register_data_ready_callback(net_socket_impl_t *sock) {
+    CellularSocketHandle_t handle = sock->cell_socket->cellularSocketHandle;
+
+    if (!get_data_ready_event_group()) {
+        return -1;
+    }
+    sock->data_ready_bit = 1UL << handle->socketId;
+    sock->prev_data_ready_callback = handle->dataReadyCallback;
+    sock->prev_data_ready_callback_context = handle->pDataReadyCallbackContext;
+    xEventGroupClearBits(data_ready_event_group, sock->data_ready_bit);
+    if (Cellular_SocketRegisterDataReadyCallback(
+                CellularHandle, handle, data_ready_callback, sock)
+            != CELLULAR_SUCCESS) {
+        sock->data_ready_bit = 0;
+        return -1;
+    }
+    return 0;
+}
+
 static void cleanup_socket(net_socket_impl_t *sock) {
     if (sock->event_group) {
         vEventGroupDelete(sock->event_group);
@@ -97,6 +192,7 @@ net_create_socket(avs_net_socket_t **socket_ptr,
     socket->socktype = socktype;
     socket->socket_state = AVS_NET_SOCKET_STATE_CLOSED;
     socket->recv_timeout = avs_time_duration_from_scalar(30, AVS_TIME_S);
+    socket->tls_offload = socktype == SOCK_STREAM && tls_offload_enabled();
 
     xEventGroupClearBits(socket->event_group,
                          SOCKET_HAS_BUFFERED_DATA_EVENT_BIT
@@ -107,6 +203,57 @@ net_create_socket(avs_net_socket_t **socket_ptr,
     return AVS_OK;
 }
 
+static int resolve_host(const char *host, char *out_ip) {
+    if (Cellular_GetHostByName(CellularHandle, CellularSocketPdnContextId, host,
+                               out_ip)) {
+        return -1;
+    }
+    dns_cache_store(host, out_ip);
+    return 0;
+}
+
+static void release_tls_handle(net_socket_impl_t *sock) {
+    if (sock->tls_handle) {
+        tls_sockets[sock->tls_handle->socketId] = NULL;
+        Cellular_SocketClose(CellularHandle, sock->tls_handle);
+        sock->tls_handle = NULL;
+    }
+}
+
+static avs_error_t tls_connect(net_socket_impl_t *sock,
+                               const char *host,
+                               uint16_t port,
+                               uint32_t timeout_ms) {
+    if (!get_data_ready_event_group()
+            || Cellular_CreateSocket(CellularHandle, CellularSocketPdnContextId,
+                                     CELLULAR_SOCKET_DOMAIN_AF_INET,
+                                     CELLULAR_SOCKET_TYPE_STREAM,
+                                     CELLULAR_SOCKET_PROTOCOL_TCP,
+                                     &sock->tls_handle)
+                           != CELLULAR_SUCCESS) {
+        sock->tls_handle = NULL;
+        return avs_errno(AVS_ENOMEM);
+    }
+
+    uint8_t connect_id = (uint8_t) sock->tls_handle->socketId;
+    sock->data_ready_bit = 1UL << connect_id;
+    xEventGroupClearBits(data_ready_event_group, sock->data_ready_bit);
+    xEventGroupClearBits(sock->event_group, SOCKET_TLS_DATA_READY_BIT);
+    tls_sockets[connect_id] = sock;
+    tls_offload_set_data_ready_callback(tls_data_ready_callback, NULL);
+
+    // The modem resolves the hostname itself, so that it can also be used
+    // for SNI
+    if (tls_offload_open(connect_id, host, port, timeout_ms)) {
+        sock->data_ready_bit = 0;
+        release_tls_handle(sock);
+        return avs_errno(AVS_ECONNREFUSED);
+    }
+    sock->remote_port = port;
+    sock->tls_maybe_buffered = false;
+    return AVS_OK;
+}
+
 static avs_error_t
 net_connect(avs_net_socket_t *sock_, const char *host, const char *port) {
     avs_log(net_impl_cellular, TRACE, "In net_connect");
@@ -132,14 +279,37 @@ net_connect(avs_net_socket_t *sock_, const char *host, const char *port) {
         timeout = UINT32_MAX;
     }
 
-    if (Cellular_GetHostByName(CellularHandle, CellularSocketPdnContextId, host,
-                               resolved_ip)) {
-        return avs_errno(AVS_EADDRNOTAVAIL);
+    power_saving_wake_modem();
+
+    if (sock->tls_offload) {
+        if (avs_simple_snprintf(sock->remote_hostname,
+                                sizeof(sock->remote_hostname), "%s", host)
+                < 0) {
+            return avs_errno(AVS_EIO);
+        }
+        avs_error_t err = tls_connect(sock, host, port_int, (uint32_t) timeout);
+        if (avs_is_err(err)) {
+            return err;
+        }
+        power_saving_note_activity();
+        sock->socket_state = AVS_NET_SOCKET_STATE_CONNECTED;
+        return AVS_OK;
+    }
+
+    bool cached = !dns_cache_lookup(host, resolved_ip, sizeof(resolved_ip));
+    if (!cached && resolve_host(host, resolved_ip)) {
+        if (dns_cache_lookup_fallback(host, resolved_ip,
+                                      sizeof(resolved_ip))) {
+            return avs_errno(AVS_EADDRNOTAVAIL);
+        }
+        avs_log(net_impl_cellular, WARNING,
+                "Could not resolve %s, using last known address %s", host,
+                resolved_ip);
     }
     avs_log(net_impl_cellular, TRACE,
-            "Connecting to host: %s with IP addr: %s on port %" PRIu16
+            "Connecting to host: %s with IP addr: %s%s on port %" PRIu16
             " with timeout of %" PRId64,
-            host, resolved_ip, port_int, timeout);
+            host, resolved_ip, cached ? " (cached)" : "", port_int, timeout);
 
     if (avs_simple_snprintf(sock->remote_hostname,
                             sizeof(sock->remote_hostname), "%s", host)
@@ -149,9 +319,29 @@ net_connect(avs_net_socket_t *sock_, const char *host, const char *port) {
 
     if (Sockets_Connect(&sock->cell_socket, resolved_ip, port_int, 30000,
                         (uint32_t) timeout, sock->socktype)) {
-        return avs_errno(AVS_ECONNREFUSED);
+        if (!cached) {
+            return avs_errno(AVS_ECONNREFUSED);
+        }
+        // The cached address may be stale, retry once with a fresh one
+        char previous_ip[sizeof(resolved_ip)];
+        strcpy(previous_ip, resolved_ip);
+        dns_cache_invalidate(host);
+        if (resolve_host(host, resolved_ip)) {
+            return avs_errno(AVS_EADDRNOTAVAIL);
+        }
+        if (!strcmp(previous_ip, resolved_ip)
+                || Sockets_Connect(&sock->cell_socket, resolved_ip, port_int,
+                                   30000, (uint32_t) timeout, sock->socktype)) {
+            return avs_errno(AVS_ECONNREFUSED);
+        }
     }
 
+    if (register_data_ready_callback(sock)) {
+        avs_log(net_impl_cellular, WARNING,
+                "Could not register data ready callback");
+    }
+
+    power_saving_note_activity();
     sock->socket_state = AVS_NET_SOCKET_STATE_CONNECTED;
     return AVS_OK;
 }
@@ -163,15 +353,61 @@ net_send(avs_net_socket_t *sock_, const void *buffer, size_t buffer_length) {
     net_socket_impl_t *sock = (net_socket_impl_t *) sock_;
     int32_t written = 0;
 
-    written = Sockets_Send(sock->cell_socket, buffer, buffer_length);
+    power_saving_wake_modem();
+    if (sock->tls_offload) {
+        written = tls_offload_send((uint8_t) sock->tls_handle->socketId, buffer,
+                                   buffer_length);
+    } else {
+        written = Sockets_Send(sock->cell_socket, buffer, buffer_length);
+    }
     if (written >= 0 && written == buffer_length) {
-        sock->bytes_sent += (size_t) written;
+        account_traffic(sock, (size_t) written, true);
+        power_saving_note_activity();
         return AVS_OK;
     }
 
     return avs_errno(AVS_EIO);
 }
 
+static avs_error_t tls_receive(net_socket_impl_t *sock,
+                               size_t *out_bytes_received,
+                               void *buffer,
+                               size_t buffer_length,
+                               uint32_t timeout_ms) {
+    uint8_t connect_id = (uint8_t) sock->tls_handle->socketId;
+    TickType_t deadline = xTaskGetTickCount() + pdMS_TO_TICKS(timeout_ms);
+
+    for (;;) {
+        // Cleared before reading, so that a URC arriving in between is not
+        // lost
+        xEventGroupClearBits(sock->event_group, SOCKET_TLS_DATA_READY_BIT);
+        int32_t bytes_received =
+                tls_offload_recv(connect_id, buffer, buffer_length);
+        if (bytes_received < 0) {
+            return avs_errno(AVS_EIO);
+        }
+        if (bytes_received > 0 || !buffer_length) {
+            *out_bytes_received = (size_t) bytes_received;
+            if (bytes_received) {
+                account_traffic(sock, (size_t) bytes_received, false);
+            }
+            sock->tls_maybe_buffered = (size_t) bytes_received == buffer_length;
+            power_saving_note_activity();
+            return AVS_OK;
+        }
+
+        TickType_t now = xTaskGetTickCount();
+        if ((int32_t) (deadline - now) <= 0
+                || !(xEventGroupWaitBits(sock->event_group,
+                                         SOCKET_TLS_DATA_READY_BIT, pdFALSE,
+                                         pdTRUE, deadline - now)
+                     & SOCKET_TLS_DATA_READY_BIT)) {
+            *out_bytes_received = 0;
+            return avs_errno(AVS_ETIMEDOUT);
+        }
+    }
+}
+
 static avs_error_t net_receive(avs_net_socket_t *sock_,
                                size_t *out_bytes_received,
                                void *buffer,
@@ -190,6 +426,11 @@ static avs_error_t net_receive(avs_net_socket_t *sock_,
         timeout = UINT32_MAX;
     }
 
+    if (sock->tls_offload) {
+        return tls_receive(sock, out_bytes_received, buffer, buffer_length,
+                           (uint32_t) timeout);
+    }
+
     if (Sockets_SetupSocketRecvTimeout(sock->cell_socket,
                                        pdMS_TO_TICKS(timeout))) {
         return avs_errno(AVS_EIO);
@@ -201,7 +442,12 @@ static avs_error_t net_receive(avs_net_socket_t *sock_,
         return avs_errno(AVS_EIO);
     }
     *out_bytes_received = (size_t) bytes_received;
-    sock->bytes_received += (size_t) bytes_received;
+    if (bytes_received == 0 && buffer_length > 0) {
+        // nothing buffered in the modem, e.g. after a spurious wakeup
+        return avs_errno(AVS_ETIMEDOUT);
+    }
+    account_traffic(sock, (size_t) bytes_received, false);
+    power_saving_note_activity();
     if (buffer_length > 0 && sock->socktype == SOCK_DGRAM
             && (size_t) bytes_received == buffer_length) {
         return avs_errno(AVS_EMSGSIZE);
@@ -214,7 +460,21 @@ static avs_error_t net_close(avs_net_socket_t *sock_) {
     avs_log(net_impl_cellular, TRACE, "In net_close");
 
     net_socket_impl_t *sock = (net_socket_impl_t *) sock_;
+    if (sock->socket_state == AVS_NET_SOCKET_STATE_CONNECTED) {
+        avs_log(net_impl_cellular, INFO,
+                "Socket to %s closed, sent %zu B, received %zu B",
+                sock->remote_hostname, sock->bytes_sent, sock->bytes_received);
+    }
     sock->socket_state = AVS_NET_SOCKET_STATE_CLOSED;
+    if (sock->data_ready_bit) {
+        xEventGroupClearBits(data_ready_event_group, sock->data_ready_bit);
+        sock->data_ready_bit = 0;
+    }
+    if (sock->tls_handle) {
+        tls_offload_close((uint8_t) sock->tls_handle->socketId);
+        release_tls_handle(sock);
+        return AVS_OK;
+    }
     Sockets_Disconnect(sock->cell_socket);
     sock->cell_socket = NULL;
     return AVS_OK;
@@ -256,8 +516,10 @@ static avs_error_t net_get_opt(avs_net_socket_t *sock_,
                 AVS_MIN(CELLULAR_MAX_SEND_DATA_LEN, CELLULAR_MAX_RECV_DATA_LEN);
         return AVS_OK;
     case AVS_NET_SOCKET_HAS_BUFFERED_DATA:
-        net_impl_check_modem_buffer(sock_, &out_option_value->flag,
-                                    SOCKET_HAS_BUFFERED_EVENT_TIMEOUT_MS);
+        // Nothing is buffered on the ESP side for plain sockets. Data left in
+        // the modem is found by net_impl_rearm_data_ready() once the socket
+        // has been served, which costs one AT+QIRD instead of one per message.
+        out_option_value->flag = sock->tls_offload && sock->tls_maybe_buffered;
         return AVS_OK;
     case AVS_NET_SOCKET_OPT_BYTES_SENT:
         out_option_value->bytes_sent = sock->bytes_sent;
@@ -293,6 +555,10 @@ static avs_error_t net_remote_host(avs_net_socket_t *sock_,
     avs_log(net_impl_cellular, TRACE, "In net_remote_host");
 
     net_socket_impl_t *sock = (net_socket_impl_t *) sock_;
+    if (sock->tls_offload) {
+        // The address is only known to the modem
+        return net_remote_hostname(sock_, out_buffer, out_buffer_size);
+    }
     if (avs_simple_snprintf(out_buffer, out_buffer_size, "%s",
                             sock->cell_socket->cellularSocketHandle
                                     ->remoteSocketAddress.ipAddress.ipAddress)
@@ -309,8 +575,10 @@ static avs_error_t net_remote_port(avs_net_socket_t *sock_,
 
     net_socket_impl_t *sock = (net_socket_impl_t *) sock_;
     if (avs_simple_snprintf(out_buffer, out_buffer_size, "%" PRIu16,
-                            sock->cell_socket->cellularSocketHandle
-                                    ->remoteSocketAddress.port)
+                            sock->tls_offload
+                                    ? sock->remote_port
+                                    : sock->cell_socket->cellularSocketHandle
+                                              ->remoteSocketAddress.port)
             < 0) {
         return avs_errno(AVS_EIO);
     }
@@ -461,3 +729,69 @@ avs_error_t net_impl_check_modem_buffer(avs_net_socket_t *sock_,
         }
     }
 }
+
+int net_impl_select(avs_net_socket_t *const *sockets,
+                    size_t sockets_count,
+                    bool *out_ready,
+                    uint32_t timeout_milliseconds) {
+    EventGroupHandle_t event_group = get_data_ready_event_group();
+    if (!event_group) {
+        return -1;
+    }
+
+    EventBits_t wait_mask = DATA_READY_WAKEUP_BIT;
+    for (size_t i = 0; i < sockets_count; i++) {
+        wait_mask |= ((net_socket_impl_t *) sockets[i])->data_ready_bit;
+    }
+
+    // Only bits of the polled sockets are consumed, so data reported for
+    // sockets the caller is not interested in right now is not lost
+    EventBits_t bits =
+            xEventGroupWaitBits(event_group, wait_mask, pdTRUE, pdFALSE,
+                                pdMS_TO_TICKS(timeout_milliseconds));
+
+    int ready_count = 0;
+    for (size_t i = 0; i < sockets_count; i++) {
+        EventBits_t bit = ((net_socket_impl_t *) sockets[i])->data_ready_bit;
+        out_ready[i] = bit && (bits & bit);
+        if (out_ready[i]) {
+            ready_count++;
+        }
+    }
+    return ready_count;
+}
+
+void net_impl_rearm_data_ready(avs_net_socket_t *sock_) {
+    net_socket_impl_t *sock = (net_socket_impl_t *) sock_;
+    bool buffer_status = false;
+
+    if (sock->tls_offload) {
+        if (sock->data_ready_bit && sock->tls_maybe_buffered) {
+            xEventGroupSetBits(data_ready_event_group, sock->data_ready_bit);
+        }
+        return;
+    }
+    // The modem does not repeat the URC until its buffer has been drained,
+    // so leftover data has to be checked for explicitly
+    if (sock->data_ready_bit
+            && avs_is_ok(net_impl_check_modem_buffer(
+                       sock_, &buffer_status,
+                       SOCKET_HAS_BUFFERED_EVENT_TIMEOUT_MS))
+            && buffer_status) {
+        xEventGroupSetBits(data_ready_event_group, sock->data_ready_bit);
+    }
+}
+
+const net_impl_traffic_stats_t *net_impl_get_traffic_stats(void) {
+    return &traffic_stats;
+}
+
+void net_impl_reset_traffic_stats(void) {
+    memset(&traffic_stats, 0, sizeof(traffic_stats));
+}
+
+void net_impl_wakeup(void) {
+    if (data_ready_event_group) {
+        xEventGroupSetBits(data_ready_event_group, DATA_READY_WAKEUP_BIT);
+    }
+}
@@ -17,6 +17,7 @@
 #define NET_IMPL_H
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 #include <avsystem/commons/avs_errno.h>
@@ -42,4 +43,51 @@ avs_error_t net_impl_check_modem_buffer(avs_net_socket_t *sock_,
                                         bool *buffer_status,
                                         uint32_t timeout_milliseconds);
 
+/**
+ * Waits until any of the given sockets has data reported by the modem
+ * (+QIURC: "recv"), in the spirit of select().
+ *
+ * All sockets are waited on at once, so the latency of each socket does not
+ * depend on how many sockets are polled.
+ *
+ * @param sockets              System sockets of this implementation.
+ * @param sockets_count        Number of elements in @p sockets.
+ * @param out_ready            Array of @p sockets_count elements, set to true
+ *                             for every socket that has data to read.
+ * @param timeout_milliseconds Maximum time to wait.
+ *
+ * @returns Number of ready sockets, 0 on timeout or after
+ * @ref net_impl_wakeup, -1 on error.
+ */
+int net_impl_select(avs_net_socket_t *const *sockets,
+                    size_t sockets_count,
+                    bool *out_ready,
+                    uint32_t timeout_milliseconds);
+
+/**
+ * Marks @p sock_ as ready again if the modem still holds unread data for it.
+ * Should be called after the socket has been served.
+ */
+void net_impl_rearm_data_ready(avs_net_socket_t *sock_);
+
+/**
+ * Makes a pending @ref net_impl_select call return immediately.
+ */
+void net_impl_wakeup(void);
+
+typedef struct {
+    uint64_t bytes_sent;
+    uint64_t bytes_received;
+    uint32_t messages_sent;
+    uint32_t messages_received;
+    size_t max_message_size;
+} net_impl_traffic_stats_t;
+
+/**
+ * Traffic summed over all sockets, including already closed ones, since boot
+ * or the last @ref net_impl_reset_traffic_stats call.
+ */
+const net_impl_traffic_stats_t *net_impl_get_traffic_stats(void);
+void net_impl_reset_traffic_stats(void);
+
 #endif // NET_IMPL_H
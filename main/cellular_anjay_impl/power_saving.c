@@ -0,0 +1,532 @@
+/*
+ * Copyright 2021-2025 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <driver/gpio.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <avsystem/commons/avs_defs.h>
+#include <avsystem/commons/avs_log.h>
+#include <avsystem/commons/avs_time.h>
+
+#include <cellular_api.h>
+#include <cellular_at_core.h>
+#include <cellular_common.h>
+#include <cellular_types.h>
+
+#include "net_impl.h"
+#include "power_saving.h"
+#include "sdkconfig.h"
+
+#if defined(CONFIG_ANJAY_CLIENT_BG96_PSM_EINT_GPIO) \
+        && CONFIG_ANJAY_CLIENT_BG96_PSM_EINT_GPIO >= 0
+#    define PSM_EINT_GPIO CONFIG_ANJAY_CLIENT_BG96_PSM_EINT_GPIO
+#endif // defined(CONFIG_ANJAY_CLIENT_BG96_PSM_EINT_GPIO) &&
+       // CONFIG_ANJAY_CLIENT_BG96_PSM_EINT_GPIO >= 0
+
+#define PSM_EINT_PULSE_MS 100
+#define PSM_WAKEUP_TIME_MS 500
+
+static power_saving_status_t status;
+static avs_time_monotonic_t last_activity;
+
+#ifdef CONFIG_ANJAY_CLIENT_CELLULAR_POWER_SAVING
+// Anjay keeps the connection open for MAX_TRANSMIT_WAIT after the last
+// exchange in queue mode, which is 93 s with default CoAP transmission params
+#    define QUEUE_MODE_TIMEOUT_S 93
+
+// 3GPP TS 24.008, 10.5.7.4a (GPRS Timer 3) and 10.5.7.3 (GPRS Timer 2)
+#    define GPRS_TIMER_VALUE_MASK 0x1F
+#    define GPRS_TIMER_UNIT_SHIFT 5
+#    define GPRS_TIMER_DEACTIVATED 0xE0
+
+// AcT-type values of AT+CEDRXS
+#    define EDRX_RAT_WB_S1 4
+#    define EDRX_RAT_NB_S1 5
+// NB-S1 mode does not support cycles shorter than 20.48 s
+#    define EDRX_NB_S1_MIN_VALUE 2
+#    define EDRX_PTW_SHIFT 4
+
+// The cellular library sets up +CEREG URCs with <n> = 2, which does not
+// include the PSM timers, so <n> = 4 is only set for the duration of the query
+#    define CEREG_QUERY "AT+CEREG=4;+CEREG?;+CEREG=2"
+
+// Field positions in +CEREG: <n>,<stat>,[<tac>],[<ci>],[<AcT>],[<cause_type>],
+// [<reject_cause>],[<Active-Time>],[<Periodic-TAU>]
+#    define CEREG_FIELD_STAT 1
+#    define CEREG_FIELD_ACTIVE_TIME 7
+#    define CEREG_FIELD_PERIODIC_TAU 8
+#    define CEREG_FIELD_COUNT 9
+#    define CEREG_STAT_REGISTERED_HOME 1
+#    define CEREG_STAT_REGISTERED_ROAMING 5
+
+// Field positions in +CEDRXRDP: <AcT>,[<Requested_eDRX>],[<NW_eDRX>],[<PTW>]
+#    define CEDRXRDP_FIELD_RAT 0
+#    define CEDRXRDP_FIELD_NW_VALUE 2
+#    define CEDRXRDP_FIELD_PTW 3
+#    define CEDRXRDP_FIELD_COUNT 4
+
+typedef struct {
+    uint8_t unit_bits;
+    int64_t unit_s;
+} gprs_timer_unit_t;
+
+static const gprs_timer_unit_t T3412_UNITS[] = {
+    { 3, 2 },     { 4, 30 },     { 5, 60 },     { 0, 600 },
+    { 1, 3600 },  { 2, 36000 },  { 6, 1152000 }
+};
+
+static const gprs_timer_unit_t T3324_UNITS[] = {
+    { 0, 2 }, { 1, 60 }, { 2, 360 }
+};
+
+// 3GPP TS 24.008, 10.5.5.32, S1 mode
+static const int64_t EDRX_CYCLES_MS[] = {
+    5120,   10240,  20480,   40960,   61440,   81920,   102400,  122880,
+    143360, 163840, 327680, 655360, 1310720, 2621440, 5242880, 10485760
+};
+
+// Settings stored in the modem (AT+CPSMS?, AT+CEDRXS?), which may differ from
+// the ones granted by the network, kept in status
+static power_saving_status_t requested;
+static avs_time_monotonic_t last_refresh;
+
+// Shortest encodable timer not shorter than seconds
+static uint8_t encode_gprs_timer(const gprs_timer_unit_t *units,
+                                 size_t units_count,
+                                 int64_t seconds) {
+    for (size_t i = 0; i < units_count; i++) {
+        int64_t value = (seconds + units[i].unit_s - 1) / units[i].unit_s;
+        if (value <= GPRS_TIMER_VALUE_MASK) {
+            return (uint8_t) ((units[i].unit_bits << GPRS_TIMER_UNIT_SHIFT)
+                              | value);
+        }
+    }
+    const gprs_timer_unit_t *largest = &units[units_count - 1];
+    return (uint8_t) ((largest->unit_bits << GPRS_TIMER_UNIT_SHIFT)
+                      | GPRS_TIMER_VALUE_MASK);
+}
+
+// Longest encodable timer not longer than seconds, but at least one unit
+static uint8_t encode_gprs_timer_at_most(const gprs_timer_unit_t *units,
+                                         size_t units_count,
+                                         int64_t seconds) {
+    uint8_t best =
+            (uint8_t) ((units[0].unit_bits << GPRS_TIMER_UNIT_SHIFT) | 1);
+    int64_t best_s = units[0].unit_s;
+    for (size_t i = 0; i < units_count; i++) {
+        int64_t value = AVS_MIN(seconds / units[i].unit_s,
+                                (int64_t) GPRS_TIMER_VALUE_MASK);
+        if (value > 0 && value * units[i].unit_s > best_s) {
+            best = (uint8_t) ((units[i].unit_bits << GPRS_TIMER_UNIT_SHIFT)
+                              | value);
+            best_s = value * units[i].unit_s;
+        }
+    }
+    return best;
+}
+
+static int64_t decode_gprs_timer(const gprs_timer_unit_t *units,
+                                 size_t units_count,
+                                 uint32_t encoded) {
+    uint8_t unit_bits = (uint8_t) ((encoded >> GPRS_TIMER_UNIT_SHIFT) & 0x07);
+    for (size_t i = 0; i < units_count; i++) {
+        if (units[i].unit_bits == unit_bits) {
+            return units[i].unit_s * (encoded & GPRS_TIMER_VALUE_MASK);
+        }
+    }
+    return -1;
+}
+
+static uint8_t select_edrx_value(int64_t max_cycle_ms) {
+    uint8_t value = 0;
+    for (uint8_t i = 0; i < AVS_ARRAY_SIZE(EDRX_CYCLES_MS); i++) {
+        if (EDRX_CYCLES_MS[i] <= max_cycle_ms) {
+            value = i;
+        }
+    }
+    return value;
+}
+
+#    ifdef CONFIG_ANJAY_CLIENT_QUEUE_MODE
+/*
+ * The modem has to be awake before the Update is due, which Anjay sends half
+ * of the lifetime, but no more than MAX_TRANSMIT_WAIT, before the lifetime
+ * expires. Without PSM_EINT, the periodic TAU is the only occasion to send it.
+ */
+static uint8_t periodic_tau_for_lifetime(int64_t lifetime_s) {
+    int64_t margin_s = AVS_MIN(lifetime_s / 2, QUEUE_MODE_TIMEOUT_S);
+    return encode_gprs_timer_at_most(T3412_UNITS, AVS_ARRAY_SIZE(T3412_UNITS),
+                                     lifetime_s - margin_s);
+}
+
+// Covers the queue mode timeout, unless that would not be shorter than the
+// periodic TAU, in which case the modem would never enter PSM
+static uint8_t active_time_for_lifetime(int64_t lifetime_s) {
+    int64_t tau_s =
+            decode_gprs_timer(T3412_UNITS, AVS_ARRAY_SIZE(T3412_UNITS),
+                              periodic_tau_for_lifetime(lifetime_s));
+    uint8_t value = encode_gprs_timer(T3324_UNITS, AVS_ARRAY_SIZE(T3324_UNITS),
+                                      QUEUE_MODE_TIMEOUT_S);
+    if (decode_gprs_timer(T3324_UNITS, AVS_ARRAY_SIZE(T3324_UNITS), value)
+            >= tau_s) {
+        value = encode_gprs_timer_at_most(
+                T3324_UNITS, AVS_ARRAY_SIZE(T3324_UNITS), tau_s / 2);
+    }
+    return value;
+}
+#    endif // CONFIG_ANJAY_CLIENT_QUEUE_MODE
+
+static int apply_psm(int64_t lifetime_s) {
+    CellularPsmSettings_t settings = { 0 };
+#    ifdef CONFIG_ANJAY_CLIENT_QUEUE_MODE
+    settings.mode = 1;
+    settings.periodicTauValue = periodic_tau_for_lifetime(lifetime_s);
+    settings.activeTimeValue = active_time_for_lifetime(lifetime_s);
+#    else  // CONFIG_ANJAY_CLIENT_QUEUE_MODE
+    (void) lifetime_s;
+    settings.periodicTauValue = GPRS_TIMER_DEACTIVATED;
+    settings.activeTimeValue = GPRS_TIMER_DEACTIVATED;
+#    endif // CONFIG_ANJAY_CLIENT_QUEUE_MODE
+    settings.periodicRauValue = GPRS_TIMER_DEACTIVATED;
+    settings.gprsReadyTimer = GPRS_TIMER_DEACTIVATED;
+
+    if (Cellular_SetPsmSettings(CellularHandle, &settings)
+            != CELLULAR_SUCCESS) {
+        avs_log(power_saving, ERROR, "Could not set PSM settings");
+        return -1;
+    }
+    return 0;
+}
+
+static uint8_t edrx_value_for_lifetime(int64_t lifetime_s) {
+    int64_t max_cycle_ms = CONFIG_ANJAY_CLIENT_EDRX_MAX_CYCLE_MS;
+#    ifdef CONFIG_ANJAY_CLIENT_QUEUE_MODE
+    // Leave the server at least two paging occasions within the active time
+    int64_t active_time_s =
+            decode_gprs_timer(T3324_UNITS, AVS_ARRAY_SIZE(T3324_UNITS),
+                              active_time_for_lifetime(lifetime_s));
+    max_cycle_ms = AVS_MIN(max_cycle_ms, active_time_s * 1000 / 2);
+#    endif // CONFIG_ANJAY_CLIENT_QUEUE_MODE
+    max_cycle_ms = AVS_MIN(max_cycle_ms, lifetime_s * 1000 / 2);
+    return select_edrx_value(max_cycle_ms);
+}
+
+// PSM and eDRX settings are kept by the modem across power cycles, so after
+// a reboot they usually do not have to be set again
+static bool psm_applied(int64_t lifetime_s) {
+#    ifdef CONFIG_ANJAY_CLIENT_QUEUE_MODE
+    return requested.psm_enabled
+           && requested.periodic_tau_s
+                      == decode_gprs_timer(T3412_UNITS,
+                                           AVS_ARRAY_SIZE(T3412_UNITS),
+                                           periodic_tau_for_lifetime(
+                                                   lifetime_s))
+           && requested.active_time_s
+                      == decode_gprs_timer(
+                                 T3324_UNITS, AVS_ARRAY_SIZE(T3324_UNITS),
+                                 active_time_for_lifetime(lifetime_s));
+#    else  // CONFIG_ANJAY_CLIENT_QUEUE_MODE
+    (void) lifetime_s;
+    return !requested.psm_enabled;
+#    endif // CONFIG_ANJAY_CLIENT_QUEUE_MODE
+}
+
+static bool edrx_applied(int64_t lifetime_s) {
+    return requested.edrx_enabled
+           && (requested.edrx_wb_s1 & 0x0F)
+                      == edrx_value_for_lifetime(lifetime_s);
+}
+
+static int apply_edrx(int64_t lifetime_s) {
+    uint8_t value = edrx_value_for_lifetime(lifetime_s);
+
+    CellularEidrxSettings_t settings = {
+        .mode = 1,
+        .rat = EDRX_RAT_WB_S1,
+        .requestedEdrxVaue = value
+    };
+    if (Cellular_SetEidrxSettings(CellularHandle, &settings)
+            != CELLULAR_SUCCESS) {
+        avs_log(power_saving, ERROR, "Could not set eDRX settings");
+        return -1;
+    }
+    settings.rat = EDRX_RAT_NB_S1;
+    settings.requestedEdrxVaue = AVS_MAX(value, EDRX_NB_S1_MIN_VALUE);
+    if (Cellular_SetEidrxSettings(CellularHandle, &settings)
+            != CELLULAR_SUCCESS) {
+        // Modules without NB-IoT support reject this AcT-type
+        avs_log(power_saving, DEBUG, "NB-S1 eDRX settings not applied");
+    }
+    return 0;
+}
+
+static void read_requested(void) {
+    CellularPsmSettings_t psm = { 0 };
+    if (Cellular_GetPsmSettings(CellularHandle, &psm) == CELLULAR_SUCCESS) {
+        requested.psm_enabled = psm.mode == 1;
+        requested.periodic_tau_s =
+                decode_gprs_timer(T3412_UNITS, AVS_ARRAY_SIZE(T3412_UNITS),
+                                  psm.periodicTauValue);
+        requested.active_time_s =
+                decode_gprs_timer(T3324_UNITS, AVS_ARRAY_SIZE(T3324_UNITS),
+                                  psm.activeTimeValue);
+    }
+
+    CellularEidrxSettingsList_t edrx_list = { 0 };
+    if (Cellular_GetEidrxSettings(CellularHandle, &edrx_list)
+            == CELLULAR_SUCCESS) {
+        requested.edrx_enabled = false;
+        for (uint8_t i = 0; i < edrx_list.count; i++) {
+            const CellularEidrxSettings_t *edrx = &edrx_list.eidrxList[i];
+            uint8_t octet = (uint8_t) ((edrx->pagingTimeWindow
+                                        << EDRX_PTW_SHIFT)
+                                       | (edrx->requestedEdrxVaue & 0x0F));
+            if (edrx->rat == EDRX_RAT_WB_S1) {
+                requested.edrx_wb_s1 = octet;
+            } else if (edrx->rat == EDRX_RAT_NB_S1) {
+                requested.edrx_nb_s1 = octet;
+            }
+            requested.edrx_enabled = requested.edrx_enabled || edrx->mode;
+        }
+    }
+}
+
+// Splits the response after its prefix on commas, keeping empty fields
+static size_t split_response(const CellularATCommandResponse_t *at_resp,
+                             char **fields,
+                             size_t max_fields) {
+    char *line;
+    size_t count = 0;
+
+    if (!at_resp || !at_resp->status || !at_resp->pItm
+            || !(line = at_resp->pItm->pLine)
+            || Cellular_ATRemovePrefix(&line) != CELLULAR_AT_SUCCESS
+            || Cellular_ATRemoveAllWhiteSpaces(line) != CELLULAR_AT_SUCCESS
+            || Cellular_ATRemoveAllDoubleQuote(line) != CELLULAR_AT_SUCCESS) {
+        return 0;
+    }
+    while (count < max_fields) {
+        fields[count++] = line;
+        if (!(line = strchr(line, ','))) {
+            break;
+        }
+        *line++ = '\0';
+    }
+    return count;
+}
+
+static CellularPktStatus_t
+cereg_callback(CellularHandle_t cellular_handle,
+               const CellularATCommandResponse_t *at_resp,
+               void *data,
+               uint16_t data_len) {
+    (void) cellular_handle;
+    (void) data_len;
+    power_saving_status_t *out = (power_saving_status_t *) data;
+    char *fields[CEREG_FIELD_COUNT] = { NULL };
+    size_t count = split_response(at_resp, fields, CEREG_FIELD_COUNT);
+
+    if (count <= CEREG_FIELD_STAT) {
+        return CELLULAR_PKT_STATUS_BAD_RESPONSE;
+    }
+    long stat = strtol(fields[CEREG_FIELD_STAT], NULL, 10);
+    if (stat != CEREG_STAT_REGISTERED_HOME
+            && stat != CEREG_STAT_REGISTERED_ROAMING) {
+        // Nothing is granted until the next registration
+        return CELLULAR_PKT_STATUS_BAD_RESPONSE;
+    }
+    out->active_time_s = -1;
+    out->periodic_tau_s = -1;
+    // Both timers are omitted if the network did not grant PSM
+    if (count == CEREG_FIELD_COUNT && *fields[CEREG_FIELD_ACTIVE_TIME]
+            && *fields[CEREG_FIELD_PERIODIC_TAU]) {
+        out->active_time_s = decode_gprs_timer(
+                T3324_UNITS, AVS_ARRAY_SIZE(T3324_UNITS),
+                (uint32_t) strtoul(fields[CEREG_FIELD_ACTIVE_TIME], NULL, 2));
+        out->periodic_tau_s = decode_gprs_timer(
+                T3412_UNITS, AVS_ARRAY_SIZE(T3412_UNITS),
+                (uint32_t) strtoul(fields[CEREG_FIELD_PERIODIC_TAU], NULL,
+                                   2));
+    }
+    out->psm_enabled = out->active_time_s >= 0 && out->periodic_tau_s > 0;
+    return CELLULAR_PKT_STATUS_OK;
+}
+
+static CellularPktStatus_t
+cedrxrdp_callback(CellularHandle_t cellular_handle,
+                  const CellularATCommandResponse_t *at_resp,
+                  void *data,
+                  uint16_t data_len) {
+    (void) cellular_handle;
+    (void) data_len;
+    power_saving_status_t *out = (power_saving_status_t *) data;
+    char *fields[CEDRXRDP_FIELD_COUNT] = { NULL };
+    size_t count = split_response(at_resp, fields, CEDRXRDP_FIELD_COUNT);
+
+    if (!count) {
+        return CELLULAR_PKT_STATUS_BAD_RESPONSE;
+    }
+    out->edrx_enabled = false;
+    out->edrx_wb_s1 = 0;
+    out->edrx_nb_s1 = 0;
+    // Only the AcT-type is reported if eDRX is not used in the current cell
+    if (count < CEDRXRDP_FIELD_COUNT || !*fields[CEDRXRDP_FIELD_NW_VALUE]) {
+        return CELLULAR_PKT_STATUS_OK;
+    }
+    uint8_t octet = (uint8_t) (((strtoul(fields[CEDRXRDP_FIELD_PTW], NULL, 2)
+                                 & 0x0F)
+                                << EDRX_PTW_SHIFT)
+                               | (strtoul(fields[CEDRXRDP_FIELD_NW_VALUE],
+                                          NULL, 2)
+                                  & 0x0F));
+    long rat = strtol(fields[CEDRXRDP_FIELD_RAT], NULL, 10);
+    if (rat == EDRX_RAT_WB_S1) {
+        out->edrx_wb_s1 = octet;
+        out->edrx_enabled = true;
+    } else if (rat == EDRX_RAT_NB_S1) {
+        out->edrx_nb_s1 = octet;
+        out->edrx_enabled = true;
+    }
+    return CELLULAR_PKT_STATUS_OK;
+}
+
+// Values which could not be read, e.g. while not registered, are left as they
+// were
+static void read_granted(void) {
+    power_saving_status_t updated = status;
+
+    last_refresh = avs_time_monotonic_now();
+    if (Cellular_ATCommandRaw(CellularHandle, "+CEREG", CEREG_QUERY,
+                              CELLULAR_AT_WITH_PREFIX, cereg_callback,
+                              &updated, sizeof(updated))
+            != CELLULAR_SUCCESS) {
+        avs_log(power_saving, DEBUG, "Could not read granted PSM timers");
+        updated.psm_enabled = status.psm_enabled;
+        updated.periodic_tau_s = status.periodic_tau_s;
+        updated.active_time_s = status.active_time_s;
+    }
+    if (Cellular_ATCommandRaw(CellularHandle, "+CEDRXRDP", "AT+CEDRXRDP",
+                              CELLULAR_AT_WITH_PREFIX, cedrxrdp_callback,
+                              &updated, sizeof(updated))
+            != CELLULAR_SUCCESS) {
+        avs_log(power_saving, DEBUG, "Could not read granted eDRX settings");
+        updated.edrx_enabled = status.edrx_enabled;
+        updated.edrx_wb_s1 = status.edrx_wb_s1;
+        updated.edrx_nb_s1 = status.edrx_nb_s1;
+    }
+    status = updated;
+}
+
+int power_saving_apply(int64_t lifetime_s) {
+    if (lifetime_s <= 0) {
+        return -1;
+    }
+    power_saving_wake_modem();
+    read_requested();
+    int result = ((!psm_applied(lifetime_s) && apply_psm(lifetime_s))
+                  || (!edrx_applied(lifetime_s) && apply_edrx(lifetime_s)))
+                         ? -1
+                         : 0;
+    // Values set just now are only negotiated at the next TAU, and picked up
+    // by power_saving_refresh() afterwards
+    read_granted();
+    power_saving_note_activity();
+
+    avs_log(power_saving, INFO,
+            "lifetime %" PRId64 "s: granted PSM %s, TAU %" PRId64
+            "s, active time %" PRId64 "s, eDRX WB-S1 0x%02x NB-S1 0x%02x",
+            lifetime_s, status.psm_enabled ? "on" : "off",
+            status.periodic_tau_s, status.active_time_s, status.edrx_wb_s1,
+            status.edrx_nb_s1);
+    return result;
+}
+
+void power_saving_refresh(void) {
+    avs_time_monotonic_t next_refresh = avs_time_monotonic_add(
+            last_refresh,
+            avs_time_duration_from_scalar(
+                    CONFIG_ANJAY_CLIENT_MODEM_STATUS_INTERVAL, AVS_TIME_S));
+    if (!power_saving_modem_may_sleep()
+            && !avs_time_monotonic_before(avs_time_monotonic_now(),
+                                          next_refresh)) {
+        read_granted();
+    }
+}
+#endif // CONFIG_ANJAY_CLIENT_CELLULAR_POWER_SAVING
+
+const power_saving_status_t *power_saving_get_status(void) {
+    return &status;
+}
+
+void power_saving_note_activity(void) {
+    last_activity = avs_time_monotonic_now();
+}
+
+bool power_saving_modem_may_sleep(void) {
+    if (!status.psm_enabled || status.active_time_s < 0) {
+        return false;
+    }
+    return avs_time_monotonic_before(
+            avs_time_monotonic_add(
+                    last_activity,
+                    avs_time_duration_from_scalar(status.active_time_s,
+                                                  AVS_TIME_S)),
+            avs_time_monotonic_now());
+}
+
+avs_time_monotonic_t power_saving_next_wakeup(void) {
+#ifdef PSM_EINT_GPIO
+    return AVS_TIME_MONOTONIC_INVALID;
+#else  // PSM_EINT_GPIO
+    if (!status.psm_enabled || status.periodic_tau_s <= 0) {
+        return AVS_TIME_MONOTONIC_INVALID;
+    }
+    // T3412 is restarted whenever the modem leaves connected mode
+    return avs_time_monotonic_add(
+            last_activity, avs_time_duration_from_scalar(status.periodic_tau_s,
+                                                         AVS_TIME_S));
+#endif // PSM_EINT_GPIO
+}
+
+void power_saving_wake_modem(void) {
+#ifdef PSM_EINT_GPIO
+    static bool gpio_configured;
+    if (!gpio_configured) {
+        gpio_reset_pin(PSM_EINT_GPIO);
+        gpio_set_direction(PSM_EINT_GPIO, GPIO_MODE_OUTPUT);
+        gpio_set_level(PSM_EINT_GPIO, 1);
+        gpio_configured = true;
+    }
+    if (!power_saving_modem_may_sleep()) {
+        return;
+    }
+    // Falling edge on PSM_EINT brings the BG96 out of PSM
+    gpio_set_level(PSM_EINT_GPIO, 0);
+    vTaskDelay(pdMS_TO_TICKS(PSM_EINT_PULSE_MS));
+    gpio_set_level(PSM_EINT_GPIO, 1);
+    vTaskDelay(pdMS_TO_TICKS(PSM_WAKEUP_TIME_MS));
+    power_saving_note_activity();
+#endif // PSM_EINT_GPIO
+}
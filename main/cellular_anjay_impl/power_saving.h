@@ -0,0 +1,93 @@
+/*
+ * Copyright 2021-2025 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef POWER_SAVING_H
+#define POWER_SAVING_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <avsystem/commons/avs_time.h>
+
+typedef struct {
+    bool psm_enabled;
+    // Periodic TAU (T3412) and Active Time (T3324) granted by the network,
+    // -1 if PSM was not granted
+    int64_t periodic_tau_s;
+    int64_t active_time_s;
+    bool edrx_enabled;
+    // Extended DRX parameters octet: PTW in bits 8-5, cycle in bits 4-1
+    uint8_t edrx_wb_s1;
+    uint8_t edrx_nb_s1;
+} power_saving_status_t;
+
+/**
+ * Configures PSM and eDRX in the modem for the given registration lifetime.
+ *
+ * PSM is only requested in queue mode (CONFIG_ANJAY_CLIENT_QUEUE_MODE), as
+ * otherwise the server expects the client to be reachable at all times. The
+ * periodic TAU is then set to the longest timer that still expires before the
+ * Update is due, and the active time to cover the queue mode timeout, but
+ * shorter than the periodic TAU. The eDRX cycle is bounded by
+ * CONFIG_ANJAY_CLIENT_EDRX_MAX_CYCLE_MS and, in queue mode, by half of the
+ * active time.
+ *
+ * @returns 0 on success, -1 if the modem rejected the settings.
+ */
+int power_saving_apply(int64_t lifetime_s);
+
+/**
+ * Re-reads the values granted by the network (AT+CEREG with <n> = 4 and
+ * AT+CEDRXRDP), at most every CONFIG_ANJAY_CLIENT_MODEM_STATUS_INTERVAL
+ * seconds and not while the modem may be in PSM. The network may grant other
+ * timers than requested, and settings applied by @ref power_saving_apply only
+ * take effect at the next TAU.
+ */
+void power_saving_refresh(void);
+
+/**
+ * Returns the values granted by the network as of the last
+ * @ref power_saving_apply or @ref power_saving_refresh call.
+ */
+const power_saving_status_t *power_saving_get_status(void);
+
+/**
+ * Records radio traffic; the modem is assumed to stay awake for the active
+ * time afterwards.
+ */
+void power_saving_note_activity(void);
+
+/**
+ * Returns true if the modem may have entered PSM, i.e. PSM is granted and the
+ * active time has elapsed since the last traffic. AT commands are not
+ * answered in this state, so periodic queries should be skipped.
+ */
+bool power_saving_modem_may_sleep(void);
+
+/**
+ * Expected time of the next periodic TAU, at which the modem leaves PSM on its
+ * own, or AVS_TIME_MONOTONIC_INVALID if it does not apply, i.e. PSM is off or
+ * the modem can be woken through CONFIG_ANJAY_CLIENT_BG96_PSM_EINT_GPIO.
+ */
+avs_time_monotonic_t power_saving_next_wakeup(void);
+
+/**
+ * Wakes the modem from PSM through PSM_EINT if it may be asleep. A no-op if
+ * CONFIG_ANJAY_CLIENT_BG96_PSM_EINT_GPIO is not set.
+ */
+void power_saving_wake_modem(void);
+
+#endif // POWER_SAVING_H
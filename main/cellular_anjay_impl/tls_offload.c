@@ -0,0 +1,539 @@
+/*
+ * Copyright 2021-2025 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <esp_random.h>
+#include <esp_rom_crc.h>
+#include <nvs.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/event_groups.h>
+
+#include <mbedtls/pem.h>
+#include <mbedtls/pk.h>
+
+#include <avsystem/commons/avs_defs.h>
+#include <avsystem/commons/avs_log.h>
+#include <avsystem/commons/avs_memory.h>
+#include <avsystem/commons/avs_time.h>
+
+#include <cellular_api.h>
+#include <cellular_common.h>
+#include <cellular_config_defaults.h>
+
+#include "../storage.h"
+#include "at_batch.h"
+#include "net_impl.h"
+#include "sdkconfig.h"
+#include "tls_offload.h"
+
+#define TLS_OFFLOAD_SSL_CONTEXT_ID 1
+#define TLS_OFFLOAD_AT_TIMEOUT_MS 5000U
+#define TLS_OFFLOAD_DATA_TIMEOUT_MS 10000U
+#define TLS_OFFLOAD_PEM_MAX_SIZE 4096
+#define TLS_OFFLOAD_CMD_MAX_SIZE 160
+
+#ifdef CONFIG_ANJAY_CLIENT_BG96_TLS_IGNORE_LOCAL_TIME
+#    define TLS_OFFLOAD_IGNORE_LOCAL_TIME 1
+#else  // CONFIG_ANJAY_CLIENT_BG96_TLS_IGNORE_LOCAL_TIME
+#    define TLS_OFFLOAD_IGNORE_LOCAL_TIME 0
+#endif // CONFIG_ANJAY_CLIENT_BG96_TLS_IGNORE_LOCAL_TIME
+
+#define TLS_OFFLOAD_CA_FILE "UFS:anjay_ca.pem"
+#define TLS_OFFLOAD_CERT_FILE "UFS:anjay_cert.pem"
+#define TLS_OFFLOAD_KEY_FILE "UFS:anjay_key.pem"
+#define TLS_OFFLOAD_FILE_COUNT 3
+
+#define TLS_OFFLOAD_NVS_NAMESPACE "tls_offload"
+#define TLS_OFFLOAD_NVS_CRC_KEY "crc"
+#define TLS_OFFLOAD_CRC_STR_SIZE 9
+
+#define QSSLOPEN_URC "+QSSLOPEN: "
+#define QSSLURC_RECV_URC "+QSSLURC: \"recv\","
+#define QSSLURC_CLOSED_URC "+QSSLURC: \"closed\","
+#define QSSLRECV_PREFIX "+QSSLRECV: "
+
+AVS_STATIC_ASSERT(CELLULAR_NUM_SOCKET_MAX <= 24, open_bits_fit_event_group);
+
+typedef struct {
+    uint8_t *buffer;
+    size_t buffer_size;
+    int32_t received;
+} recv_context_t;
+
+static bool provisioned;
+static EventGroupHandle_t open_event_group;
+static int open_results[CELLULAR_NUM_SOCKET_MAX];
+static bool closed_by_peer[CELLULAR_NUM_SOCKET_MAX];
+static tls_offload_data_ready_cb_t *data_ready_callback;
+static void *data_ready_callback_context;
+
+static int random_callback(void *context, unsigned char *output, size_t size) {
+    (void) context;
+    esp_fill_random(output, size);
+    return 0;
+}
+
+static int cert_to_pem(const uint8_t *der,
+                       size_t der_size,
+                       unsigned char *pem,
+                       size_t *inout_pem_size) {
+    size_t written = 0;
+    if (mbedtls_pem_write_buffer("-----BEGIN CERTIFICATE-----\n",
+                                 "-----END CERTIFICATE-----\n", der, der_size,
+                                 pem, *inout_pem_size, &written)) {
+        return -1;
+    }
+    // written includes the terminating NUL
+    *inout_pem_size = written - 1;
+    return 0;
+}
+
+static int key_to_pem(const uint8_t *der,
+                      size_t der_size,
+                      unsigned char *pem,
+                      size_t *inout_pem_size) {
+    mbedtls_pk_context pk;
+    mbedtls_pk_init(&pk);
+    int result = -1;
+    if (!mbedtls_pk_parse_key(&pk, der, der_size, NULL, 0, random_callback,
+                              NULL)
+            && !mbedtls_pk_write_key_pem(&pk, pem, *inout_pem_size)) {
+        *inout_pem_size = strlen((const char *) pem);
+        result = 0;
+    }
+    mbedtls_pk_free(&pk);
+    return result;
+}
+
+static bool send_command(const char *command) {
+    return Cellular_ATCommandRaw(CellularHandle, NULL, command,
+                                 CELLULAR_AT_NO_RESULT, NULL, NULL, 0)
+           == CELLULAR_SUCCESS;
+}
+
+static int upload_file(const char *name, const unsigned char *data,
+                       size_t size) {
+    char command[TLS_OFFLOAD_CMD_MAX_SIZE];
+    uint32_t sent = 0;
+
+    snprintf(command, sizeof(command), "AT+QFDEL=\"%s\"", name);
+    // Fails if the file does not exist yet
+    send_command(command);
+
+    snprintf(command, sizeof(command), "AT+QFUPL=\"%s\",%u", name,
+             (unsigned) size);
+    CellularAtReq_t at_req = {
+        .pAtCmd = command,
+        .atCmdType = CELLULAR_AT_NO_RESULT
+    };
+    CellularAtDataReq_t data_req = {
+        .pData = data,
+        .dataLen = (uint32_t) size,
+        .pSentDataLength = &sent
+    };
+    // The modem answers CONNECT, which is a success token, before the data
+    if (_Cellular_AtcmdDataSend(CellularHandle, at_req, data_req, NULL, NULL,
+                                TLS_OFFLOAD_AT_TIMEOUT_MS,
+                                TLS_OFFLOAD_DATA_TIMEOUT_MS, 0)
+                    != CELLULAR_PKT_STATUS_OK
+            || sent != size) {
+        avs_log(tls_offload, ERROR, "Could not upload %s", name);
+        return -1;
+    }
+    return 0;
+}
+
+static int upload_credentials(const tls_offload_credentials_t *credentials) {
+    unsigned char *pem = (unsigned char *) avs_malloc(TLS_OFFLOAD_PEM_MAX_SIZE);
+    if (!pem) {
+        return -1;
+    }
+
+    size_t pem_size = TLS_OFFLOAD_PEM_MAX_SIZE;
+    int result = (cert_to_pem(credentials->server_cert,
+                              credentials->server_cert_size, pem, &pem_size)
+                  || upload_file(TLS_OFFLOAD_CA_FILE, pem, pem_size))
+                         ? -1
+                         : 0;
+    pem_size = TLS_OFFLOAD_PEM_MAX_SIZE;
+    if (!result
+            && (cert_to_pem(credentials->client_cert,
+                            credentials->client_cert_size, pem, &pem_size)
+                || upload_file(TLS_OFFLOAD_CERT_FILE, pem, pem_size))) {
+        result = -1;
+    }
+    pem_size = TLS_OFFLOAD_PEM_MAX_SIZE;
+    if (!result
+            && (key_to_pem(credentials->client_key,
+                           credentials->client_key_size, pem, &pem_size)
+                || upload_file(TLS_OFFLOAD_KEY_FILE, pem, pem_size))) {
+        result = -1;
+    }
+
+    // The buffer held the private key
+    memset(pem, 0, TLS_OFFLOAD_PEM_MAX_SIZE);
+    avs_free(pem);
+    return result;
+}
+
+static int configure_ssl_context(void) {
+    at_batch_t batch;
+    at_batch_init(&batch);
+    // TLS 1.2, any cipher suite, verify server and client certificates
+    at_batch_add(&batch, "+QSSLCFG=\"sslversion\",%d,3",
+                 TLS_OFFLOAD_SSL_CONTEXT_ID);
+    at_batch_add(&batch, "+QSSLCFG=\"ciphersuite\",%d,0xFFFF",
+                 TLS_OFFLOAD_SSL_CONTEXT_ID);
+    at_batch_add(&batch, "+QSSLCFG=\"seclevel\",%d,2",
+                 TLS_OFFLOAD_SSL_CONTEXT_ID);
+    at_batch_add(&batch, "+QSSLCFG=\"cacert\",%d,\"%s\"",
+                 TLS_OFFLOAD_SSL_CONTEXT_ID, TLS_OFFLOAD_CA_FILE);
+    at_batch_add(&batch, "+QSSLCFG=\"clientcert\",%d,\"%s\"",
+                 TLS_OFFLOAD_SSL_CONTEXT_ID, TLS_OFFLOAD_CERT_FILE);
+    at_batch_add(&batch, "+QSSLCFG=\"clientkey\",%d,\"%s\"",
+                 TLS_OFFLOAD_SSL_CONTEXT_ID, TLS_OFFLOAD_KEY_FILE);
+    // Set either way, so that a value left by earlier firmware does not stick
+    at_batch_add(&batch, "+QSSLCFG=\"ignorelocaltime\",%d,%d",
+                 TLS_OFFLOAD_SSL_CONTEXT_ID, TLS_OFFLOAD_IGNORE_LOCAL_TIME);
+    return at_batch_flush(&batch);
+}
+
+static uint32_t credentials_crc(const tls_offload_credentials_t *credentials) {
+    uint32_t crc = esp_rom_crc32_le(0, credentials->server_cert,
+                                    credentials->server_cert_size);
+    crc = esp_rom_crc32_le(crc, credentials->client_cert,
+                           credentials->client_cert_size);
+    return esp_rom_crc32_le(crc, credentials->client_key,
+                            credentials->client_key_size);
+}
+
+static CellularPktStatus_t
+file_list_callback(CellularHandle_t cellular_handle,
+                   const CellularATCommandResponse_t *at_resp,
+                   void *data,
+                   uint16_t data_len) {
+    (void) cellular_handle;
+    (void) data_len;
+    size_t *out_count = (size_t *) data;
+
+    *out_count = 0;
+    if (at_resp && at_resp->status) {
+        for (const CellularATCommandLine_t *item = at_resp->pItm; item;
+             item = item->pNext) {
+            ++*out_count;
+        }
+    }
+    return CELLULAR_PKT_STATUS_OK;
+}
+
+// The modem keeps the files across reboots; they only have to be uploaded
+// again if the credentials have changed since the last upload
+static bool credentials_uploaded(uint32_t crc) {
+    char stored_crc[TLS_OFFLOAD_CRC_STR_SIZE] = "";
+    char expected_crc[TLS_OFFLOAD_CRC_STR_SIZE];
+    nvs_handle_t nvs_h;
+    size_t files = 0;
+
+    if (nvs_open(TLS_OFFLOAD_NVS_NAMESPACE, NVS_READONLY, &nvs_h)) {
+        return false;
+    }
+    esp_err_t err = nvs_get_str(nvs_h, TLS_OFFLOAD_NVS_CRC_KEY, stored_crc,
+                                &(size_t) { sizeof(stored_crc) });
+    nvs_close(nvs_h);
+
+    snprintf(expected_crc, sizeof(expected_crc), "%08" PRIx32, crc);
+    return err == ESP_OK && !strcmp(stored_crc, expected_crc)
+           && Cellular_ATCommandRaw(CellularHandle, "+QFLST",
+                                    "AT+QFLST=\"UFS:anjay_*\"",
+                                    CELLULAR_AT_MULTI_WITH_PREFIX,
+                                    file_list_callback, &files,
+                                    sizeof(files))
+                      == CELLULAR_SUCCESS
+           && files == TLS_OFFLOAD_FILE_COUNT;
+}
+
+static void store_credentials_crc(uint32_t crc) {
+    char crc_str[TLS_OFFLOAD_CRC_STR_SIZE];
+    snprintf(crc_str, sizeof(crc_str), "%08" PRIx32, crc);
+    storage_write_str(TLS_OFFLOAD_NVS_NAMESPACE, TLS_OFFLOAD_NVS_CRC_KEY,
+                      crc_str);
+}
+
+static bool parse_connect_id(const char *str, uint8_t *out_id) {
+    char *endptr;
+    unsigned long id = strtoul(str, &endptr, 10);
+    if (endptr == str || id >= CELLULAR_NUM_SOCKET_MAX) {
+        return false;
+    }
+    *out_id = (uint8_t) id;
+    return true;
+}
+
+// Called from the cellular library context for URCs it does not handle
+static void undefined_response_callback(void *context, const char *raw_data) {
+    (void) context;
+    uint8_t id;
+
+    if (!strncmp(raw_data, QSSLOPEN_URC, strlen(QSSLOPEN_URC))) {
+        const char *args = raw_data + strlen(QSSLOPEN_URC);
+        const char *comma = strchr(args, ',');
+        if (comma && parse_connect_id(args, &id)) {
+            open_results[id] = atoi(comma + 1);
+            xEventGroupSetBits(open_event_group, 1UL << id);
+        }
+    } else if (!strncmp(raw_data, QSSLURC_RECV_URC,
+                        strlen(QSSLURC_RECV_URC))) {
+        if (parse_connect_id(raw_data + strlen(QSSLURC_RECV_URC), &id)
+                && data_ready_callback) {
+            data_ready_callback(id, data_ready_callback_context);
+        }
+    } else if (!strncmp(raw_data, QSSLURC_CLOSED_URC,
+                        strlen(QSSLURC_CLOSED_URC))) {
+        if (parse_connect_id(raw_data + strlen(QSSLURC_CLOSED_URC), &id)) {
+            closed_by_peer[id] = true;
+            // Wake the reader so that it notices the closure
+            if (data_ready_callback) {
+                data_ready_callback(id, data_ready_callback_context);
+            }
+        }
+    }
+}
+
+int tls_offload_provision(const tls_offload_credentials_t *credentials) {
+    if (!open_event_group && !(open_event_group = xEventGroupCreate())) {
+        return -1;
+    }
+    uint32_t crc = credentials_crc(credentials);
+    if (credentials_uploaded(crc)) {
+        avs_log(tls_offload, INFO, "Credentials already in the modem");
+    } else if (upload_credentials(credentials)) {
+        avs_log(tls_offload, ERROR, "Could not upload credentials");
+        return -1;
+    } else {
+        store_credentials_crc(crc);
+    }
+    if (configure_ssl_context()
+            || Cellular_RegisterUndefinedRespCallback(
+                       CellularHandle, undefined_response_callback, NULL)
+                           != CELLULAR_SUCCESS) {
+        avs_log(tls_offload, ERROR, "Could not provision modem TLS");
+        return -1;
+    }
+    provisioned = true;
+    avs_log(tls_offload, INFO, "TLS offloaded to the modem");
+    return 0;
+}
+
+bool tls_offload_enabled(void) {
+    return provisioned;
+}
+
+void tls_offload_set_data_ready_callback(tls_offload_data_ready_cb_t *callback,
+                                         void *context) {
+    data_ready_callback = callback;
+    data_ready_callback_context = context;
+}
+
+int tls_offload_open(uint8_t connect_id,
+                     const char *host,
+                     uint16_t port,
+                     uint32_t timeout_ms) {
+    char command[TLS_OFFLOAD_CMD_MAX_SIZE];
+    EventBits_t bit = 1UL << connect_id;
+    avs_time_monotonic_t start = avs_time_monotonic_now();
+
+    xEventGroupClearBits(open_event_group, bit);
+    closed_by_peer[connect_id] = false;
+    // Buffer access mode, data is read with AT+QSSLRECV after a URC
+    if (snprintf(command, sizeof(command),
+                 "AT+QSSLOPEN=%u,%d,%u,\"%s\",%" PRIu16 ",0",
+                 (unsigned) CellularSocketPdnContextId,
+                 TLS_OFFLOAD_SSL_CONTEXT_ID, (unsigned) connect_id, host,
+                 port)
+                    >= (int) sizeof(command)
+            || !send_command(command)) {
+        return -1;
+    }
+    if (!(xEventGroupWaitBits(open_event_group, bit, pdTRUE, pdTRUE,
+                              pdMS_TO_TICKS(timeout_ms))
+          & bit)) {
+        avs_log(tls_offload, ERROR, "Timeout waiting for +QSSLOPEN");
+        tls_offload_close(connect_id);
+        return -1;
+    }
+    if (open_results[connect_id]) {
+        avs_log(tls_offload, ERROR, "AT+QSSLOPEN failed, error %d",
+                open_results[connect_id]);
+        tls_offload_close(connect_id);
+        return -1;
+    }
+
+    int64_t handshake_ms = 0;
+    avs_time_duration_to_scalar(
+            &handshake_ms, AVS_TIME_MS,
+            avs_time_monotonic_diff(avs_time_monotonic_now(), start));
+    avs_log(tls_offload, INFO,
+            "Modem TLS handshake with %s took %" PRId64 " ms", host,
+            handshake_ms);
+    return 0;
+}
+
+static CellularPktStatus_t send_data_prefix(void *context,
+                                            char *line,
+                                            uint32_t *bytes_read) {
+    (void) context;
+    // The "> " prompt is not terminated by a newline; turn it into an empty
+    // line so that the packet handler can proceed with the data
+    if (line && bytes_read && *bytes_read == 2U && !strncmp(line, "> ", 2)) {
+        line[0] = '\n';
+        line[1] = '\n';
+    }
+    return CELLULAR_PKT_STATUS_OK;
+}
+
+int32_t
+tls_offload_send(uint8_t connect_id, const void *buffer, size_t length) {
+    char command[TLS_OFFLOAD_CMD_MAX_SIZE];
+    uint32_t sent = 0;
+
+    if (closed_by_peer[connect_id]) {
+        return -1;
+    }
+    snprintf(command, sizeof(command), "AT+QSSLSEND=%u,%u",
+             (unsigned) connect_id, (unsigned) length);
+    CellularAtReq_t at_req = {
+        .pAtCmd = command,
+        .atCmdType = CELLULAR_AT_NO_RESULT
+    };
+    CellularAtDataReq_t data_req = {
+        .pData = (const uint8_t *) buffer,
+        .dataLen = (uint32_t) length,
+        .pSentDataLength = &sent
+    };
+    if (_Cellular_AtcmdDataSend(CellularHandle, at_req, data_req,
+                                send_data_prefix, NULL,
+                                TLS_OFFLOAD_AT_TIMEOUT_MS,
+                                TLS_OFFLOAD_DATA_TIMEOUT_MS, 0)
+            != CELLULAR_PKT_STATUS_OK) {
+        return -1;
+    }
+    return (int32_t) sent;
+}
+
+static CellularPktStatus_t recv_data_prefix(void *context,
+                                            char *line,
+                                            uint32_t line_length,
+                                            char **out_data_start,
+                                            uint32_t *out_data_length) {
+    (void) context;
+    size_t prefix_length = strlen(QSSLRECV_PREFIX);
+
+    *out_data_start = NULL;
+    *out_data_length = 0;
+    if (line_length < prefix_length
+            || strncmp(line, QSSLRECV_PREFIX, prefix_length)) {
+        return CELLULAR_PKT_STATUS_OK;
+    }
+
+    uint32_t i = (uint32_t) prefix_length;
+    while (i < line_length && line[i] != '\r' && line[i] != '\n') {
+        i++;
+    }
+    if (i + 1 >= line_length) {
+        // Length line not complete yet
+        return CELLULAR_PKT_STATUS_SIZE_MISMATCH;
+    }
+    line[i] = '\0';
+    long data_length = strtol(&line[prefix_length], NULL, 10);
+    if (data_length < 0 || data_length > CELLULAR_MAX_RECV_DATA_LEN) {
+        return CELLULAR_PKT_STATUS_BAD_RESPONSE;
+    }
+    if (data_length > 0) {
+        *out_data_start = &line[i + 2];
+        *out_data_length = (uint32_t) data_length;
+    }
+    return CELLULAR_PKT_STATUS_OK;
+}
+
+static CellularPktStatus_t
+recv_response_callback(CellularContext_t *cellular_context,
+                       const CellularATCommandResponse_t *response,
+                       void *data,
+                       uint16_t data_length) {
+    (void) cellular_context;
+    (void) data_length;
+    recv_context_t *ctx = (recv_context_t *) data;
+
+    if (!response || !response->pItm || !response->pItm->pLine) {
+        return CELLULAR_PKT_STATUS_BAD_RESPONSE;
+    }
+    const char *length_str = response->pItm->pLine + strlen(QSSLRECV_PREFIX);
+    long received = strtol(length_str, NULL, 10);
+    if (received <= 0) {
+        ctx->received = 0;
+        return CELLULAR_PKT_STATUS_OK;
+    }
+    if (!response->pItm->pNext || (size_t) received > ctx->buffer_size) {
+        return CELLULAR_PKT_STATUS_BAD_RESPONSE;
+    }
+    memcpy(ctx->buffer, response->pItm->pNext->pLine, (size_t) received);
+    ctx->received = (int32_t) received;
+    return CELLULAR_PKT_STATUS_OK;
+}
+
+int32_t tls_offload_recv(uint8_t connect_id, void *buffer, size_t length) {
+    char command[TLS_OFFLOAD_CMD_MAX_SIZE];
+    recv_context_t ctx = {
+        .buffer = (uint8_t *) buffer,
+        .buffer_size = AVS_MIN(length, (size_t) CELLULAR_MAX_RECV_DATA_LEN)
+    };
+
+    snprintf(command, sizeof(command), "AT+QSSLRECV=%u,%u",
+             (unsigned) connect_id, (unsigned) ctx.buffer_size);
+    CellularAtReq_t at_req = {
+        .pAtCmd = command,
+        .atCmdType = CELLULAR_AT_MULTI_DATA_WO_PREFIX,
+        .pAtRspPrefix = "+QSSLRECV",
+        .respCallback = recv_response_callback,
+        .pData = &ctx,
+        .dataLen = sizeof(ctx)
+    };
+    if (_Cellular_TimeoutAtcmdDataRecvRequestWithCallback(
+                CellularHandle, at_req, TLS_OFFLOAD_DATA_TIMEOUT_MS,
+                recv_data_prefix, NULL)
+            != CELLULAR_PKT_STATUS_OK) {
+        return -1;
+    }
+    if (!ctx.received && closed_by_peer[connect_id]) {
+        return -1;
+    }
+    return ctx.received;
+}
+
+void tls_offload_close(uint8_t connect_id) {
+    char command[TLS_OFFLOAD_CMD_MAX_SIZE];
+    snprintf(command, sizeof(command), "AT+QSSLCLOSE=%u",
+             (unsigned) connect_id);
+    send_command(command);
+}
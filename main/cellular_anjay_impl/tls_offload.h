@@ -0,0 +1,83 @@
+/*
+ * Copyright 2021-2025 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TLS_OFFLOAD_H
+#define TLS_OFFLOAD_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct {
+    // DER-encoded credentials, as stored in the Security object
+    const uint8_t *server_cert;
+    size_t server_cert_size;
+    const uint8_t *client_cert;
+    size_t client_cert_size;
+    const uint8_t *client_key;
+    size_t client_key_size;
+} tls_offload_credentials_t;
+
+typedef void tls_offload_data_ready_cb_t(uint8_t connect_id, void *context);
+
+/**
+ * Uploads the credentials to the modem file system and configures the BG96
+ * SSL context used by offloaded TLS connections. Once it succeeds, TCP sockets
+ * created by net_impl use the modem TLS stack instead of plain TCP.
+ *
+ * @returns 0 on success, -1 otherwise.
+ */
+int tls_offload_provision(const tls_offload_credentials_t *credentials);
+
+/**
+ * Returns true if @ref tls_offload_provision has succeeded.
+ */
+bool tls_offload_enabled(void);
+
+/**
+ * Sets the function called (from the cellular library context) when the
+ * modem reports incoming data on an offloaded connection.
+ */
+void tls_offload_set_data_ready_callback(tls_offload_data_ready_cb_t *callback,
+                                         void *context);
+
+/**
+ * Opens a TLS connection with AT+QSSLOPEN using @p connect_id, which must be
+ * reserved in the cellular library so that plain sockets do not reuse it.
+ *
+ * @returns 0 on success, -1 otherwise.
+ */
+int tls_offload_open(uint8_t connect_id,
+                     const char *host,
+                     uint16_t port,
+                     uint32_t timeout_ms);
+
+/**
+ * @returns Number of bytes sent or -1 on error.
+ */
+int32_t tls_offload_send(uint8_t connect_id, const void *buffer, size_t length);
+
+/**
+ * Reads data already buffered in the modem; does not block waiting for new
+ * data.
+ *
+ * @returns Number of bytes read (0 if none are buffered) or -1 on error.
+ */
+int32_t tls_offload_recv(uint8_t connect_id, void *buffer, size_t length);
+
+void tls_offload_close(uint8_t connect_id);
+
+#endif // TLS_OFFLOAD_H
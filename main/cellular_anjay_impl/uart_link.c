@@ -0,0 +1,211 @@
+/*
+ * Copyright 2021-2025 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include <driver/uart.h>
+#include <esp_system.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <avsystem/commons/avs_defs.h>
+#include <avsystem/commons/avs_log.h>
+
+#include <cellular_api.h>
+#include <cellular_common.h>
+#include <cellular_types.h>
+
+#include "net_impl.h"
+#include "sdkconfig.h"
+#include "uart_link.h"
+
+#define UART_LINK_DEFAULT_BAUD_RATE 115200
+#define UART_LINK_PROBE_COUNT 5
+// Time for the modem to switch its UART after acknowledging AT+IPR
+#define UART_LINK_SWITCH_DELAY_MS 100
+// RX FIFO level at which RTS is deasserted, out of 128 bytes
+#define UART_LINK_RTS_THRESHOLD 100
+
+static const uint32_t BAUD_RATES[] = { 921600, 460800, 230400, 115200 };
+
+// Restores the modem defaults; the reply, sent at the old rate, is not needed
+static const char RESTORE_DEFAULTS_COMMAND[] = "AT+IFC=0,0;+IPR=115200";
+
+static uart_port_t port = UART_NUM_MAX;
+// Whether the rate or flow control differ from the modem defaults
+static bool defaults_changed;
+
+/*
+ * The UART driver is installed by the cellular communication interface of the
+ * anjay-esp-idf component, so the port it was configured with is the one with
+ * a driver installed.
+ */
+static int find_port(void) {
+    uart_port_t found = UART_NUM_MAX;
+    for (uart_port_t i = 0; i < UART_NUM_MAX; i++) {
+#ifdef CONFIG_ESP_CONSOLE_UART_NUM
+        if (i == CONFIG_ESP_CONSOLE_UART_NUM) {
+            continue;
+        }
+#endif // CONFIG_ESP_CONSOLE_UART_NUM
+        if (uart_is_driver_installed(i)) {
+            if (found != UART_NUM_MAX) {
+                return -1;
+            }
+            found = i;
+        }
+    }
+    if (found == UART_NUM_MAX) {
+        return -1;
+    }
+    port = found;
+    return 0;
+}
+
+static bool send_command(const char *command) {
+    return Cellular_ATCommandRaw(CellularHandle, NULL, command,
+                                 CELLULAR_AT_NO_RESULT, NULL, NULL, 0)
+           == CELLULAR_SUCCESS;
+}
+
+static bool link_stable(void) {
+    for (int i = 0; i < UART_LINK_PROBE_COUNT; i++) {
+        if (!send_command("AT")) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool switch_baud_rate(uint32_t baud_rate) {
+    char command[24];
+    snprintf(command, sizeof(command), "AT+IPR=%" PRIu32, baud_rate);
+    // The OK is still sent at the previous rate; if it gets lost on an
+    // unstable link the modem may have switched anyway, so carry on
+    send_command(command);
+    vTaskDelay(pdMS_TO_TICKS(UART_LINK_SWITCH_DELAY_MS));
+    if (uart_set_baudrate(port, baud_rate) != ESP_OK) {
+        return false;
+    }
+    uart_flush_input(port);
+    return link_stable();
+}
+
+static void enable_flow_control(void) {
+#ifdef CONFIG_ANJAY_CLIENT_BG96_FLOW_CONTROL
+    if (!send_command("AT+IFC=2,2")) {
+        avs_log(uart_link, WARNING, "Modem rejected RTS/CTS flow control");
+        return;
+    }
+    if (uart_set_pin(port, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE,
+                     CONFIG_ANJAY_CLIENT_BG96_RTS_GPIO,
+                     CONFIG_ANJAY_CLIENT_BG96_CTS_GPIO)
+                    != ESP_OK
+            || uart_set_hw_flow_ctrl(port, UART_HW_FLOWCTRL_CTS_RTS,
+                                     UART_LINK_RTS_THRESHOLD)
+                           != ESP_OK) {
+        avs_log(uart_link, ERROR, "Could not enable UART flow control");
+        send_command("AT+IFC=0,0");
+        return;
+    }
+    defaults_changed = true;
+    avs_log(uart_link, INFO, "RTS/CTS flow control enabled");
+#endif // CONFIG_ANJAY_CLIENT_BG96_FLOW_CONTROL
+}
+
+// The modem keeps the rate over a restart of the ESP32, which comes back up
+// expecting the default
+static void restore_defaults_on_restart(void) {
+    if (!defaults_changed) {
+        return;
+    }
+    uart_write_bytes(port, RESTORE_DEFAULTS_COMMAND,
+                     sizeof(RESTORE_DEFAULTS_COMMAND) - 1);
+    uart_write_bytes(port, "\r", 1);
+    uart_wait_tx_done(port, pdMS_TO_TICKS(UART_LINK_SWITCH_DELAY_MS));
+}
+
+uint32_t uart_link_negotiate(void) {
+    uint32_t current = UART_LINK_DEFAULT_BAUD_RATE;
+    if (find_port()) {
+        avs_log(uart_link, WARNING,
+                "Could not find the BG96 UART port, keeping the default rate");
+        return current;
+    }
+    if (uart_get_baudrate(port, &current) != ESP_OK) {
+        return current;
+    }
+
+    enable_flow_control();
+
+    // The link at the starting rate has already been used for the modem
+    // setup, so it only needs probing after a failed switch
+    bool stable = true;
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(BAUD_RATES); i++) {
+        uint32_t baud_rate = BAUD_RATES[i];
+        if (baud_rate > CONFIG_ANJAY_CLIENT_BG96_BAUD_RATE) {
+            continue;
+        }
+        if (baud_rate == current) {
+            break;
+        }
+        if ((stable = switch_baud_rate(baud_rate))) {
+            current = baud_rate;
+            break;
+        }
+        avs_log(uart_link, WARNING,
+                "UART link unstable at %" PRIu32 " baud, falling back",
+                baud_rate);
+        current = baud_rate;
+    }
+
+    if (!stable && !link_stable()) {
+        // Last resort: the modem default, as after its power cycle
+        switch_baud_rate(UART_LINK_DEFAULT_BAUD_RATE);
+        current = UART_LINK_DEFAULT_BAUD_RATE;
+    }
+    avs_log(uart_link, INFO, "BG96 UART link running at %" PRIu32 " baud",
+            current);
+
+    static bool shutdown_handler_registered;
+    defaults_changed =
+            defaults_changed || current != UART_LINK_DEFAULT_BAUD_RATE;
+    if (defaults_changed && !shutdown_handler_registered) {
+        shutdown_handler_registered =
+                esp_register_shutdown_handler(restore_defaults_on_restart)
+                == ESP_OK;
+    }
+    return current;
+}
+
+void uart_link_restore_defaults(void) {
+    if (port == UART_NUM_MAX || !defaults_changed) {
+        return;
+    }
+    send_command(RESTORE_DEFAULTS_COMMAND);
+    vTaskDelay(pdMS_TO_TICKS(UART_LINK_SWITCH_DELAY_MS));
+    uart_set_hw_flow_ctrl(port, UART_HW_FLOWCTRL_DISABLE, 0);
+    uart_set_baudrate(port, UART_LINK_DEFAULT_BAUD_RATE);
+    uart_flush_input(port);
+    defaults_changed = false;
+    avs_log(uart_link, INFO, "BG96 UART link restored to %d baud",
+            UART_LINK_DEFAULT_BAUD_RATE);
+}
@@ -0,0 +1,44 @@
+/*
+ * Copyright 2021-2025 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef UART_LINK_H
+#define UART_LINK_H
+
+#include <stdint.h>
+
+/**
+ * Switches the ESP32 <-> BG96 UART link to CONFIG_ANJAY_CLIENT_BG96_BAUD_RATE
+ * and, if configured, enables RTS/CTS flow control. Must be called after the
+ * cellular library is initialized.
+ *
+ * Each rate is verified with a series of AT probes; if the link turns out to
+ * be unstable, lower rates are tried down to the modem default. The rate is
+ * not stored in the modem (no AT&W), so a modem reset restores the default.
+ * The UART port is the one the cellular communication interface installed
+ * its driver on. The modem defaults are restored on esp_restart().
+ *
+ * @returns Baud rate in use after negotiation.
+ */
+uint32_t uart_link_negotiate(void);
+
+/**
+ * Switches both sides of the link back to the modem defaults (115200 baud, no
+ * flow control). Must be called before the cellular library is cleaned up to
+ * reinitialize the modem, which expects the default rate.
+ */
+void uart_link_restore_defaults(void);
+
+#endif // UART_LINK_H
@@ -0,0 +1,290 @@
+/*
+ * Copyright 2021-2025 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <esp_rom_crc.h>
+#include <nvs.h>
+
+#include <avsystem/commons/avs_defs.h>
+#include <avsystem/commons/avs_log.h>
+#include <avsystem/commons/avs_memory.h>
+
+#include "config_store.h"
+#include "main.h"
+
+#define CONFIG_STORE_VERSION 1
+
+#define CLIENT_RECORD_KEY "client_cfg"
+#define WIFI_RECORD_KEY "wifi_cfg"
+
+typedef struct {
+    uint16_t version;
+    uint16_t payload_size;
+    uint32_t crc;
+} config_blob_header_t;
+
+typedef enum { FIELD_TYPE_STR, FIELD_TYPE_BOOL } field_type_t;
+
+typedef struct {
+    // Key of the field in the per-key layout, see nvs_config.csv
+    const char *legacy_key;
+    field_type_t type;
+    void *value;
+    size_t size;
+} field_t;
+
+// A string filling its whole buffer, like a 32-character SSID copied from
+// wifi_config_t, is truncated so that it is terminated once decoded
+static uint16_t str_length(const field_t *field) {
+    return (uint16_t) strnlen((const char *) field->value, field->size - 1);
+}
+
+static size_t encoded_size(const field_t *fields, size_t count) {
+    size_t size = sizeof(config_blob_header_t);
+    for (size_t i = 0; i < count; i++) {
+        if (fields[i].type == FIELD_TYPE_STR) {
+            size += sizeof(uint16_t) + str_length(&fields[i]);
+        } else {
+            size += 1;
+        }
+    }
+    return size;
+}
+
+static void encode(const field_t *fields,
+                   size_t count,
+                   uint8_t *blob,
+                   size_t blob_size) {
+    uint8_t *payload = blob + sizeof(config_blob_header_t);
+    uint8_t *ptr = payload;
+    for (size_t i = 0; i < count; i++) {
+        if (fields[i].type == FIELD_TYPE_STR) {
+            uint16_t length = str_length(&fields[i]);
+            memcpy(ptr, &length, sizeof(length));
+            ptr += sizeof(length);
+            memcpy(ptr, fields[i].value, length);
+            ptr += length;
+        } else {
+            *ptr++ = *(const bool *) fields[i].value;
+        }
+    }
+
+    const config_blob_header_t header = {
+        .version = CONFIG_STORE_VERSION,
+        .payload_size = (uint16_t) (ptr - payload),
+        .crc = esp_rom_crc32_le(0, payload, (uint32_t) (ptr - payload))
+    };
+    assert(ptr == blob + blob_size);
+    memcpy(blob, &header, sizeof(header));
+}
+
+static int decode(const field_t *fields,
+                  size_t count,
+                  const uint8_t *payload,
+                  size_t payload_size) {
+    const uint8_t *end = payload + payload_size;
+    for (size_t i = 0; i < count; i++) {
+        if (fields[i].type == FIELD_TYPE_STR) {
+            uint16_t length;
+            if ((size_t) (end - payload) < sizeof(length)) {
+                return -1;
+            }
+            memcpy(&length, payload, sizeof(length));
+            payload += sizeof(length);
+            if (length >= fields[i].size
+                    || (size_t) (end - payload) < length) {
+                return -1;
+            }
+            memcpy(fields[i].value, payload, length);
+            ((char *) fields[i].value)[length] = '\0';
+            payload += length;
+        } else {
+            if (payload == end) {
+                return -1;
+            }
+            *(bool *) fields[i].value = *payload++;
+        }
+    }
+    return payload == end ? 0 : -1;
+}
+
+static int read_blob(nvs_handle_t nvs_h,
+                     const char *namespace,
+                     const char *key,
+                     const field_t *fields,
+                     size_t count) {
+    size_t size = 0;
+    if (nvs_get_blob(nvs_h, key, NULL, &size) != ESP_OK) {
+        return -1;
+    }
+
+    int result = -1;
+    uint8_t *blob = (uint8_t *) avs_malloc(size);
+    if (blob && size >= sizeof(config_blob_header_t)
+            && nvs_get_blob(nvs_h, key, blob, &size) == ESP_OK) {
+        config_blob_header_t header;
+        memcpy(&header, blob, sizeof(header));
+        const uint8_t *payload = blob + sizeof(header);
+        if (header.version == CONFIG_STORE_VERSION
+                && header.payload_size == size - sizeof(header)
+                && header.crc
+                           == esp_rom_crc32_le(0, payload,
+                                               header.payload_size)) {
+            result = decode(fields, count, payload, header.payload_size);
+        }
+    }
+    avs_free(blob);
+
+    if (result) {
+        avs_log(config_store, WARNING, "Ignoring invalid %s record in %s", key,
+                namespace);
+    }
+    return result;
+}
+
+static int read_legacy(nvs_handle_t nvs_h,
+                       const field_t *fields,
+                       size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        esp_err_t err;
+        if (fields[i].type == FIELD_TYPE_STR) {
+            err = nvs_get_str(nvs_h, fields[i].legacy_key,
+                              (char *) fields[i].value,
+                              &(size_t) { fields[i].size });
+        } else {
+            uint8_t value;
+            err = nvs_get_u8(nvs_h, fields[i].legacy_key, &value);
+            if (err == ESP_OK) {
+                *(bool *) fields[i].value = value;
+            }
+        }
+        if (err != ESP_OK) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static int write_blob(const char *namespace,
+                      const char *key,
+                      const field_t *fields,
+                      size_t count) {
+    size_t size = encoded_size(fields, count);
+    uint8_t *blob = (uint8_t *) avs_malloc(size);
+    if (!blob) {
+        return -1;
+    }
+    encode(fields, count, blob, size);
+
+    nvs_handle_t nvs_h;
+    esp_err_t err = nvs_open(namespace, NVS_READWRITE, &nvs_h);
+    if (err == ESP_OK) {
+        err = nvs_set_blob(nvs_h, key, blob, size);
+        if (err == ESP_OK) {
+            err = nvs_commit(nvs_h);
+        }
+        nvs_close(nvs_h);
+    }
+    avs_free(blob);
+    return err == ESP_OK ? 0 : -1;
+}
+
+static int load_record(const char *namespace,
+                       const char *key,
+                       const field_t *fields,
+                       size_t count,
+                       void *out,
+                       size_t out_size) {
+    nvs_handle_t nvs_h;
+    if (nvs_open(namespace, NVS_READONLY, &nvs_h)) {
+        memset(out, 0, out_size);
+        return -1;
+    }
+
+    bool migrate = false;
+    int result = read_blob(nvs_h, namespace, key, fields, count);
+    if (result && !read_legacy(nvs_h, fields, count)) {
+        migrate = true;
+        result = 0;
+    }
+    nvs_close(nvs_h);
+
+    if (result) {
+        memset(out, 0, out_size);
+        return -1;
+    }
+    if (migrate) {
+        if (write_blob(namespace, key, fields, count)) {
+            avs_log(config_store, WARNING, "Could not migrate %s to %s", key,
+                    namespace);
+        } else {
+            avs_log(config_store, INFO, "Migrated %s to %s", key, namespace);
+        }
+    }
+    return 0;
+}
+
+int config_store_load_client(config_store_client_t *out) {
+    const field_t fields[] = {
+        { "uri", FIELD_TYPE_STR, out->server_uri, sizeof(out->server_uri) },
+        { "endpoint_name", FIELD_TYPE_STR, out->endpoint_name,
+          sizeof(out->endpoint_name) },
+#ifdef CONFIG_ANJAY_SECURITY_MODE_PSK
+        { "psk", FIELD_TYPE_STR, out->psk, sizeof(out->psk) },
+        { "identity", FIELD_TYPE_STR, out->identity, sizeof(out->identity) }
+#endif // CONFIG_ANJAY_SECURITY_MODE_PSK
+    };
+    return load_record(MAIN_NVS_CONFIG_NAMESPACE, CLIENT_RECORD_KEY, fields,
+                       AVS_ARRAY_SIZE(fields), out, sizeof(*out));
+}
+
+#define WIFI_FIELDS(Wifi)                                               \
+    {                                                                   \
+        { "wifi_ssid", FIELD_TYPE_STR, (Wifi)->ssid,                    \
+          sizeof((Wifi)->ssid) },                                       \
+        { "wifi_pswd", FIELD_TYPE_STR, (Wifi)->password,                \
+          sizeof((Wifi)->password) },                                   \
+        { "wifi_inter_en", FIELD_TYPE_BOOL, &(Wifi)->enable,            \
+          sizeof((Wifi)->enable) }                                      \
+    }
+
+int config_store_load_wifi(const char *namespace, config_store_wifi_t *out) {
+    const field_t fields[] = WIFI_FIELDS(out);
+    return load_record(namespace, WIFI_RECORD_KEY, fields,
+                       AVS_ARRAY_SIZE(fields), out, sizeof(*out));
+}
+
+int config_store_save_wifi(storage_txn_t *txn,
+                           const char *namespace,
+                           const config_store_wifi_t *wifi) {
+    // Encoding only reads the fields
+    config_store_wifi_t *record = (config_store_wifi_t *) wifi;
+    const field_t fields[] = WIFI_FIELDS(record);
+
+    size_t size = encoded_size(fields, AVS_ARRAY_SIZE(fields));
+    if (size > STORAGE_MAX_BLOB_SIZE) {
+        txn->failed = true;
+        return -1;
+    }
+    uint8_t blob[STORAGE_MAX_BLOB_SIZE];
+    encode(fields, AVS_ARRAY_SIZE(fields), blob, size);
+    return storage_txn_write_blob(txn, namespace, WIFI_RECORD_KEY, blob, size);
+}
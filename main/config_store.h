@@ -0,0 +1,77 @@
+/*
+ * Copyright 2021-2025 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CONFIG_STORE_H
+#define CONFIG_STORE_H
+
+#include <stdbool.h>
+
+#include <anjay/core.h>
+
+#include "sdkconfig.h"
+#include "storage.h"
+
+/**
+ * Every record is kept as a single NVS blob made of a header with a format
+ * version and a CRC32 of the payload, followed by length-prefixed fields. A
+ * record is either loaded as a whole or not at all.
+ *
+ * Records missing from NVS are migrated from the per-key layout used by
+ * nvs_config.csv on the first load. The old keys are left in place, but they
+ * are neither read nor updated once a valid blob exists, so firmware that
+ * predates the records sees the values from before the migration.
+ */
+
+typedef struct {
+    char server_uri[ANJAY_MAX_PK_OR_IDENTITY_SIZE];
+    char endpoint_name[ANJAY_MAX_PK_OR_IDENTITY_SIZE];
+#ifndef CONFIG_ANJAY_SECURITY_MODE_CERTIFICATES
+    char psk[ANJAY_MAX_SECRET_KEY_SIZE];
+    char identity[ANJAY_MAX_PK_OR_IDENTITY_SIZE];
+#endif // CONFIG_ANJAY_SECURITY_MODE_CERTIFICATES
+} config_store_client_t;
+
+typedef struct {
+    char ssid[32];
+    char password[64];
+    bool enable;
+} config_store_wifi_t;
+
+/**
+ * Loads LwM2M client settings from the main configuration namespace. Reads
+ * NVS synchronously.
+ *
+ * @returns 0 on success. On failure, -1 is returned and @p out is zeroed.
+ */
+int config_store_load_client(config_store_client_t *out);
+
+/**
+ * Loads settings of a single Wi-Fi network from @p namespace. Reads NVS
+ * synchronously.
+ *
+ * @returns 0 on success. On failure, -1 is returned and @p out is zeroed.
+ */
+int config_store_load_wifi(const char *namespace, config_store_wifi_t *out);
+
+/**
+ * Stages the whole @p wifi record in @p txn, replacing the one stored in
+ * @p namespace.
+ */
+int config_store_save_wifi(storage_txn_t *txn,
+                           const char *namespace,
+                           const config_store_wifi_t *wifi);
+
+#endif // CONFIG_STORE_H
@@ -23,31 +23,39 @@
    CONDITIONS OF ANY KIND, either express or implied.
  */
 
+#include <inttypes.h>
+#include <stdatomic.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include <stdio.h>
 #include <string.h>
 
 #include <freertos/FreeRTOS.h>
 #include <freertos/semphr.h>
 
+#include <esp_attr.h>
 #include <esp_err.h>
 #include <esp_event.h>
 #include <esp_log.h>
 #include <esp_netif.h>
 #include <esp_netif_ip_addr.h>
 #include <esp_netif_types.h>
+#include <esp_timer.h>
 #include <esp_wifi.h>
 #include <esp_wifi_default.h>
 #include <esp_wifi_types.h>
+#include <nvs.h>
 
+#include "backoff.h"
 #include "connect.h"
 #include "sdkconfig.h"
+#include "storage.h"
+#include "wifi_status.h"
 
 static wifi_config_t wifi_config;
 
 #ifdef CONFIG_ANJAY_WIFI_CONNECT_IPV6
 #    define MAX_IP6_ADDRS_PER_NETIF (5)
-#    define NO_OF_IP_ADDRESSES_TO_WAIT_FOR (2)
 
 #    if defined(CONFIG_ANJAY_WIFI_CONNECT_IPV6_PREF_LOCAL_LINK)
 #        define ANJAY_CONNECT_PREFERRED_IPV6_TYPE ESP_IP6_ADDR_IS_LINK_LOCAL
@@ -58,16 +66,106 @@ static wifi_config_t wifi_config;
 #    elif defined(CONFIG_ANJAY_WIFI_CONNECT_IPV6_PREF_UNIQUE_LOCAL)
 #        define ANJAY_CONNECT_PREFERRED_IPV6_TYPE ESP_IP6_ADDR_IS_UNIQUE_LOCAL
 #    endif // if-elif ANJAY_WIFI_CONNECT_IPV6_PREF_...
-
-#else
-#    define NO_OF_IP_ADDRESSES_TO_WAIT_FOR (1)
 #endif // CONFIG_ANJAY_WIFI_CONNECT_IPV6
 
 #define MAX_WAITING_TIME_FOR_IP 15000 // in ms
 
-static xSemaphoreHandle s_semph_get_ip_addrs;
+#if defined(CONFIG_ANJAY_WIFI_POWER_SAVE_MAX_MODEM)
+#    define POWER_SAVE_PROFILE WIFI_PS_MAX_MODEM
+#elif defined(CONFIG_ANJAY_WIFI_POWER_SAVE_MIN_MODEM)
+#    define POWER_SAVE_PROFILE WIFI_PS_MIN_MODEM
+#else
+#    define POWER_SAVE_PROFILE WIFI_PS_NONE
+#endif // CONFIG_ANJAY_WIFI_POWER_SAVE_MAX_MODEM
+
+#ifdef CONFIG_ANJAY_WIFI_FAST_RECONNECT
+#    define AP_CACHE_MAGIC 0x41504331 // "APC1"
+#    define AP_CACHE_NAMESPACE "wifi_ap_cache"
+#    define AP_CACHE_SSID_KEY "ssid"
+#    define AP_CACHE_AP_KEY "ap"
+
+/**
+ * Access point the station was last associated with. Kept in RTC memory, so
+ * that it survives deep sleep and software resets, and mirrored in NVS for
+ * cold boots.
+ */
+typedef struct {
+    uint32_t magic;
+    char ssid[sizeof(((wifi_sta_config_t *) NULL)->ssid) + 1];
+    uint8_t bssid[6];
+    uint8_t channel;
+} ap_cache_t;
+
+static RTC_DATA_ATTR ap_cache_t s_ap_cache;
+#endif // CONFIG_ANJAY_WIFI_FAST_RECONNECT
+
+/* signalled by the completion callback of the blocking wifi_connect() */
+static xSemaphoreHandle s_semph_connect_done;
 static esp_netif_t *s_anjay_esp_netif = NULL;
 
+ESP_EVENT_DEFINE_BASE(ANJAY_CONNECT_EVENT);
+
+enum {
+    ANJAY_CONNECT_EVENT_GENERATION,
+    ANJAY_CONNECT_EVENT_TIMEOUT,
+    ANJAY_CONNECT_EVENT_RECONNECT
+};
+
+/*
+ * Event handlers are registered once, in wifi_initialize(). Every
+ * wifi_connect_async() and wifi_disconnect() starts a new generation and
+ * posts an ANJAY_CONNECT_EVENT_GENERATION marker to the default event loop.
+ * Events are delivered in order, so anything the loop handles while its view
+ * of the generation lags behind s_generation was emitted by the previous,
+ * already torn down connection and is dropped. Timer events carry the
+ * generation they were armed in.
+ */
+typedef struct {
+    uint32_t generation;
+    bool active;
+} generation_marker_t;
+
+static atomic_uint_fast32_t s_generation;
+static uint32_t s_event_generation;
+static bool s_event_active;
+static uint32_t s_connect_timer_generation;
+static uint32_t s_reconnect_timer_generation;
+
+/*
+ * State of the connection attempt. Apart from the completion callback, which
+ * may be cancelled by wifi_disconnect() from another task, it is only accessed
+ * from the default event loop task.
+ */
+static bool s_started;
+static wifi_config_t s_requested_config;
+static bool s_fast;
+static bool s_got_ipv4;
+static esp_timer_handle_t s_connect_timer;
+static portMUX_TYPE s_connect_cb_lock = portMUX_INITIALIZER_UNLOCKED;
+static wifi_connect_cb_t *s_connect_cb;
+static void *s_connect_cb_arg;
+
+/*
+ * Reconnection after a lost association. Only the statistics are read from
+ * other tasks, the rest belongs to the default event loop task.
+ */
+static backoff_t s_reconnect_backoff;
+static esp_timer_handle_t s_reconnect_timer;
+static portMUX_TYPE s_reconnect_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+static wifi_reconnect_stats_t s_reconnect_stats;
+
+/*
+ * Power save residency, only accessed from the task that calls
+ * wifi_connect_async() and wifi_power_save_set_low_latency().
+ */
+static bool s_low_latency;
+static int64_t s_power_save_since_us;
+static wifi_power_save_stats_t s_power_save_stats;
+
+/* timestamps of the connection phases, in microseconds since boot */
+static int64_t s_connect_start_us;
+static int64_t s_associated_us;
+
 #ifdef CONFIG_ANJAY_WIFI_CONNECT_IPV6
 static esp_ip6_addr_t s_ipv6_addr;
 
@@ -84,6 +182,8 @@ static const char *TAG = "anjay_connect";
 
 static void disconnect(void);
 static void deinit(void);
+static void address_obtained(void);
+static void unregister_handlers(void);
 
 /**
  * @brief Checks the netif description if it contains specified prefix.
@@ -100,6 +200,48 @@ static void stop(void) {
     deinit();
 }
 
+static void advance_generation(bool active) {
+    const generation_marker_t marker = {
+        .generation = (uint32_t) atomic_fetch_add(&s_generation, 1) + 1,
+        .active = active
+    };
+    ESP_ERROR_CHECK(esp_event_post(ANJAY_CONNECT_EVENT,
+                                   ANJAY_CONNECT_EVENT_GENERATION, &marker,
+                                   sizeof(marker), portMAX_DELAY));
+}
+
+static void on_generation(void *arg,
+                          esp_event_base_t event_base,
+                          int32_t event_id,
+                          void *event_data) {
+    const generation_marker_t *marker =
+            (const generation_marker_t *) event_data;
+    s_event_generation = marker->generation;
+    s_event_active = marker->active;
+}
+
+static bool is_current_event(void) {
+    return s_event_active
+           && s_event_generation == (uint32_t) atomic_load(&s_generation);
+}
+
+static bool is_current_timer_event(const void *event_data) {
+    return is_current_event()
+           && *(const uint32_t *) event_data == s_event_generation;
+}
+
+static void post_timer_event(esp_timer_handle_t timer,
+                             int32_t event_id,
+                             const uint32_t *generation) {
+    // Runs in the esp_timer task; the Wi-Fi state is owned by the event loop
+    if (esp_event_post(ANJAY_CONNECT_EVENT, event_id, generation,
+                       sizeof(*generation), 0)
+            != ESP_OK) {
+        // event queue full, try again shortly
+        esp_timer_start_once(timer, 100 * 1000);
+    }
+}
+
 static esp_ip4_addr_t s_ip_addr;
 
 static void on_got_ip(void *arg,
@@ -107,6 +249,9 @@ static void on_got_ip(void *arg,
                       int32_t event_id,
                       void *event_data) {
     ip_event_got_ip_t *event = (ip_event_got_ip_t *) event_data;
+    if (!is_current_event()) {
+        return;
+    }
     if (!is_our_netif(TAG, event->esp_netif)) {
         ESP_LOGW(TAG, "Got IPv4 from another interface \"%s\": ignored",
                  esp_netif_get_desc(event->esp_netif));
@@ -115,7 +260,15 @@ static void on_got_ip(void *arg,
     ESP_LOGI(TAG, "Got IPv4 event: Interface \"%s\" address: " IPSTR,
              esp_netif_get_desc(event->esp_netif), IP2STR(&event->ip_info.ip));
     memcpy(&s_ip_addr, &event->ip_info.ip, sizeof(s_ip_addr));
-    xSemaphoreGive(s_semph_get_ip_addrs);
+    wifi_status_set_ipv4(&event->ip_info);
+    backoff_reset(&s_reconnect_backoff);
+    taskENTER_CRITICAL(&s_reconnect_stats_lock);
+    s_reconnect_stats.consecutive_failures = 0;
+    taskEXIT_CRITICAL(&s_reconnect_stats_lock);
+    if (!s_got_ipv4) {
+        s_got_ipv4 = true;
+        address_obtained();
+    }
 }
 
 #ifdef CONFIG_ANJAY_WIFI_CONNECT_IPV6
@@ -125,6 +278,9 @@ static void on_got_ipv6(void *arg,
                         int32_t event_id,
                         void *event_data) {
     ip_event_got_ip6_t *event = (ip_event_got_ip6_t *) event_data;
+    if (!is_current_event()) {
+        return;
+    }
     if (!is_our_netif(TAG, event->esp_netif)) {
         ESP_LOGW(TAG, "Got IPv6 from another netif: ignored");
         return;
@@ -137,68 +293,202 @@ static void on_got_ipv6(void *arg,
              s_ipv6_addr_types[ipv6_type]);
     if (ipv6_type == ANJAY_CONNECT_PREFERRED_IPV6_TYPE) {
         memcpy(&s_ipv6_addr, &event->ip6_info.ip, sizeof(s_ipv6_addr));
-        xSemaphoreGive(s_semph_get_ip_addrs);
+        wifi_status_set_ipv6(&event->ip6_info.ip);
+    }
+    // A link-local address alone cannot reach the server
+    if (ipv6_type == ESP_IP6_ADDR_IS_GLOBAL
+            || ipv6_type == ESP_IP6_ADDR_IS_UNIQUE_LOCAL) {
+        address_obtained();
     }
 }
 
 #endif // CONFIG_ANJAY_WIFI_CONNECT_IPV6
 
+static void reconnect(void) {
+    taskENTER_CRITICAL(&s_reconnect_stats_lock);
+    s_reconnect_stats.backing_off = false;
+    s_reconnect_stats.reconnect_attempts++;
+    taskEXIT_CRITICAL(&s_reconnect_stats_lock);
+
+    esp_err_t err = esp_wifi_connect();
+    // ESP_ERR_WIFI_CONN: a new attempt has already been started by
+    // start_attempt()
+    if (err == ESP_ERR_WIFI_NOT_STARTED || err == ESP_ERR_WIFI_CONN) {
+        return;
+    }
+    ESP_ERROR_CHECK(err);
+}
+
+static void on_reconnect_timer(void *arg) {
+    post_timer_event(s_reconnect_timer, ANJAY_CONNECT_EVENT_RECONNECT,
+                     &s_reconnect_timer_generation);
+}
+
+static void on_reconnect_due(void *arg,
+                             esp_event_base_t event_base,
+                             int32_t event_id,
+                             void *event_data) {
+    if (!is_current_timer_event(event_data)) {
+        return;
+    }
+    wifi_ap_record_t ap_info;
+    if (esp_wifi_sta_get_ap_info(&ap_info) == ESP_OK) {
+        // associated again in the meantime, e.g. by start_attempt()
+        return;
+    }
+    reconnect();
+}
+
 static void on_wifi_disconnect(void *arg,
                                esp_event_base_t event_base,
                                int32_t event_id,
                                void *event_data) {
-    ESP_LOGI(TAG, "Wi-Fi disconnected, trying to reconnect...");
-    esp_err_t err = esp_wifi_connect();
-    if (err == ESP_ERR_WIFI_NOT_STARTED) {
+    const wifi_event_sta_disconnected_t *event =
+            (const wifi_event_sta_disconnected_t *) event_data;
+    if (!is_current_event()) {
         return;
     }
-    ESP_ERROR_CHECK(err);
-}
+    wifi_status_set_disconnected();
+    uint32_t delay_ms = backoff_next_ms(&s_reconnect_backoff);
 
-#ifdef CONFIG_ANJAY_WIFI_CONNECT_IPV6
+    taskENTER_CRITICAL(&s_reconnect_stats_lock);
+    s_reconnect_stats.disconnects++;
+    s_reconnect_stats.consecutive_failures = s_reconnect_backoff.attempt;
+    s_reconnect_stats.current_delay_ms = delay_ms;
+    s_reconnect_stats.backing_off = delay_ms > 0;
+    taskEXIT_CRITICAL(&s_reconnect_stats_lock);
+
+    ESP_LOGI(TAG,
+             "Wi-Fi disconnected (reason %d), reconnecting in %" PRIu32 " ms",
+             (int) event->reason, delay_ms);
+    esp_timer_stop(s_reconnect_timer);
+    if (!delay_ms) {
+        reconnect();
+        return;
+    }
+    s_reconnect_timer_generation = s_event_generation;
+    ESP_ERROR_CHECK(esp_timer_start_once(s_reconnect_timer,
+                                         (uint64_t) delay_ms * 1000));
+}
 
 static void on_wifi_connect(void *esp_netif,
                             esp_event_base_t event_base,
                             int32_t event_id,
                             void *event_data) {
+    if (!is_current_event()) {
+        return;
+    }
+    s_associated_us = esp_timer_get_time();
+    esp_timer_stop(s_reconnect_timer);
+    wifi_status_set_associated((const wifi_event_sta_connected_t *) event_data);
+#ifdef CONFIG_ANJAY_WIFI_CONNECT_IPV6
     esp_netif_create_ip6_linklocal(esp_netif);
+#endif // CONFIG_ANJAY_WIFI_CONNECT_IPV6
 }
 
-#endif // CONFIG_ANJAY_WIFI_CONNECT_IPV6
+#ifdef CONFIG_ANJAY_WIFI_FAST_RECONNECT
+static bool ap_cache_load(void) {
+    if (s_ap_cache.magic == AP_CACHE_MAGIC) {
+        return true;
+    }
 
-static esp_err_t connect(wifi_config_t *conf) {
-    wifi_config = *conf;
+    nvs_handle_t nvs_h;
+    if (nvs_open(AP_CACHE_NAMESPACE, NVS_READONLY, &nvs_h) != ESP_OK) {
+        return false;
+    }
+    char ap[32];
+    unsigned int bssid[6];
+    unsigned int channel;
+    bool loaded =
+            nvs_get_str(nvs_h, AP_CACHE_SSID_KEY, s_ap_cache.ssid,
+                        &(size_t) { sizeof(s_ap_cache.ssid) })
+                    == ESP_OK
+            && s_ap_cache.ssid[0]
+            && nvs_get_str(nvs_h, AP_CACHE_AP_KEY, ap,
+                           &(size_t) { sizeof(ap) })
+                           == ESP_OK
+            && sscanf(ap, "%02x:%02x:%02x:%02x:%02x:%02x,%u", &bssid[0],
+                      &bssid[1], &bssid[2], &bssid[3], &bssid[4], &bssid[5],
+                      &channel)
+                           == 7;
+    nvs_close(nvs_h);
+    if (!loaded) {
+        return false;
+    }
 
-    ESP_ERROR_CHECK(esp_event_handler_register(WIFI_EVENT,
-                                               WIFI_EVENT_STA_DISCONNECTED,
-                                               &on_wifi_disconnect, NULL));
-    ESP_ERROR_CHECK(esp_event_handler_register(IP_EVENT, IP_EVENT_STA_GOT_IP,
-                                               &on_got_ip, NULL));
-#ifdef CONFIG_ANJAY_WIFI_CONNECT_IPV6
-    ESP_ERROR_CHECK(
-            esp_event_handler_register(WIFI_EVENT, WIFI_EVENT_STA_CONNECTED,
-                                       &on_wifi_connect, s_anjay_esp_netif));
-    ESP_ERROR_CHECK(esp_event_handler_register(IP_EVENT, IP_EVENT_GOT_IP6,
-                                               &on_got_ipv6, NULL));
-#endif // CONFIG_ANJAY_WIFI_CONNECT_IPV6
+    for (int i = 0; i < 6; ++i) {
+        s_ap_cache.bssid[i] = (uint8_t) bssid[i];
+    }
+    s_ap_cache.channel = (uint8_t) channel;
+    s_ap_cache.magic = AP_CACHE_MAGIC;
+    return true;
+}
 
-    ESP_ERROR_CHECK(esp_wifi_set_storage(WIFI_STORAGE_RAM));
-    ESP_LOGI(TAG, "Connecting to %s...", wifi_config.sta.ssid);
-    ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_STA));
-    ESP_ERROR_CHECK(esp_wifi_set_config(WIFI_IF_STA, &wifi_config));
-    ESP_ERROR_CHECK(esp_wifi_start());
-    esp_wifi_connect();
+/**
+ * Restricts the scan to the cached access point if it belongs to the network
+ * being connected to. Returns true if the configuration has been modified.
+ */
+static bool ap_cache_apply(wifi_config_t *conf) {
+    if (conf->sta.bssid_set || !ap_cache_load()
+            || strncmp(s_ap_cache.ssid, (const char *) conf->sta.ssid,
+                       sizeof(conf->sta.ssid))) {
+        return false;
+    }
+    conf->sta.scan_method = WIFI_FAST_SCAN;
+    conf->sta.bssid_set = true;
+    memcpy(conf->sta.bssid, s_ap_cache.bssid, sizeof(conf->sta.bssid));
+    conf->sta.channel = s_ap_cache.channel;
+    ESP_LOGI(TAG, "Using cached AP " MACSTR " on channel %u",
+             MAC2STR(s_ap_cache.bssid), s_ap_cache.channel);
+    return true;
+}
 
-    ESP_ERROR_CHECK(esp_register_shutdown_handler(&stop));
-    ESP_LOGI(TAG, "Waiting for IP(s)");
-    for (int i = 0; i < NO_OF_IP_ADDRESSES_TO_WAIT_FOR; ++i) {
-        if (xSemaphoreTake(s_semph_get_ip_addrs,
-                           pdMS_TO_TICKS(MAX_WAITING_TIME_FOR_IP))
-                == pdFALSE) {
-            wifi_disconnect();
-            return ESP_FAIL;
-        }
+static void ap_cache_update(const wifi_config_t *conf) {
+    wifi_ap_record_t ap_info;
+    if (esp_wifi_sta_get_ap_info(&ap_info) != ESP_OK) {
+        return;
+    }
+    if (s_ap_cache.magic == AP_CACHE_MAGIC
+            && !strncmp(s_ap_cache.ssid, (const char *) conf->sta.ssid,
+                        sizeof(conf->sta.ssid))
+            && !memcmp(s_ap_cache.bssid, ap_info.bssid,
+                       sizeof(s_ap_cache.bssid))
+            && s_ap_cache.channel == ap_info.primary) {
+        return;
     }
+
+    s_ap_cache.magic = AP_CACHE_MAGIC;
+    snprintf(s_ap_cache.ssid, sizeof(s_ap_cache.ssid), "%.*s",
+             (int) sizeof(conf->sta.ssid), (const char *) conf->sta.ssid);
+    memcpy(s_ap_cache.bssid, ap_info.bssid, sizeof(s_ap_cache.bssid));
+    s_ap_cache.channel = ap_info.primary;
+
+    char ap[32];
+    snprintf(ap, sizeof(ap), MACSTR ",%u", MAC2STR(s_ap_cache.bssid),
+             s_ap_cache.channel);
+    storage_write_str(AP_CACHE_NAMESPACE, AP_CACHE_AP_KEY, ap);
+    storage_write_str(AP_CACHE_NAMESPACE, AP_CACHE_SSID_KEY, s_ap_cache.ssid);
+}
+
+static void ap_cache_invalidate(void) {
+    s_ap_cache.magic = 0;
+    storage_write_str(AP_CACHE_NAMESPACE, AP_CACHE_SSID_KEY, "");
+}
+#endif // CONFIG_ANJAY_WIFI_FAST_RECONNECT
+
+static void log_connect_timing(bool fast) {
+    int64_t now = esp_timer_get_time();
+    int64_t associated_us = s_associated_us ? s_associated_us : now;
+
+    ESP_LOGI(TAG,
+             "Connected using %s scan in %" PRId64 " ms (association %" PRId64
+             " ms, first address %" PRId64 " ms), %" PRId64 " ms since boot",
+             fast ? "fast" : "full", (now - s_connect_start_us) / 1000,
+             (associated_us - s_connect_start_us) / 1000,
+             (now - associated_us) / 1000, now / 1000);
+}
+
+static void log_ips(void) {
     // iterate over active interfaces, and print out IPs of "our" netifs
     esp_netif_t *netif = NULL;
     esp_netif_ip_info_t ip;
@@ -221,20 +511,196 @@ static esp_err_t connect(wifi_config_t *conf) {
 #endif // CONFIG_ANJAY_WIFI_CONNECT_IPV6
         }
     }
+}
+
+static wifi_connect_cb_t *take_connect_cb(void **out_arg) {
+    taskENTER_CRITICAL(&s_connect_cb_lock);
+    wifi_connect_cb_t *cb = s_connect_cb;
+    *out_arg = s_connect_cb_arg;
+    s_connect_cb = NULL;
+    s_connect_cb_arg = NULL;
+    taskEXIT_CRITICAL(&s_connect_cb_lock);
+    return cb;
+}
+
+static bool attempt_pending(void) {
+    taskENTER_CRITICAL(&s_connect_cb_lock);
+    bool pending = s_connect_cb != NULL;
+    taskEXIT_CRITICAL(&s_connect_cb_lock);
+    return pending;
+}
+
+static void finish_attempt(esp_err_t result) {
+    esp_timer_stop(s_connect_timer);
+    void *arg;
+    wifi_connect_cb_t *cb = take_connect_cb(&arg);
+    if (!cb) {
+        // cancelled by wifi_disconnect() in the meantime
+        return;
+    }
+    if (result == ESP_OK) {
+        log_connect_timing(s_fast);
+#ifdef CONFIG_ANJAY_WIFI_FAST_RECONNECT
+        ap_cache_update(&wifi_config);
+#endif // CONFIG_ANJAY_WIFI_FAST_RECONNECT
+        log_ips();
+    } else {
+        ESP_LOGW(TAG, "Timed out waiting for IP(s)");
+    }
+    cb(result, arg);
+}
+
+static void arm_connect_timer(int timeout_ms) {
+    esp_timer_stop(s_connect_timer);
+    s_connect_timer_generation = (uint32_t) atomic_load(&s_generation);
+    ESP_ERROR_CHECK(esp_timer_start_once(s_connect_timer,
+                                         (uint64_t) timeout_ms * 1000));
+}
+
+/*
+ * The attempt succeeds as soon as either address family is usable; the other
+ * one, if configured, keeps being set up in the background and the server
+ * connection tries both, starting with the one that worked last time (see
+ * family_cache.h).
+ */
+static void address_obtained(void) {
+    if (!attempt_pending()) {
+        return;
+    }
+    finish_attempt(ESP_OK);
+}
+
+/* (re)configures the station and starts associating, without waiting */
+static void start_attempt(bool use_ap_cache) {
+    wifi_config = s_requested_config;
+    s_fast = false;
+    int timeout_ms = MAX_WAITING_TIME_FOR_IP;
+#ifdef CONFIG_ANJAY_WIFI_FAST_RECONNECT
+    if (use_ap_cache && ap_cache_apply(&wifi_config)) {
+        s_fast = true;
+        timeout_ms = CONFIG_ANJAY_WIFI_FAST_RECONNECT_TIMEOUT;
+    }
+#else  // CONFIG_ANJAY_WIFI_FAST_RECONNECT
+    (void) use_ap_cache;
+#endif // CONFIG_ANJAY_WIFI_FAST_RECONNECT
+
+    s_got_ipv4 = false;
+    s_connect_start_us = esp_timer_get_time();
+    s_associated_us = 0;
+
+#ifdef CONFIG_ANJAY_WIFI_POWER_SAVE_MAX_MODEM
+    wifi_config.sta.listen_interval =
+            CONFIG_ANJAY_WIFI_POWER_SAVE_LISTEN_INTERVAL;
+#endif // CONFIG_ANJAY_WIFI_POWER_SAVE_MAX_MODEM
+
+    ESP_LOGI(TAG, "Connecting to %s...", wifi_config.sta.ssid);
+    ESP_ERROR_CHECK(esp_wifi_set_config(WIFI_IF_STA, &wifi_config));
+    esp_wifi_connect();
+    arm_connect_timer(timeout_ms);
+}
+
+static void on_connect_timer(void *arg) {
+    post_timer_event(s_connect_timer, ANJAY_CONNECT_EVENT_TIMEOUT,
+                     &s_connect_timer_generation);
+}
+
+#ifdef CONFIG_ANJAY_WIFI_FAST_RECONNECT
+/*
+ * Starts the attempt over from an event handler. advance_generation() could
+ * block on the queue of the very loop that runs it, so the generation is
+ * deactivated directly instead; the events of the dropped association are
+ * queued behind this handler and ignored until the marker posted after them.
+ */
+static void restart_attempt(bool use_ap_cache) {
+    s_event_active = false;
+    esp_timer_stop(s_reconnect_timer);
+    esp_wifi_disconnect();
+
+    const generation_marker_t marker = {
+        .generation = (uint32_t) atomic_fetch_add(&s_generation, 1) + 1,
+        .active = true
+    };
+    if (esp_event_post(ANJAY_CONNECT_EVENT, ANJAY_CONNECT_EVENT_GENERATION,
+                       &marker, sizeof(marker), 0)
+            != ESP_OK) {
+        // Queue full: the disconnection is handled as if it belonged to the
+        // new attempt, which reconnect() tolerates
+        on_generation(NULL, ANJAY_CONNECT_EVENT,
+                      ANJAY_CONNECT_EVENT_GENERATION, (void *) &marker);
+    }
+    start_attempt(use_ap_cache);
+}
+#endif // CONFIG_ANJAY_WIFI_FAST_RECONNECT
+
+static void on_connect_timeout(void *arg,
+                               esp_event_base_t event_base,
+                               int32_t event_id,
+                               void *event_data) {
+    if (!is_current_timer_event(event_data) || !attempt_pending()) {
+        return;
+    }
+#ifdef CONFIG_ANJAY_WIFI_FAST_RECONNECT
+    if (s_fast) {
+        // The AP may have moved to another channel or been replaced; forget
+        // it and retry with a full scan
+        ESP_LOGW(TAG, "Cached AP unreachable, falling back to a full scan");
+        ap_cache_invalidate();
+        restart_attempt(false);
+        return;
+    }
+#endif // CONFIG_ANJAY_WIFI_FAST_RECONNECT
+    finish_attempt(ESP_ERR_TIMEOUT);
+}
+
+/* drops the pending attempt, if any; events emitted from now on are ignored */
+static void cancel_attempt(void) {
+    void *arg;
+    take_connect_cb(&arg);
+    esp_timer_stop(s_connect_timer);
+    esp_timer_stop(s_reconnect_timer);
+    advance_generation(false);
+
+    taskENTER_CRITICAL(&s_reconnect_stats_lock);
+    s_reconnect_stats.backing_off = false;
+    s_reconnect_stats.consecutive_failures = 0;
+    taskEXIT_CRITICAL(&s_reconnect_stats_lock);
+    wifi_status_set_disconnected();
+}
+
+static esp_err_t connect(const wifi_config_t *conf,
+                         wifi_connect_cb_t *cb,
+                         void *arg) {
+    if (s_started) {
+        // Leaving the access point is enough to switch networks; stopping
+        // the driver would add its restart and calibration to every change
+        cancel_attempt();
+        esp_wifi_disconnect();
+    }
+    s_requested_config = *conf;
+    backoff_reset(&s_reconnect_backoff);
+    advance_generation(true);
+
+    taskENTER_CRITICAL(&s_connect_cb_lock);
+    s_connect_cb = cb;
+    s_connect_cb_arg = arg;
+    taskEXIT_CRITICAL(&s_connect_cb_lock);
+
+    if (!s_started) {
+        ESP_ERROR_CHECK(esp_wifi_set_storage(WIFI_STORAGE_RAM));
+        ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_STA));
+        ESP_ERROR_CHECK(esp_wifi_start());
+        ESP_ERROR_CHECK(esp_wifi_set_ps(s_low_latency ? WIFI_PS_NONE
+                                                      : POWER_SAVE_PROFILE));
+        ESP_ERROR_CHECK(esp_register_shutdown_handler(&stop));
+        s_started = true;
+    }
+    start_attempt(true);
     return ESP_OK;
 }
 
 static void disconnect(void) {
-    ESP_ERROR_CHECK(esp_event_handler_unregister(
-            WIFI_EVENT, WIFI_EVENT_STA_DISCONNECTED, &on_wifi_disconnect));
-    ESP_ERROR_CHECK(esp_event_handler_unregister(IP_EVENT, IP_EVENT_STA_GOT_IP,
-                                                 &on_got_ip));
-#ifdef CONFIG_ANJAY_WIFI_CONNECT_IPV6
-    ESP_ERROR_CHECK(esp_event_handler_unregister(IP_EVENT, IP_EVENT_GOT_IP6,
-                                                 &on_got_ipv6));
-    ESP_ERROR_CHECK(esp_event_handler_unregister(
-            WIFI_EVENT, WIFI_EVENT_STA_CONNECTED, &on_wifi_connect));
-#endif // CONFIG_ANJAY_WIFI_CONNECT_IPV6
+    cancel_attempt();
+    s_started = false;
     esp_err_t err = esp_wifi_stop();
     if (err == ESP_ERR_WIFI_NOT_INIT) {
         return;
@@ -243,11 +709,62 @@ static void disconnect(void) {
 }
 
 static void deinit(void) {
+    unregister_handlers();
     ESP_ERROR_CHECK(esp_wifi_deinit());
     ESP_ERROR_CHECK(
             esp_wifi_clear_default_wifi_driver_and_handlers(s_anjay_esp_netif));
     esp_netif_destroy(s_anjay_esp_netif);
     s_anjay_esp_netif = NULL;
+    esp_timer_delete(s_connect_timer);
+    s_connect_timer = NULL;
+    esp_timer_delete(s_reconnect_timer);
+    s_reconnect_timer = NULL;
+}
+
+static void register_handlers(void) {
+    ESP_ERROR_CHECK(esp_event_handler_register(ANJAY_CONNECT_EVENT,
+                                               ANJAY_CONNECT_EVENT_GENERATION,
+                                               &on_generation, NULL));
+    ESP_ERROR_CHECK(esp_event_handler_register(WIFI_EVENT,
+                                               WIFI_EVENT_STA_DISCONNECTED,
+                                               &on_wifi_disconnect, NULL));
+    ESP_ERROR_CHECK(esp_event_handler_register(IP_EVENT, IP_EVENT_STA_GOT_IP,
+                                               &on_got_ip, NULL));
+    ESP_ERROR_CHECK(
+            esp_event_handler_register(WIFI_EVENT, WIFI_EVENT_STA_CONNECTED,
+                                       &on_wifi_connect, s_anjay_esp_netif));
+#ifdef CONFIG_ANJAY_WIFI_CONNECT_IPV6
+    ESP_ERROR_CHECK(esp_event_handler_register(IP_EVENT, IP_EVENT_GOT_IP6,
+                                               &on_got_ipv6, NULL));
+#endif // CONFIG_ANJAY_WIFI_CONNECT_IPV6
+    ESP_ERROR_CHECK(esp_event_handler_register(ANJAY_CONNECT_EVENT,
+                                               ANJAY_CONNECT_EVENT_TIMEOUT,
+                                               &on_connect_timeout, NULL));
+    ESP_ERROR_CHECK(esp_event_handler_register(ANJAY_CONNECT_EVENT,
+                                               ANJAY_CONNECT_EVENT_RECONNECT,
+                                               &on_reconnect_due, NULL));
+}
+
+static void unregister_handlers(void) {
+    ESP_ERROR_CHECK(esp_event_handler_unregister(
+            ANJAY_CONNECT_EVENT, ANJAY_CONNECT_EVENT_GENERATION,
+            &on_generation));
+    ESP_ERROR_CHECK(esp_event_handler_unregister(
+            WIFI_EVENT, WIFI_EVENT_STA_DISCONNECTED, &on_wifi_disconnect));
+    ESP_ERROR_CHECK(esp_event_handler_unregister(IP_EVENT, IP_EVENT_STA_GOT_IP,
+                                                 &on_got_ip));
+    ESP_ERROR_CHECK(esp_event_handler_unregister(
+            WIFI_EVENT, WIFI_EVENT_STA_CONNECTED, &on_wifi_connect));
+#ifdef CONFIG_ANJAY_WIFI_CONNECT_IPV6
+    ESP_ERROR_CHECK(esp_event_handler_unregister(IP_EVENT, IP_EVENT_GOT_IP6,
+                                                 &on_got_ipv6));
+#endif // CONFIG_ANJAY_WIFI_CONNECT_IPV6
+    ESP_ERROR_CHECK(esp_event_handler_unregister(ANJAY_CONNECT_EVENT,
+                                                 ANJAY_CONNECT_EVENT_TIMEOUT,
+                                                 &on_connect_timeout));
+    ESP_ERROR_CHECK(esp_event_handler_unregister(
+            ANJAY_CONNECT_EVENT, ANJAY_CONNECT_EVENT_RECONNECT,
+            &on_reconnect_due));
 }
 
 void wifi_initialize(void) {
@@ -268,19 +785,63 @@ void wifi_initialize(void) {
     free(desc);
     esp_wifi_set_default_wifi_sta_handlers();
 
-    /* create semaphore if at least one interface is active */
-    s_semph_get_ip_addrs =
-            xSemaphoreCreateCounting(NO_OF_IP_ADDRESSES_TO_WAIT_FOR, 0);
+    const esp_timer_create_args_t timer_args = {
+        .callback = on_connect_timer,
+        .name = "wifi_connect"
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&timer_args, &s_connect_timer));
+    const esp_timer_create_args_t reconnect_timer_args = {
+        .callback = on_reconnect_timer,
+        .name = "wifi_reconnect"
+    };
+    ESP_ERROR_CHECK(
+            esp_timer_create(&reconnect_timer_args, &s_reconnect_timer));
+    backoff_init(&s_reconnect_backoff, CONFIG_ANJAY_WIFI_RECONNECT_BACKOFF_BASE,
+                 CONFIG_ANJAY_WIFI_RECONNECT_BACKOFF_MAX,
+                 CONFIG_ANJAY_WIFI_RECONNECT_BACKOFF_JITTER);
+    register_handlers();
+    s_semph_connect_done = xSemaphoreCreateBinary();
+}
+
+esp_err_t wifi_connect_async(const wifi_config_t *conf,
+                             wifi_connect_cb_t *cb,
+                             void *arg) {
+    if (s_semph_connect_done == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (!cb) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return connect(conf, cb, arg);
+}
+
+static void on_blocking_connect_done(esp_err_t result, void *result_ptr) {
+    *(esp_err_t *) result_ptr = result;
+    xSemaphoreGive(s_semph_connect_done);
 }
 
 esp_err_t wifi_connect(wifi_config_t *conf) {
-    return connect(conf);
+    esp_err_t result = ESP_FAIL;
+    esp_err_t err =
+            wifi_connect_async(conf, on_blocking_connect_done, &result);
+    if (err != ESP_OK) {
+        return err;
+    }
+    ESP_LOGI(TAG, "Waiting for IP(s)");
+    xSemaphoreTake(s_semph_connect_done, portMAX_DELAY);
+    if (result != ESP_OK) {
+        wifi_disconnect();
+    }
+    return result;
 }
 
 esp_err_t wifi_disconnect(void) {
-    if (s_semph_get_ip_addrs == NULL) {
+    if (s_semph_connect_done == NULL) {
         return ESP_ERR_INVALID_STATE;
     }
+    if (!s_started) {
+        return ESP_OK;
+    }
     disconnect();
     ESP_ERROR_CHECK(esp_unregister_shutdown_handler(&stop));
 
@@ -288,14 +849,78 @@ esp_err_t wifi_disconnect(void) {
 }
 
 esp_err_t wifi_deinitialize(void) {
-    if (s_semph_get_ip_addrs == NULL) {
+    if (s_semph_connect_done == NULL) {
         return ESP_ERR_INVALID_STATE;
     }
-    vSemaphoreDelete(s_semph_get_ip_addrs);
-    s_semph_get_ip_addrs = NULL;
+    wifi_disconnect();
+    vSemaphoreDelete(s_semph_connect_done);
+    s_semph_connect_done = NULL;
 
     deinit();
-    ESP_ERROR_CHECK(esp_unregister_shutdown_handler(&stop));
 
     return ESP_OK;
 }
+
+static void account_power_save_time(int64_t now_us) {
+    int64_t elapsed_us = now_us - s_power_save_since_us;
+    if (s_low_latency || POWER_SAVE_PROFILE == WIFI_PS_NONE) {
+        s_power_save_stats.low_latency_us += elapsed_us;
+    } else {
+        s_power_save_stats.power_save_us += elapsed_us;
+    }
+    s_power_save_since_us = now_us;
+}
+
+void wifi_power_save_set_low_latency(bool low_latency) {
+    if (POWER_SAVE_PROFILE == WIFI_PS_NONE || low_latency == s_low_latency) {
+        return;
+    }
+    account_power_save_time(esp_timer_get_time());
+    s_low_latency = low_latency;
+    s_power_save_stats.switches++;
+
+    esp_err_t err =
+            esp_wifi_set_ps(low_latency ? WIFI_PS_NONE : POWER_SAVE_PROFILE);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Could not change power save mode: %s",
+                 esp_err_to_name(err));
+    }
+}
+
+void wifi_get_power_save_stats(wifi_power_save_stats_t *out_stats) {
+    account_power_save_time(esp_timer_get_time());
+    *out_stats = s_power_save_stats;
+}
+
+void wifi_log_power_save_stats(void) {
+    wifi_power_save_stats_t stats;
+    wifi_get_power_save_stats(&stats);
+    int64_t total_us = stats.low_latency_us + stats.power_save_us;
+    ESP_LOGI(TAG,
+             "power save: %s, %" PRId64 "%% of time in low-latency mode, "
+             "%" PRIu32 " switches",
+             POWER_SAVE_PROFILE == WIFI_PS_MAX_MODEM
+                     ? "max modem"
+                     : POWER_SAVE_PROFILE == WIFI_PS_MIN_MODEM ? "min modem"
+                                                               : "none",
+             total_us ? stats.low_latency_us * 100 / total_us : 0,
+             stats.switches);
+}
+
+void wifi_get_reconnect_stats(wifi_reconnect_stats_t *out_stats) {
+    taskENTER_CRITICAL(&s_reconnect_stats_lock);
+    *out_stats = s_reconnect_stats;
+    taskEXIT_CRITICAL(&s_reconnect_stats_lock);
+}
+
+void wifi_log_reconnect_stats(void) {
+    wifi_reconnect_stats_t stats;
+    wifi_get_reconnect_stats(&stats);
+    ESP_LOGI(TAG,
+             "reconnect: disconnects %" PRIu32 ", attempts %" PRIu32
+             ", consecutive failures %" PRIu32 ", %s %" PRIu32 " ms",
+             stats.disconnects, stats.reconnect_attempts,
+             stats.consecutive_failures,
+             stats.backing_off ? "backing off for" : "last delay",
+             stats.current_delay_ms);
+}
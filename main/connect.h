@@ -17,12 +17,75 @@
 #ifndef _CONNECT_H_
 #define _CONNECT_H_
 
+#include <stdbool.h>
+#include <stdint.h>
+
 #include <esp_err.h>
 #include <esp_wifi.h>
 
+/**
+ * Called from the default event loop task when a connection attempt started
+ * with wifi_connect_async() ends: with ESP_OK once an IPv4 or a routable IPv6
+ * address has been obtained, or with ESP_ERR_TIMEOUT if none has arrived in
+ * time. In the latter case the station keeps trying in the
+ * background until wifi_disconnect() is called.
+ */
+typedef void wifi_connect_cb_t(esp_err_t result, void *arg);
+
+/**
+ * State of the automatic reconnection after the station loses its access
+ * point. Counters are cumulative since boot.
+ */
+typedef struct {
+    /* waiting for the backoff delay to pass before the next attempt */
+    bool backing_off;
+    /* delay of the pending, or most recent, reconnection attempt */
+    uint32_t current_delay_ms;
+    /* disconnects since the last obtained IPv4 address */
+    uint32_t consecutive_failures;
+    uint32_t disconnects;
+    uint32_t reconnect_attempts;
+} wifi_reconnect_stats_t;
+
+/**
+ * Time spent with power save enabled (according to the configured profile)
+ * and disabled, since boot.
+ */
+typedef struct {
+    int64_t power_save_us;
+    int64_t low_latency_us;
+    uint32_t switches;
+} wifi_power_save_stats_t;
+
 void wifi_initialize(void);
+
+/**
+ * Drops the current connection, if any, and starts connecting to @p conf
+ * without waiting for the result. Wi-Fi is only started on the first call
+ * after wifi_initialize() or wifi_disconnect(). @p cb must not be NULL; it is not called if
+ * wifi_disconnect() or another wifi_connect_async() happens first.
+ */
+esp_err_t wifi_connect_async(const wifi_config_t *conf,
+                             wifi_connect_cb_t *cb,
+                             void *arg);
+
+/**
+ * Blocking variant of wifi_connect_async(). Leaves Wi-Fi stopped on failure.
+ */
 esp_err_t wifi_connect(wifi_config_t *conf);
 esp_err_t wifi_disconnect(void);
 esp_err_t wifi_deinitialize(void);
 
+void wifi_get_reconnect_stats(wifi_reconnect_stats_t *out_stats);
+void wifi_log_reconnect_stats(void);
+
+/**
+ * Temporarily disables modem sleep, e.g. while an LwM2M exchange is in
+ * progress, or restores the profile selected in Kconfig. Must be called from
+ * the same task as wifi_connect_async().
+ */
+void wifi_power_save_set_low_latency(bool low_latency);
+void wifi_get_power_save_stats(wifi_power_save_stats_t *out_stats);
+void wifi_log_power_save_stats(void);
+
 #endif // _CONNECT_H_
@@ -0,0 +1,125 @@
+/*
+ * Copyright 2021-2025 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <inttypes.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <esp_random.h>
+#include <esp_system.h>
+
+#include <avsystem/commons/avs_log.h>
+
+#include "connect.h"
+#include "connect_stress_test.h"
+#include "sdkconfig.h"
+
+// Upper bound of the random time an attempt is left running, so that cycles
+// hit every phase: scanning, association, DHCP and an established connection
+#define CONNECT_STRESS_TEST_MAX_HOLD_MS 50
+
+// Time for the default event loop to drain the events of the last cycle
+#define CONNECT_STRESS_TEST_SETTLE_MS 1000
+
+// Allowance for allocations that legitimately outlive a cycle, e.g. lwIP
+// pools growing on first use
+#define CONNECT_STRESS_TEST_HEAP_TOLERANCE 1024
+
+#define CONNECT_STRESS_TEST_LOG_PERIOD 1000
+
+static atomic_uint_fast32_t s_completions;
+static atomic_uint_fast32_t s_duplicate_completions;
+// Bit per cycle, set when its attempt completes
+static uint8_t
+        s_completed[(CONFIG_ANJAY_WIFI_CONNECT_STRESS_TEST_ITERATIONS + 7) / 8];
+
+// Called from the default event loop task
+static void on_connect_done(esp_err_t result, void *arg) {
+    (void) result;
+    uint32_t attempt = (uint32_t) (uintptr_t) arg;
+    uint8_t bit = (uint8_t) (1 << (attempt % 8));
+
+    atomic_fetch_add(&s_completions, 1);
+    if (s_completed[attempt / 8] & bit) {
+        atomic_fetch_add(&s_duplicate_completions, 1);
+    }
+    s_completed[attempt / 8] |= bit;
+}
+
+static void hold(void) {
+    vTaskDelay(pdMS_TO_TICKS(esp_random()
+                             % (CONNECT_STRESS_TEST_MAX_HOLD_MS + 1)));
+}
+
+static uint32_t cycle(const wifi_config_t *conf, uint32_t attempt) {
+    if (wifi_connect_async(conf, on_connect_done,
+                           (void *) (uintptr_t) attempt)
+            != ESP_OK) {
+        return 1;
+    }
+    hold();
+    // Every other cycle supersedes the attempt without disconnecting first,
+    // as a WLAN reconfiguration does
+    if (attempt % 2) {
+        return 0;
+    }
+    return wifi_disconnect() != ESP_OK;
+}
+
+int connect_stress_test_run(const wifi_config_t *conf) {
+    uint32_t failed_calls = 0;
+
+    // The first cycle allocates the driver buffers for good
+    failed_calls += cycle(conf, 0);
+    vTaskDelay(pdMS_TO_TICKS(CONNECT_STRESS_TEST_SETTLE_MS));
+    uint32_t heap_before = esp_get_free_heap_size();
+
+    for (uint32_t attempt = 1;
+         attempt < CONFIG_ANJAY_WIFI_CONNECT_STRESS_TEST_ITERATIONS;
+         attempt++) {
+        failed_calls += cycle(conf, attempt);
+        if (!(attempt % CONNECT_STRESS_TEST_LOG_PERIOD)) {
+            avs_log(connect_stress_test, INFO,
+                    "%" PRIu32 " cycles, %" PRIu32 " bytes of heap free",
+                    attempt, esp_get_free_heap_size());
+        }
+    }
+    wifi_disconnect();
+    vTaskDelay(pdMS_TO_TICKS(CONNECT_STRESS_TEST_SETTLE_MS));
+    uint32_t heap_after = esp_get_free_heap_size();
+
+    uint32_t duplicates = (uint32_t) atomic_load(&s_duplicate_completions);
+    bool leaked =
+            heap_after + CONNECT_STRESS_TEST_HEAP_TOLERANCE < heap_before;
+    avs_log(connect_stress_test, INFO,
+            "%d cycles: %" PRIu32 " completions, %" PRIu32
+            " duplicate, %" PRIu32 " failed calls, heap free %" PRIu32
+            " -> %" PRIu32 " bytes",
+            CONFIG_ANJAY_WIFI_CONNECT_STRESS_TEST_ITERATIONS,
+            (uint32_t) atomic_load(&s_completions), duplicates, failed_calls,
+            heap_before, heap_after);
+    if (duplicates || failed_calls || leaked) {
+        avs_log(connect_stress_test, ERROR, "Connect stress test failed");
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,34 @@
+/*
+ * Copyright 2021-2025 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef CONNECT_STRESS_TEST_H
+#define CONNECT_STRESS_TEST_H
+
+#include <esp_wifi.h>
+
+/**
+ * Alternates wifi_connect_async() to @p conf, reconfigurations made while an
+ * attempt is pending and wifi_disconnect() for
+ * CONFIG_ANJAY_WIFI_CONNECT_STRESS_TEST_ITERATIONS cycles. Checks that every
+ * call succeeds, that no completion callback is called twice and that the
+ * free heap returns to its initial level. Wi-Fi is left stopped.
+ *
+ * @returns 0 if all checks passed, -1 otherwise.
+ */
+int connect_stress_test_run(const wifi_config_t *conf);
+
+#endif // CONNECT_STRESS_TEST_H
@@ -0,0 +1,143 @@
+/*
+ * Copyright 2021-2025 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <avsystem/commons/avs_defs.h>
+#include <avsystem/commons/avs_list.h>
+#include <avsystem/commons/avs_log.h>
+#include <avsystem/commons/avs_socket.h>
+#include <avsystem/commons/avs_time.h>
+
+#include <anjay/anjay.h>
+
+#include "dtls_stats.h"
+
+#define DTLS_STATS_MAX_SOCKETS 4
+
+typedef struct {
+    uint32_t count;
+    int64_t total_ms;
+    int64_t max_ms;
+} handshake_stats_t;
+
+typedef struct {
+    avs_net_socket_t *socket;
+    bool connected;
+} tracked_socket_t;
+
+static tracked_socket_t tracked[DTLS_STATS_MAX_SOCKETS];
+static handshake_stats_t full_handshakes;
+static handshake_stats_t resumed_handshakes;
+
+static bool socket_connected(avs_net_socket_t *socket) {
+    avs_net_socket_opt_value_t value;
+    return avs_is_ok(avs_net_socket_get_opt(socket, AVS_NET_SOCKET_OPT_STATE,
+                                            &value))
+           && value.state == AVS_NET_SOCKET_STATE_CONNECTED;
+}
+
+// Returns -1 for sockets without (D)TLS, e.g. in NoSec mode
+static int session_resumed(avs_net_socket_t *socket) {
+    avs_net_socket_opt_value_t value;
+    if (avs_is_err(avs_net_socket_get_opt(
+                socket, AVS_NET_SOCKET_OPT_SESSION_RESUMED, &value))) {
+        return -1;
+    }
+    return value.flag ? 1 : 0;
+}
+
+static tracked_socket_t *get_tracked(avs_net_socket_t *socket) {
+    tracked_socket_t *free_slot = NULL;
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(tracked); i++) {
+        if (tracked[i].socket == socket) {
+            return &tracked[i];
+        }
+        if (!tracked[i].socket && !free_slot) {
+            free_slot = &tracked[i];
+        }
+    }
+    if (free_slot) {
+        free_slot->socket = socket;
+        free_slot->connected = false;
+    }
+    return free_slot;
+}
+
+static void record(handshake_stats_t *stats, int64_t duration_ms) {
+    stats->count++;
+    stats->total_ms += duration_ms;
+    stats->max_ms = AVS_MAX(stats->max_ms, duration_ms);
+}
+
+void dtls_stats_after_sched_run(anjay_t *anjay,
+                                avs_time_duration_t sched_run_duration) {
+    bool seen[DTLS_STATS_MAX_SOCKETS] = { false };
+
+    AVS_LIST(const anjay_socket_entry_t) entry =
+            anjay_get_socket_entries(anjay);
+    AVS_LIST_ITERATE(entry) {
+        if (!entry->socket) {
+            continue;
+        }
+        tracked_socket_t *slot = get_tracked(entry->socket);
+        if (!slot) {
+            continue;
+        }
+        seen[slot - tracked] = true;
+
+        bool connected = socket_connected(entry->socket);
+        int resumed;
+        if (connected && !slot->connected
+                && (resumed = session_resumed(entry->socket)) >= 0) {
+            int64_t duration_ms = 0;
+            avs_time_duration_to_scalar(&duration_ms, AVS_TIME_MS,
+                                        sched_run_duration);
+            record(resumed ? &resumed_handshakes : &full_handshakes,
+                   duration_ms);
+            avs_log(dtls_stats, DEBUG,
+                    "SSID %u: %s handshake, ~%" PRId64 " ms",
+                    (unsigned) entry->ssid, resumed ? "resumed" : "full",
+                    duration_ms);
+        }
+        slot->connected = connected;
+    }
+
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(tracked); i++) {
+        if (!seen[i]) {
+            tracked[i].socket = NULL;
+        }
+    }
+}
+
+void dtls_stats_log(void) {
+    avs_log(dtls_stats, INFO,
+            "handshakes: full %" PRIu32 " (avg %" PRId64 " ms, max %" PRId64
+            " ms), resumed %" PRIu32 " (avg %" PRId64 " ms, max %" PRId64
+            " ms)",
+            full_handshakes.count,
+            full_handshakes.count
+                    ? full_handshakes.total_ms / full_handshakes.count
+                    : 0,
+            full_handshakes.max_ms, resumed_handshakes.count,
+            resumed_handshakes.count
+                    ? resumed_handshakes.total_ms / resumed_handshakes.count
+                    : 0,
+            resumed_handshakes.max_ms);
+}
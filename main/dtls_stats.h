@@ -0,0 +1,38 @@
+/*
+ * Copyright 2021-2025 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DTLS_STATS_H
+#define DTLS_STATS_H
+
+#include <avsystem/commons/avs_time.h>
+
+#include <anjay/core.h>
+
+/**
+ * Detects (D)TLS handshakes performed since the previous call by looking for
+ * server sockets that became connected. Anjay connects from scheduler jobs,
+ * so the duration of the scheduler run that completed the handshake is
+ * recorded as its duration.
+ */
+void dtls_stats_after_sched_run(anjay_t *anjay,
+                                avs_time_duration_t sched_run_duration);
+
+/**
+ * Logs the number and durations of full and resumed handshakes.
+ */
+void dtls_stats_log(void);
+
+#endif // DTLS_STATS_H
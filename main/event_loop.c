@@ -0,0 +1,245 @@
+/*
+ * Copyright 2021-2025 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <inttypes.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <sys/select.h>
+#include <sys/time.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <avsystem/commons/avs_defs.h>
+#include <avsystem/commons/avs_list.h>
+#include <avsystem/commons/avs_log.h>
+#include <avsystem/commons/avs_socket.h>
+#include <avsystem/commons/avs_time.h>
+
+#include <anjay/anjay.h>
+
+#include "dtls_stats.h"
+#include "event_loop.h"
+#include "main.h"
+
+#define EVENT_LOOP_MAX_SOCKETS 8
+
+// Upper bound of a single wait; it only matters for backends that cannot be
+// woken up and for sockets created while the loop is waiting
+#define EVENT_LOOP_MAX_WAIT_TIME_MS 1000
+
+typedef struct {
+    uint32_t iterations;
+    uint32_t ready_wakeups;
+    uint32_t timeouts;
+    uint32_t errors;
+    uint32_t serves;
+    uint32_t buffered_serves;
+    int64_t max_serve_us;
+} event_loop_stats_t;
+
+static volatile atomic_bool event_loop_status;
+static const event_loop_backend_t *volatile current_backend;
+static event_loop_stats_t stats;
+
+static bool has_buffered_data(avs_net_socket_t *socket) {
+    avs_net_socket_opt_value_t value;
+    return avs_is_ok(avs_net_socket_get_opt(
+                   socket, AVS_NET_SOCKET_HAS_BUFFERED_DATA, &value))
+           && value.flag;
+}
+
+static void serve_socket(anjay_t *anjay,
+                         const event_loop_backend_t *backend,
+                         avs_net_socket_t *socket,
+                         const void *system_socket) {
+    avs_time_monotonic_t start = avs_time_monotonic_now();
+    bool buffered = false;
+
+    note_network_activity();
+
+    // A single datagram may carry more than one message (e.g. several DTLS
+    // records), which would not be reported by the backend again
+    do {
+        int error = anjay_serve(anjay, socket);
+        if (error) {
+            avs_log(event_loop, ERROR, "anjay_serve failed, error code %d",
+                    error);
+        }
+        stats.serves++;
+        if (buffered) {
+            stats.buffered_serves++;
+        }
+        buffered = true;
+    } while (has_buffered_data(socket));
+
+    if (backend->served) {
+        backend->served(system_socket);
+    }
+
+    int64_t duration_us;
+    if (!avs_time_duration_to_scalar(
+                &duration_us, AVS_TIME_US,
+                avs_time_monotonic_diff(avs_time_monotonic_now(), start))) {
+        stats.max_serve_us = AVS_MAX(stats.max_serve_us, duration_us);
+    }
+}
+
+int event_loop_run(anjay_t *anjay, const event_loop_backend_t *backend) {
+    if (!atomic_compare_exchange_strong(&event_loop_status, &(bool) { false },
+                                        true)) {
+        avs_log(event_loop, ERROR, "Event loop is already running");
+        return -1;
+    }
+    current_backend = backend;
+    avs_log(event_loop, INFO, "Event loop started, backend: %s",
+            backend->name);
+
+    avs_net_socket_t *sockets[EVENT_LOOP_MAX_SOCKETS];
+    const void *system_sockets[EVENT_LOOP_MAX_SOCKETS];
+    bool ready[EVENT_LOOP_MAX_SOCKETS];
+    size_t rotation = 0;
+
+    while (atomic_load(&event_loop_status)) {
+        size_t sockets_count = 0;
+        AVS_LIST(avs_net_socket_t *const) anjay_sockets =
+                anjay_get_sockets(anjay);
+        AVS_LIST(avs_net_socket_t *const) socket = NULL;
+        AVS_LIST_FOREACH(socket, anjay_sockets) {
+            if (sockets_count >= EVENT_LOOP_MAX_SOCKETS) {
+                break;
+            }
+            sockets[sockets_count] = *socket;
+            system_sockets[sockets_count] = avs_net_socket_get_system(*socket);
+            sockets_count++;
+        }
+
+        int wait_ms = anjay_sched_calculate_wait_time_ms(
+                anjay, EVENT_LOOP_MAX_WAIT_TIME_MS);
+
+        int ready_count = backend->select(system_sockets, sockets_count, ready,
+                                          (uint32_t) wait_ms);
+        stats.iterations++;
+        if (ready_count < 0) {
+            stats.errors++;
+            // Persistent backend errors would otherwise turn this into a busy
+            // loop; wait as long as select() would have
+            vTaskDelay(AVS_MAX(pdMS_TO_TICKS(wait_ms), 1));
+        } else if (ready_count == 0) {
+            stats.timeouts++;
+        } else {
+            stats.ready_wakeups++;
+        }
+
+        // Every ready socket is served in a single pass; the starting point
+        // rotates so that a busy socket cannot delay the others indefinitely
+        for (size_t i = 0; ready_count > 0 && i < sockets_count; i++) {
+            size_t index = (rotation + i) % sockets_count;
+            if (ready[index]) {
+                serve_socket(anjay, backend, sockets[index],
+                             system_sockets[index]);
+            }
+        }
+        if (ready_count > 0) {
+            rotation++;
+        }
+
+        avs_time_monotonic_t sched_start = avs_time_monotonic_now();
+        anjay_sched_run(anjay);
+        dtls_stats_after_sched_run(
+                anjay, avs_time_monotonic_diff(avs_time_monotonic_now(),
+                                               sched_start));
+    }
+
+    current_backend = NULL;
+    return 0;
+}
+
+int event_loop_interrupt(void) {
+    if (!atomic_compare_exchange_strong(&event_loop_status, &(bool) { true },
+                                        false)) {
+        return -1;
+    }
+    const event_loop_backend_t *backend = current_backend;
+    if (backend && backend->wakeup) {
+        backend->wakeup();
+    }
+    return 0;
+}
+
+void event_loop_log_stats(void) {
+    const event_loop_backend_t *backend = current_backend;
+    if (!backend) {
+        return;
+    }
+    avs_log(event_loop, INFO,
+            "%s: iterations %" PRIu32 ", ready %" PRIu32 ", timeouts %" PRIu32
+            ", errors %" PRIu32 ", serves %" PRIu32 " (%" PRIu32
+            " buffered), max serve %" PRId64 "us",
+            backend->name, stats.iterations, stats.ready_wakeups,
+            stats.timeouts, stats.errors, stats.serves, stats.buffered_serves,
+            stats.max_serve_us);
+    memset(&stats, 0, sizeof(stats));
+}
+
+static int lwip_select(const void *const *system_sockets,
+                       size_t sockets_count,
+                       bool *out_ready,
+                       uint32_t timeout_ms) {
+    fd_set read_fds;
+    FD_ZERO(&read_fds);
+    int max_fd = -1;
+    for (size_t i = 0; i < sockets_count; i++) {
+        const int *fd = (const int *) system_sockets[i];
+        if (fd && *fd >= 0) {
+            FD_SET(*fd, &read_fds);
+            max_fd = AVS_MAX(max_fd, *fd);
+        }
+        out_ready[i] = false;
+    }
+    if (max_fd < 0) {
+        vTaskDelay(pdMS_TO_TICKS(timeout_ms));
+        return 0;
+    }
+
+    struct timeval timeout = {
+        .tv_sec = timeout_ms / 1000,
+        .tv_usec = (timeout_ms % 1000) * 1000
+    };
+    int result = select(max_fd + 1, &read_fds, NULL, NULL, &timeout);
+    if (result <= 0) {
+        return result;
+    }
+
+    int ready_count = 0;
+    for (size_t i = 0; i < sockets_count; i++) {
+        const int *fd = (const int *) system_sockets[i];
+        out_ready[i] = fd && *fd >= 0 && FD_ISSET(*fd, &read_fds);
+        if (out_ready[i]) {
+            ready_count++;
+        }
+    }
+    return ready_count;
+}
+
+const event_loop_backend_t EVENT_LOOP_BACKEND_LWIP = {
+    .name = "lwip",
+    .select = lwip_select
+};
@@ -0,0 +1,92 @@
+/*
+ * Copyright 2021-2025 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef EVENT_LOOP_H
+#define EVENT_LOOP_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <anjay/core.h>
+
+#include "sdkconfig.h"
+
+/**
+ * Source of socket readiness for @ref event_loop_run. The loop itself owns
+ * scheduler integration, serving and statistics; a backend only needs to tell
+ * which sockets can be read.
+ */
+typedef struct {
+    const char *name;
+
+    /**
+     * Waits until any of @p system_sockets (as returned by
+     * avs_net_socket_get_system()) is readable, or until @p timeout_ms passes.
+     * Fills @p out_ready and returns the number of ready sockets, 0 on timeout
+     * or -1 on error.
+     */
+    int (*select)(const void *const *system_sockets,
+                  size_t sockets_count,
+                  bool *out_ready,
+                  uint32_t timeout_ms);
+
+    /**
+     * Optional. Called after a socket has been served and no more data is
+     * buffered on the avs_net level. Meant for checking data held outside of
+     * the socket, e.g. in a modem, once per serve rather than once per
+     * message.
+     */
+    void (*served)(const void *system_socket);
+
+    /**
+     * Optional. Makes a pending select call return early. Without it,
+     * @ref event_loop_interrupt takes effect after at most
+     * EVENT_LOOP_MAX_WAIT_TIME_MS.
+     */
+    void (*wakeup)(void);
+} event_loop_backend_t;
+
+extern const event_loop_backend_t EVENT_LOOP_BACKEND_LWIP;
+#ifdef CONFIG_ANJAY_CLIENT_INTERFACE_BG96_MODULE
+extern const event_loop_backend_t EVENT_LOOP_BACKEND_BG96;
+#    define EVENT_LOOP_DEFAULT_BACKEND (&EVENT_LOOP_BACKEND_BG96)
+#else // CONFIG_ANJAY_CLIENT_INTERFACE_BG96_MODULE
+#    define EVENT_LOOP_DEFAULT_BACKEND (&EVENT_LOOP_BACKEND_LWIP)
+#endif // CONFIG_ANJAY_CLIENT_INTERFACE_BG96_MODULE
+
+/**
+ * Serves Anjay sockets and runs its scheduler until @ref event_loop_interrupt
+ * is called.
+ *
+ * @returns 0 after being interrupted, -1 if the loop is already running.
+ */
+int event_loop_run(anjay_t *anjay, const event_loop_backend_t *backend);
+
+/**
+ * Makes @ref event_loop_run return. Safe to call from any task.
+ *
+ * @returns 0 on success, -1 if the loop is not running.
+ */
+int event_loop_interrupt(void);
+
+/**
+ * Logs iteration, wakeup and serve counters of the loop since the previous
+ * call.
+ */
+void event_loop_log_stats(void);
+
+#endif // EVENT_LOOP_H
@@ -0,0 +1,91 @@
+/*
+ * Copyright 2021-2025 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <nvs.h>
+
+#include <avsystem/commons/avs_log.h>
+#include <avsystem/commons/avs_socket.h>
+
+#include "family_cache.h"
+#include "storage.h"
+
+#define FAMILY_CACHE_NAMESPACE "family_cache"
+
+/*
+ * NVS keys are limited to 15 characters, so servers are told apart by a hash
+ * of their URI.
+ */
+static void get_cache_key(const char *server_uri, char *buf, size_t buf_size) {
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    for (const char *c = server_uri; *c; c++) {
+        hash = (hash ^ (uint8_t) *c) * 16777619u;
+    }
+    snprintf(buf, buf_size, "%08" PRIx32, hash);
+}
+
+static uint8_t family_to_u8(avs_net_af_t family) {
+    return family == AVS_NET_AF_INET6 ? 6 : family == AVS_NET_AF_INET4 ? 4 : 0;
+}
+
+avs_net_af_t family_cache_get(const char *server_uri) {
+    char key[NVS_KEY_NAME_MAX_SIZE];
+    get_cache_key(server_uri, key, sizeof(key));
+
+    nvs_handle_t nvs_h;
+    uint8_t family = 0;
+    if (nvs_open(FAMILY_CACHE_NAMESPACE, NVS_READONLY, &nvs_h)) {
+        return AVS_NET_AF_UNSPEC;
+    }
+    esp_err_t err = nvs_get_u8(nvs_h, key, &family);
+    nvs_close(nvs_h);
+
+    if (err != ESP_OK) {
+        return AVS_NET_AF_UNSPEC;
+    }
+    return family == 6 ? AVS_NET_AF_INET6
+                       : family == 4 ? AVS_NET_AF_INET4 : AVS_NET_AF_UNSPEC;
+}
+
+void family_cache_update(const char *server_uri, avs_net_socket_t *socket) {
+    // Avoids reading NVS on every call
+    static avs_net_af_t last_family = AVS_NET_AF_UNSPEC;
+    char remote_host[64];
+
+    if (avs_is_err(avs_net_socket_get_remote_host(socket, remote_host,
+                                                  sizeof(remote_host)))) {
+        return;
+    }
+    // Only IPv6 addresses contain colons in their text form
+    avs_net_af_t family =
+            strchr(remote_host, ':') ? AVS_NET_AF_INET6 : AVS_NET_AF_INET4;
+    if (family == last_family) {
+        return;
+    }
+    last_family = family;
+    if (family != family_cache_get(server_uri)) {
+        char key[NVS_KEY_NAME_MAX_SIZE];
+        get_cache_key(server_uri, key, sizeof(key));
+        avs_log(family_cache, INFO, "Preferring IPv%u for %s",
+                (unsigned) family_to_u8(family), server_uri);
+        storage_write_u8(FAMILY_CACHE_NAMESPACE, key, family_to_u8(family));
+    }
+}
@@ -0,0 +1,39 @@
+/*
+ * Copyright 2021-2025 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FAMILY_CACHE_H
+#define FAMILY_CACHE_H
+
+#include <avsystem/commons/avs_socket.h>
+
+/**
+ * Address family over which the client last connected to @p server_uri, as
+ * stored in NVS, or AVS_NET_AF_UNSPEC if unknown. Used as the preferred family
+ * of Anjay's sockets; the other family is still tried if it fails. Reads NVS
+ * synchronously.
+ */
+avs_net_af_t family_cache_get(const char *server_uri);
+
+/**
+ * Stores the family of the address @p socket is connected to as the one to
+ * prefer for @p server_uri. Meant to be called once the registration is up,
+ * so the preference is learned from Anjay's own connection, whatever the
+ * transport (UDP, DTLS, TCP or TLS), without any extra traffic. NVS is only
+ * written when the family changes.
+ */
+void family_cache_update(const char *server_uri, avs_net_socket_t *socket);
+
+#endif // FAMILY_CACHE_H
@@ -28,20 +28,18 @@
 #include <esp_partition.h>
 #include <esp_system.h>
 
+#include "event_loop.h"
 #include "firmware_update.h"
+#include "main.h"
 #include "sdkconfig.h"
-
-#if defined(CONFIG_ANJAY_CLIENT_CELLULAR_EVENT_LOOP) \
-        && !defined(CONFIG_ANJAY_WITH_EVENT_LOOP)
-#    include "cellular_anjay_impl/cellular_event_loop.h"
-#endif // defined(CONFIG_ANJAY_CLIENT_CELLULAR_EVENT_LOOP)
-       // && !defined(CONFIG_ANJAY_WITH_EVENT_LOOP)
+#include "storage.h"
 
 static struct {
     anjay_t *anjay;
     esp_ota_handle_t update_handle;
     const esp_partition_t *update_partition;
     atomic_bool update_requested;
+    bool downloading;
 } fw_state;
 
 static int fw_stream_open(void *user_ptr,
@@ -65,6 +63,8 @@ static int fw_stream_open(void *user_ptr,
         fw_state.update_partition = NULL;
         return -1;
     }
+    fw_state.downloading = true;
+    note_network_activity();
     return 0;
 }
 
@@ -88,6 +88,7 @@ static int fw_stream_finish(void *user_ptr) {
 
     assert(fw_state.update_partition);
 
+    fw_state.downloading = false;
     int result = esp_ota_end(fw_state.update_handle);
     if (result) {
         avs_log(fw_update, ERROR, "OTA end failed");
@@ -102,6 +103,7 @@ static int fw_stream_finish(void *user_ptr) {
 static void fw_reset(void *user_ptr) {
     (void) user_ptr;
 
+    fw_state.downloading = false;
     if (fw_state.update_partition) {
         esp_ota_abort(fw_state.update_handle);
         fw_state.update_partition = NULL;
@@ -119,20 +121,9 @@ static int fw_perform_upgrade(void *user_ptr) {
                        : -1;
     }
 
-#if defined(CONFIG_ANJAY_CLIENT_CELLULAR_EVENT_LOOP) \
-        && !defined(CONFIG_ANJAY_WITH_EVENT_LOOP)
-    if (cellular_event_loop_interrupt()) {
-        return -1;
-    }
-#elif defined(CONFIG_ANJAY_WITH_EVENT_LOOP) \
-        && !defined(CONFIG_ANJAY_CLIENT_CELLULAR_EVENT_LOOP)
-    if (anjay_event_loop_interrupt(fw_state.anjay)) {
+    if (event_loop_interrupt()) {
         return -1;
     }
-#else
-#    error "Exactly one Event Loop configuration should be enabled at a time: ANJAY_CLIENT_CELLULAR_EVENT_LOOP or ANJAY_WITH_EVENT_LOOP."
-#endif // defined(CONFIG_ANJAY_CLIENT_CELLULAR_EVENT_LOOP) &&
-       // !defined(CONFIG_ANJAY_WITH_EVENT_LOOP)
 
     atomic_store(&fw_state.update_requested, true);
     return 0;
@@ -170,7 +161,12 @@ bool fw_update_requested(void) {
     return atomic_load(&fw_state.update_requested);
 }
 
+bool fw_update_download_in_progress(void) {
+    return fw_state.downloading;
+}
+
 void fw_update_reboot(void) {
     avs_log(fw_update, INFO, "Rebooting to perform a firmware upgrade...");
+    storage_flush();
     esp_restart();
 }
@@ -23,6 +23,12 @@
 
 int fw_update_install(anjay_t *anjay);
 bool fw_update_requested(void);
+
+/**
+ * Returns true between the start of a package download and its completion or
+ * abort.
+ */
+bool fw_update_download_in_progress(void);
 void fw_update_reboot(void);
 
 #endif // FIRMWARE_UPDATE_H
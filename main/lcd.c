@@ -51,9 +51,15 @@
 #include <esp_log.h>
 #include <esp_spiffs.h>
 
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
 #include "bmpfile.h"
 #include "fontx.h"
 #include "lcd.h"
+#include "lf_queue.h"
+#include "task_stats.h"
+#include "task_topology.h"
 
 #ifdef CONFIG_ANJAY_CLIENT_LCD
 
@@ -76,6 +82,7 @@
 #    endif /* CONFIG_ANJAY_CLIENT_BOARD_M5STICKC_PLUS */
 
 #    define BUFFPIXEL 20
+#    define DISPLAY_QUEUE_CAPACITY 4
 
 static TFT_t dev;
 static FontxFile fx16G[2];
@@ -87,6 +94,11 @@ static FontxFile fx32M[2];
 
 static bool spiffs_opened_properly = false;
 
+#    ifdef CONFIG_ANJAY_CLIENT_WORKER_TASKS
+static lf_queue_t status_queue;
+static TaskHandle_t display_task_handle;
+#    endif // CONFIG_ANJAY_CLIENT_WORKER_TASKS
+
 static const char *connection_status_texts[] = {
     [LCD_CONNECTION_STATUS_DISCONNECTED] = "disconnected",
     [LCD_CONNECTION_STATUS_CONNECTION_ERROR] = "connection error",
@@ -125,7 +137,7 @@ static void writeText(TFT_t *dev, FontxFile *fx, const char *text, int y) {
     }
 }
 
-void lcd_write_connection_status(lcd_connection_status_t status) {
+static void draw_connection_status(lcd_connection_status_t status) {
     static lcd_connection_status_t status_prev =
             LCD_CONNECTION_STATUS_DISCONNECTED;
     if (status != status_prev) {
@@ -143,6 +155,57 @@ void lcd_write_connection_status(lcd_connection_status_t status) {
     }
 }
 
+#    ifdef CONFIG_ANJAY_CLIENT_WORKER_TASKS
+static void display_task(void *pvParameters) {
+    (void) pvParameters;
+
+    lcd_connection_status_t status;
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        while (!lf_queue_pop(&status_queue, &status)) {
+            draw_connection_status(status);
+        }
+    }
+}
+
+static void start_display_task(void) {
+    if (lf_queue_init(&status_queue, "display", DISPLAY_QUEUE_CAPACITY,
+                      sizeof(lcd_connection_status_t))) {
+        ESP_LOGW(__FUNCTION__, "Could not allocate display queue");
+        return;
+    }
+    if (xTaskCreatePinnedToCore(display_task, "display_task",
+                                DISPLAY_TASK_STACK_SIZE, NULL,
+                                DISPLAY_TASK_PRIORITY, &display_task_handle,
+                                WORKER_TASK_CORE_ID)
+            != pdPASS) {
+        ESP_LOGW(__FUNCTION__, "Could not create display task");
+        display_task_handle = NULL;
+        lf_queue_release(&status_queue);
+        return;
+    }
+    task_stats_register_queue(&status_queue);
+}
+
+void lcd_write_connection_status(lcd_connection_status_t status) {
+    // Called once per second with mostly the same value, so only changes
+    // are handed over to the display task
+    static lcd_connection_status_t posted_prev = LCD_CONNECTION_STATUS_END_;
+
+    if (!display_task_handle) {
+        draw_connection_status(status);
+    } else if (status != posted_prev
+               && !lf_queue_push(&status_queue, &status)) {
+        posted_prev = status;
+        xTaskNotifyGive(display_task_handle);
+    }
+}
+#    else  // CONFIG_ANJAY_CLIENT_WORKER_TASKS
+void lcd_write_connection_status(lcd_connection_status_t status) {
+    draw_connection_status(status);
+}
+#    endif // CONFIG_ANJAY_CLIENT_WORKER_TASKS
+
 static void draw_bmp_file(TFT_t *dev, char *file, int width, int height) {
     lcdFillScreen(dev, BLACK);
 
@@ -297,7 +360,10 @@ void lcd_init(void) {
             writeText(&dev, fx16G, "LwM2M Client", LWM2M_CLIENT_TEXT_POSITION);
             writeText(&dev, fx16G,
                       "connection status:", CONNECTION_STATUS_TEXT_POSITION);
-            lcd_write_connection_status(LCD_CONNECTION_STATUS_DISCONNECTED);
+            draw_connection_status(LCD_CONNECTION_STATUS_DISCONNECTED);
+#    ifdef CONFIG_ANJAY_CLIENT_WORKER_TASKS
+            start_display_task();
+#    endif // CONFIG_ANJAY_CLIENT_WORKER_TASKS
         }
     }
 }
@@ -0,0 +1,143 @@
+/*
+ * Copyright 2021-2025 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <avsystem/commons/avs_memory.h>
+
+#include "lf_queue.h"
+
+int lf_queue_init(lf_queue_t *queue,
+                  const char *name,
+                  size_t capacity,
+                  size_t elem_size) {
+    if (capacity < 2 || (capacity & (capacity - 1)) || !elem_size) {
+        return -1;
+    }
+
+    memset(queue, 0, sizeof(*queue));
+    queue->sequences =
+            (atomic_size_t *) avs_calloc(capacity, sizeof(atomic_size_t));
+    queue->data = (uint8_t *) avs_calloc(capacity, elem_size);
+    if (!queue->sequences || !queue->data) {
+        lf_queue_release(queue);
+        return -1;
+    }
+
+    queue->name = name;
+    queue->elem_size = elem_size;
+    queue->mask = capacity - 1;
+    for (size_t i = 0; i < capacity; i++) {
+        atomic_init(&queue->sequences[i], i);
+    }
+    atomic_init(&queue->enqueue_pos, 0);
+    atomic_init(&queue->dequeue_pos, 0);
+    atomic_init(&queue->high_watermark, 0);
+    atomic_init(&queue->dropped, 0);
+    return 0;
+}
+
+void lf_queue_release(lf_queue_t *queue) {
+    avs_free(queue->sequences);
+    avs_free(queue->data);
+    queue->sequences = NULL;
+    queue->data = NULL;
+}
+
+static void update_high_watermark(lf_queue_t *queue) {
+    size_t depth = lf_queue_depth(queue);
+    size_t watermark = atomic_load_explicit(&queue->high_watermark,
+                                            memory_order_relaxed);
+    while (depth > watermark
+           && !atomic_compare_exchange_weak_explicit(
+                   &queue->high_watermark, &watermark, depth,
+                   memory_order_relaxed, memory_order_relaxed)) {
+    }
+}
+
+int lf_queue_push(lf_queue_t *queue, const void *elem) {
+    size_t pos =
+            atomic_load_explicit(&queue->enqueue_pos, memory_order_relaxed);
+    for (;;) {
+        size_t seq = atomic_load_explicit(&queue->sequences[pos & queue->mask],
+                                          memory_order_acquire);
+        intptr_t diff = (intptr_t) seq - (intptr_t) pos;
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(
+                        &queue->enqueue_pos, &pos, pos + 1,
+                        memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            atomic_fetch_add_explicit(&queue->dropped, 1,
+                                      memory_order_relaxed);
+            return -1;
+        } else {
+            pos = atomic_load_explicit(&queue->enqueue_pos,
+                                       memory_order_relaxed);
+        }
+    }
+
+    memcpy(&queue->data[(pos & queue->mask) * queue->elem_size], elem,
+           queue->elem_size);
+    atomic_store_explicit(&queue->sequences[pos & queue->mask], pos + 1,
+                          memory_order_release);
+    update_high_watermark(queue);
+    return 0;
+}
+
+int lf_queue_pop(lf_queue_t *queue, void *out_elem) {
+    size_t pos =
+            atomic_load_explicit(&queue->dequeue_pos, memory_order_relaxed);
+    for (;;) {
+        size_t seq = atomic_load_explicit(&queue->sequences[pos & queue->mask],
+                                          memory_order_acquire);
+        intptr_t diff = (intptr_t) seq - (intptr_t) (pos + 1);
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(
+                        &queue->dequeue_pos, &pos, pos + 1,
+                        memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return -1;
+        } else {
+            pos = atomic_load_explicit(&queue->dequeue_pos,
+                                       memory_order_relaxed);
+        }
+    }
+
+    memcpy(out_elem, &queue->data[(pos & queue->mask) * queue->elem_size],
+           queue->elem_size);
+    atomic_store_explicit(&queue->sequences[pos & queue->mask],
+                          pos + queue->mask + 1, memory_order_release);
+    return 0;
+}
+
+size_t lf_queue_depth(const lf_queue_t *queue) {
+    size_t enqueue_pos = atomic_load_explicit(
+            (atomic_size_t *) &queue->enqueue_pos, memory_order_relaxed);
+    size_t dequeue_pos = atomic_load_explicit(
+            (atomic_size_t *) &queue->dequeue_pos, memory_order_relaxed);
+    return enqueue_pos - dequeue_pos;
+}
+
+size_t lf_queue_capacity(const lf_queue_t *queue) {
+    return queue->mask + 1;
+}
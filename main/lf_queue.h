@@ -0,0 +1,78 @@
+/*
+ * Copyright 2021-2025 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LF_QUEUE_H
+#define LF_QUEUE_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Bounded lock-free queue of fixed-size elements.
+ *
+ * Every cell carries a sequence number, so any number of producers may push
+ * concurrently while one consumer pops. Neither side ever blocks: push fails
+ * when the queue is full and pop fails when it is empty.
+ */
+typedef struct {
+    const char *name;
+    size_t elem_size;
+    size_t mask;
+    atomic_size_t *sequences;
+    uint8_t *data;
+    atomic_size_t enqueue_pos;
+    atomic_size_t dequeue_pos;
+    atomic_size_t high_watermark;
+    atomic_uint_fast32_t dropped;
+} lf_queue_t;
+
+/**
+ * Allocates storage for the queue.
+ *
+ * @param queue     Queue to initialize.
+ * @param name      Name used in statistics, must outlive the queue.
+ * @param capacity  Maximum number of elements, must be a power of two.
+ * @param elem_size Size of a single element in bytes.
+ *
+ * @returns 0 on success, -1 on invalid arguments or allocation failure.
+ */
+int lf_queue_init(lf_queue_t *queue,
+                  const char *name,
+                  size_t capacity,
+                  size_t elem_size);
+
+void lf_queue_release(lf_queue_t *queue);
+
+/**
+ * Copies @p elem into the queue. Safe to call from multiple tasks at once.
+ *
+ * @returns 0 on success, -1 if the queue is full (the drop is counted).
+ */
+int lf_queue_push(lf_queue_t *queue, const void *elem);
+
+/**
+ * Copies the oldest element into @p out_elem. Must be called from a single
+ * consumer task.
+ *
+ * @returns 0 on success, -1 if the queue is empty.
+ */
+int lf_queue_pop(lf_queue_t *queue, void *out_elem);
+
+size_t lf_queue_depth(const lf_queue_t *queue);
+size_t lf_queue_capacity(const lf_queue_t *queue);
+
+#endif // LF_QUEUE_H
@@ -14,13 +14,16 @@
  * limitations under the License.
  */
 
+#include <inttypes.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <string.h>
 
 #include <esp_event.h>
 #include <esp_log.h>
+#include <esp_mac.h>
 #include <esp_netif.h>
 #include <esp_wifi.h>
 #include <nvs_flash.h>
@@ -37,13 +40,30 @@
 #include <anjay/security.h>
 #include <anjay/server.h>
 
+#include "backoff.h"
+#include "config_store.h"
 #include "connect.h"
+#ifdef CONFIG_ANJAY_WIFI_CONNECT_STRESS_TEST
+#    include "connect_stress_test.h"
+#endif // CONFIG_ANJAY_WIFI_CONNECT_STRESS_TEST
 #include "default_config.h"
+#include "dtls_stats.h"
+#include "event_loop.h"
 #include "firmware_update.h"
+#ifdef CONFIG_ANJAY_WIFI_CONNECT_IPV6
+#    include "family_cache.h"
+#endif // CONFIG_ANJAY_WIFI_CONNECT_IPV6
 #include "lcd.h"
 #include "main.h"
 #include "objects/objects.h"
+#include "sched_stats.h"
 #include "sdkconfig.h"
+#include "storage.h"
+#include "task_stats.h"
+#include "task_topology.h"
+#ifdef CONFIG_ANJAY_WIFI_ROAMING
+#    include "wifi_roaming.h"
+#endif // CONFIG_ANJAY_WIFI_ROAMING
 
 #ifdef CONFIG_ANJAY_CLIENT_INTERFACE_BG96_MODULE
 #    include <cellular_common.h>
@@ -52,9 +72,11 @@
 
 #    include <cellular_api.h>
 
-#    include "cellular_anjay_impl/cellular_event_loop.h"
+#    include "cellular_anjay_impl/dns_cache.h"
+#    include "cellular_anjay_impl/modem_bringup.h"
 #    include "cellular_anjay_impl/net_impl.h"
-#    include "cellular_setup.h"
+#    include "cellular_anjay_impl/power_saving.h"
+#    include "cellular_anjay_impl/tls_offload.h"
 #endif // CONFIG_ANJAY_CLIENT_INTERFACE_BG96_MODULE
 
 #ifdef CONFIG_ANJAY_SECURITY_MODE_CERTIFICATES
@@ -64,9 +86,6 @@ extern const uint8_t CLIENT_CERT[] asm("_binary_client_cert_der_start");
 extern const uint32_t CLIENT_CERT_LEN asm("client_cert_der_length");
 extern const uint8_t SERVER_CERT[] asm("_binary_server_cert_der_start");
 extern const uint32_t SERVER_CERT_LEN asm("server_cert_der_length");
-#else
-static char PSK[ANJAY_MAX_SECRET_KEY_SIZE];
-static char IDENTITY[ANJAY_MAX_PK_OR_IDENTITY_SIZE];
 #endif // CONFIG_ANJAY_SECURITY_MODE_CERTIFICATES
 
 #ifdef CONFIG_ANJAY_CLIENT_SOCKET_TCP
@@ -75,90 +94,348 @@ static char IDENTITY[ANJAY_MAX_PK_OR_IDENTITY_SIZE];
 #    define MAIN_PREFERRED_TRANSPORT "U"
 #endif // CONFIG_ANJAY_CLIENT_TCP_SOCKET
 
-static char SERVER_URI[ANJAY_MAX_PK_OR_IDENTITY_SIZE];
-static char ENDPOINT_NAME[ANJAY_MAX_PK_OR_IDENTITY_SIZE];
+#ifdef CONFIG_ANJAY_CLIENT_QUEUE_MODE
+#    define MAIN_QUEUE_MODE_BINDING "Q"
+#else
+#    define MAIN_QUEUE_MODE_BINDING ""
+#endif // CONFIG_ANJAY_CLIENT_QUEUE_MODE
+
+static config_store_client_t client_config;
 
 static const anjay_dm_object_def_t **DEVICE_OBJ;
 static const anjay_dm_object_def_t **PUSH_BUTTON_OBJ;
 static const anjay_dm_object_def_t **LIGHT_CONTROL_OBJ;
+static const anjay_dm_object_def_t **SCHEDULER_STATS_OBJ;
+#ifdef CONFIG_ANJAY_CLIENT_INTERFACE_BG96_MODULE
+static const anjay_dm_object_def_t **CELLULAR_CONNECTIVITY_OBJ;
+static const anjay_dm_object_def_t **CONNECTIVITY_STATISTICS_OBJ;
+#endif // CONFIG_ANJAY_CLIENT_INTERFACE_BG96_MODULE
+static const anjay_dm_object_def_t **CONNECTIVITY_MONITORING_OBJ;
 #ifdef CONFIG_ANJAY_CLIENT_INTERFACE_ONBOARD_WIFI
 static const anjay_dm_object_def_t **WLAN_OBJ;
 #endif // CONFIG_ANJAY_CLIENT_INTERFACE_ONBOARD_WIFI
 
 static anjay_t *anjay;
+static anjay_iid_t server_instance_id = ANJAY_ID_INVALID;
 static avs_sched_handle_t sensors_job_handle;
 static avs_sched_handle_t connection_status_job_handle;
+static avs_sched_handle_t stats_job_handle;
+#if defined(CONFIG_ANJAY_CLIENT_INTERFACE_BG96_MODULE) \
+        && defined(CONFIG_ANJAY_CLIENT_CELLULAR_POWER_SAVING)
+static avs_sched_handle_t psm_wakeup_job_handle;
+#endif // defined(CONFIG_ANJAY_CLIENT_INTERFACE_BG96_MODULE) &&
+       // defined(CONFIG_ANJAY_CLIENT_CELLULAR_POWER_SAVING)
 #ifdef CONFIG_ANJAY_CLIENT_INTERFACE_ONBOARD_WIFI
 static avs_sched_handle_t change_config_job_handle;
+#    ifndef CONFIG_ANJAY_WIFI_POWER_SAVE_NONE
+static avs_sched_handle_t wifi_power_save_job_handle;
+#    endif // CONFIG_ANJAY_WIFI_POWER_SAVE_NONE
+#    ifdef CONFIG_ANJAY_WIFI_ROAMING
+static avs_sched_handle_t wifi_roaming_job_handle;
+#    endif // CONFIG_ANJAY_WIFI_ROAMING
 #endif // CONFIG_ANJAY_CLIENT_INTERFACE_ONBOARD_WIFI
 
 static int read_anjay_config();
 #ifdef CONFIG_ANJAY_CLIENT_INTERFACE_ONBOARD_WIFI
 static void change_config_job(avs_sched_t *sched, const void *args_ptr);
 
+// A single Write may request a reconfiguration several times, and servers
+// often set SSID and password in separate requests, so the requests are
+// collected for a while and handled by one job
+#    define WIFI_RECONFIG_DEBOUNCE_MS 500
+
 void schedule_change_config() {
-    AVS_SCHED_NOW(anjay_get_scheduler(anjay), &change_config_job_handle,
-                  change_config_job, NULL, 0);
+    if (change_config_job_handle) {
+        return;
+    }
+    SCHED_STATS_DELAYED(anjay_get_scheduler(anjay), &change_config_job_handle,
+                        avs_time_duration_from_scalar(WIFI_RECONFIG_DEBOUNCE_MS,
+                                                      AVS_TIME_MS),
+                        change_config_job, NULL, 0);
+}
+
+/**
+ * Progress of the reconfiguration started by change_config_job. Connection
+ * attempts run in the background and their results are delivered to
+ * wifi_connect_result_job, so the scheduler keeps running in the meantime.
+ */
+typedef enum {
+    WIFI_RECONFIG_IDLE,
+    WIFI_RECONFIG_CONNECTING_WRITABLE,
+    WIFI_RECONFIG_CONNECTING_PRECONFIGURED,
+    WIFI_RECONFIG_ROAMING
+} wifi_reconfig_state_t;
+
+typedef struct {
+    uint32_t attempt;
+    esp_err_t result;
+} wifi_connect_result_args_t;
+
+static wifi_reconfig_state_t wifi_reconfig_state;
+static uint32_t wifi_reconfig_attempt;
+// Configuration passed to the last connection attempt
+static wifi_config_t wifi_applied_config;
+#    ifdef CONFIG_ANJAY_WIFI_ROAMING
+// Access point the station is roaming to; after a successful roam the
+// station stays bound to it until the next reconfiguration
+static uint8_t wifi_roaming_bssid[6];
+static bool wifi_roaming_pinned;
+#    endif // CONFIG_ANJAY_WIFI_ROAMING
+
+static void wifi_connect_result_job(avs_sched_t *sched, const void *args_ptr);
+
+// Called from the default event loop task
+static void on_wifi_connect_result(esp_err_t result, void *attempt) {
+    const wifi_connect_result_args_t args = {
+        .attempt = (uint32_t) (uintptr_t) attempt,
+        .result = result
+    };
+    // sched_stats bookkeeping is not thread-safe, so the plain scheduler
+    // API is used to pass the result to the Anjay task
+    AVS_SCHED_NOW(anjay_get_scheduler(anjay), NULL, wifi_connect_result_job,
+                  &args, sizeof(args));
 }
 
-static int connect_to_instance(wifi_instance_t iid) {
+static void connect_with_config(const wifi_config_t *wifi_config,
+                                wifi_reconfig_state_t state) {
+    wifi_reconfig_state = state;
+    wifi_applied_config = *wifi_config;
+    wifi_connect_async(wifi_config, on_wifi_connect_result,
+                       (void *) (uintptr_t) ++wifi_reconfig_attempt);
+}
+
+static void connect_to_instance(wifi_instance_t iid,
+                                wifi_reconfig_state_t state) {
     wifi_config_t wifi_config =
             wlan_object_get_instance_wifi_config(WLAN_OBJ, iid);
-    return wifi_connect(&wifi_config);
+    connect_with_config(&wifi_config, state);
 }
 
-// Reconfigure wifi due to enable resource value change
-static void change_config_job(avs_sched_t *sched, const void *args_ptr) {
-    bool preconf_inst_enable = false, writable_inst_enable = false;
+// Roaming pins the station to an access point, which makes its configuration
+// differ from any instance
+static bool is_same_wifi_config(const wifi_config_t *a,
+                                const wifi_config_t *b) {
+    return !strncmp((const char *) a->sta.ssid, (const char *) b->sta.ssid,
+                    sizeof(a->sta.ssid))
+           && !strncmp((const char *) a->sta.password,
+                       (const char *) b->sta.password,
+                       sizeof(a->sta.password))
+           && a->sta.bssid_set == b->sta.bssid_set;
+}
 
-    wifi_disconnect();
+// Reconfigure wifi due to changes of the WLAN object, which holds the desired
+// state accumulated since the job was scheduled
+static void change_config_job(avs_sched_t *sched, const void *args_ptr) {
+    wifi_instance_t iid = ANJAY_WIFI_OBJ_PRECONFIGURED_INSTANCE;
+    wifi_reconfig_state_t state = WIFI_RECONFIG_CONNECTING_PRECONFIGURED;
     if (wlan_object_is_instance_enabled(WLAN_OBJ,
                                         ANJAY_WIFI_OBJ_WRITABLE_INSTANCE)) {
+        iid = ANJAY_WIFI_OBJ_WRITABLE_INSTANCE;
+        state = WIFI_RECONFIG_CONNECTING_WRITABLE;
+    }
+    wifi_config_t wifi_config =
+            wlan_object_get_instance_wifi_config(WLAN_OBJ, iid);
+    if (is_same_wifi_config(&wifi_config, &wifi_applied_config)) {
+        avs_log(tutorial, DEBUG,
+                "Effective wifi configuration unchanged, not reconnecting");
+        return;
+    }
+
+#    ifdef CONFIG_ANJAY_WIFI_ROAMING
+    wifi_roaming_pinned = false;
+#    endif // CONFIG_ANJAY_WIFI_ROAMING
+    wifi_disconnect();
+    if (iid == ANJAY_WIFI_OBJ_WRITABLE_INSTANCE) {
         avs_log(tutorial, INFO,
                 "Trying to connect to wifi with configuration from server...");
-        if (connect_to_instance(ANJAY_WIFI_OBJ_WRITABLE_INSTANCE)) {
+    } else {
+        avs_log(tutorial, INFO,
+                "Trying to connect to wifi with configuration from NVS...");
+    }
+    connect_with_config(&wifi_config, state);
+}
+
+static void wifi_connect_result_job(avs_sched_t *sched, const void *args_ptr) {
+    const wifi_connect_result_args_t *args =
+            (const wifi_connect_result_args_t *) args_ptr;
+    if (args->attempt != wifi_reconfig_attempt) {
+        // superseded by a newer reconfiguration
+        return;
+    }
+
+    wifi_instance_t selected_instance = ANJAY_WIFI_OBJ_PRECONFIGURED_INSTANCE;
+
+    switch (wifi_reconfig_state) {
+    case WIFI_RECONFIG_CONNECTING_WRITABLE:
+        if (args->result != ESP_OK) {
             avs_log(tutorial, INFO,
                     "connection unsuccessful, trying to connect to wifi with "
                     "configuration from NVS");
-            connect_to_instance(ANJAY_WIFI_OBJ_PRECONFIGURED_INSTANCE);
             wlan_object_set_writable_iface_failed(anjay, WLAN_OBJ, true);
-            preconf_inst_enable = true;
-        } else {
-            avs_log(tutorial, INFO, "connection successful");
-            wlan_object_set_writable_iface_failed(anjay, WLAN_OBJ, false);
-            writable_inst_enable = true;
+            connect_to_instance(ANJAY_WIFI_OBJ_PRECONFIGURED_INSTANCE,
+                                WIFI_RECONFIG_CONNECTING_PRECONFIGURED);
+            return;
         }
-    } else {
-        avs_log(tutorial, INFO,
-                "Trying to connect to wifi with configuration from NVS...");
-        if (!connect_to_instance(ANJAY_WIFI_OBJ_PRECONFIGURED_INSTANCE)) {
+        avs_log(tutorial, INFO, "connection successful");
+        wlan_object_set_writable_iface_failed(anjay, WLAN_OBJ, false);
+        selected_instance = ANJAY_WIFI_OBJ_WRITABLE_INSTANCE;
+        break;
+
+    case WIFI_RECONFIG_CONNECTING_PRECONFIGURED:
+        if (args->result == ESP_OK) {
             avs_log(tutorial, INFO, "connection successful");
+        } else {
+            avs_log(tutorial, WARNING,
+                    "connection unsuccessful, retrying in the background");
+        }
+        break;
+
+#    ifdef CONFIG_ANJAY_WIFI_ROAMING
+    case WIFI_RECONFIG_ROAMING:
+        wifi_reconfig_state = WIFI_RECONFIG_IDLE;
+        wifi_roaming_record_result(wifi_roaming_bssid,
+                                   args->result == ESP_OK);
+        if (args->result != ESP_OK) {
+            avs_log(tutorial, WARNING,
+                    "roaming unsuccessful, reconnecting to the configured "
+                    "network");
+            schedule_change_config();
+            return;
         }
-        preconf_inst_enable = true;
+        avs_log(tutorial, INFO, "roaming successful");
+        wifi_roaming_pinned = true;
+        anjay_transport_schedule_reconnect(anjay, ANJAY_TRANSPORT_SET_IP);
+        return;
+#    endif // CONFIG_ANJAY_WIFI_ROAMING
+
+    default:
+        return;
     }
+    wifi_reconfig_state = WIFI_RECONFIG_IDLE;
 
-    wlan_object_set_instance_enable(anjay, WLAN_OBJ,
-                                    ANJAY_WIFI_OBJ_PRECONFIGURED_INSTANCE,
-                                    preconf_inst_enable);
-    wlan_object_set_instance_enable(anjay, WLAN_OBJ,
-                                    ANJAY_WIFI_OBJ_WRITABLE_INSTANCE,
-                                    writable_inst_enable);
+    wlan_object_select_instance(anjay, WLAN_OBJ, selected_instance);
 
     anjay_transport_schedule_reconnect(anjay, ANJAY_TRANSPORT_SET_IP);
 }
+
+#    ifdef CONFIG_ANJAY_WIFI_ROAMING
+// Consecutive failed reconnections to the access point the station has roamed
+// to, after which the regular configuration is restored
+#        define WIFI_ROAMING_MAX_PINNED_FAILURES 3
+
+static bool is_roaming_target(const char *ssid, void *out_iid_ptr) {
+    size_t count = wlan_object_instance_count(WLAN_OBJ);
+    for (anjay_iid_t iid = 0; iid < count; iid++) {
+        wifi_config_t config = wlan_object_get_instance_wifi_config(WLAN_OBJ,
+                                                                    iid);
+        if (config.sta.ssid[0]
+                && wlan_object_is_instance_enabled(WLAN_OBJ, iid)
+                && !strncmp(ssid, (const char *) config.sta.ssid,
+                            sizeof(config.sta.ssid))) {
+            if (out_iid_ptr) {
+                *(anjay_iid_t *) out_iid_ptr = iid;
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+static void roam_to(const wifi_roaming_candidate_t *candidate) {
+    anjay_iid_t iid;
+    if (!is_roaming_target(candidate->ssid, &iid)) {
+        return;
+    }
+    wifi_config_t wifi_config =
+            wlan_object_get_instance_wifi_config(WLAN_OBJ, iid);
+    wifi_config.sta.scan_method = WIFI_FAST_SCAN;
+    wifi_config.sta.bssid_set = true;
+    memcpy(wifi_config.sta.bssid, candidate->bssid,
+           sizeof(wifi_config.sta.bssid));
+    wifi_config.sta.channel = candidate->channel;
+    memcpy(wifi_roaming_bssid, candidate->bssid, sizeof(wifi_roaming_bssid));
+
+    avs_log(tutorial, INFO,
+            "Roaming to %s (" MACSTR ", channel %u, RSSI %d)", candidate->ssid,
+            MAC2STR(candidate->bssid), candidate->channel, candidate->rssi);
+    connect_with_config(&wifi_config, WIFI_RECONFIG_ROAMING);
+}
+
+static void wifi_roaming_evaluate_job(avs_sched_t *sched,
+                                      const void *args_ptr) {
+    (void) sched;
+    (void) args_ptr;
+
+    wifi_roaming_rank(is_roaming_target, NULL);
+    wlan_object_scan_results_changed(anjay, WLAN_OBJ);
+
+    wifi_ap_record_t ap_info;
+    if (wifi_reconfig_state != WIFI_RECONFIG_IDLE
+            || esp_wifi_sta_get_ap_info(&ap_info) != ESP_OK
+            || ap_info.rssi >= CONFIG_ANJAY_WIFI_ROAMING_RSSI_THRESHOLD) {
+        return;
+    }
+
+    // Candidates are sorted, so the first one other than the current access
+    // point is the best alternative
+    const wifi_roaming_candidate_t *candidate;
+    for (size_t i = 0; (candidate = wifi_roaming_get_candidate(i)); i++) {
+        if (memcmp(candidate->bssid, ap_info.bssid, sizeof(ap_info.bssid))) {
+            break;
+        }
+    }
+    if (candidate
+            && candidate->score
+                           >= wifi_roaming_score(ap_info.bssid, ap_info.rssi)
+                                      + CONFIG_ANJAY_WIFI_ROAMING_HYSTERESIS) {
+        roam_to(candidate);
+    }
+}
+
+static void on_wifi_roaming_scan_done(void) {
+    // Called from the event loop task, hence not SCHED_STATS_NOW()
+    AVS_SCHED_NOW(anjay_get_scheduler(anjay), NULL, wifi_roaming_evaluate_job,
+                  NULL, 0);
+}
+
+static void wifi_roaming_job(avs_sched_t *sched, const void *args_ptr) {
+    (void) args_ptr;
+
+    if (wifi_roaming_pinned) {
+        wifi_reconnect_stats_t stats;
+        wifi_get_reconnect_stats(&stats);
+        if (stats.consecutive_failures >= WIFI_ROAMING_MAX_PINNED_FAILURES) {
+            avs_log(tutorial, WARNING,
+                    "Access point roamed to is unreachable, reconnecting to "
+                    "the configured network");
+            schedule_change_config();
+        }
+    }
+
+    wifi_ap_record_t ap_info;
+    bool connected = esp_wifi_sta_get_ap_info(&ap_info) == ESP_OK;
+    if (connected && wifi_reconfig_state == WIFI_RECONFIG_IDLE) {
+        wifi_roaming_scan_start();
+    }
+
+    bool weak = connected
+                && ap_info.rssi < CONFIG_ANJAY_WIFI_ROAMING_RSSI_THRESHOLD;
+    int interval_s = weak ? CONFIG_ANJAY_WIFI_ROAMING_SCAN_INTERVAL_WEAK
+                          : CONFIG_ANJAY_WIFI_ROAMING_SCAN_INTERVAL;
+    SCHED_STATS_DELAYED(sched, &wifi_roaming_job_handle,
+                        avs_time_duration_from_scalar(interval_s, AVS_TIME_S),
+                        wifi_roaming_job, NULL, 0);
+}
+#    endif // CONFIG_ANJAY_WIFI_ROAMING
 #endif // CONFIG_ANJAY_CLIENT_INTERFACE_ONBOARD_WIFI
 
 // Installs Security Object and adds and instance of it.
 // An instance of Security Object provides information needed to connect to
 // LwM2M server.
-static int setup_security_object(anjay_t *anjay) {
-    if (anjay_security_object_install(anjay)) {
-        return -1;
-    }
-
+static int add_security_instance(anjay_t *anjay) {
     anjay_security_instance_t security_instance = {
         .ssid = 1,
-        .server_uri = SERVER_URI,
+        .server_uri = client_config.server_uri,
 #if defined(CONFIG_ANJAY_SECURITY_MODE_CERTIFICATES)
         .security_mode = ANJAY_SECURITY_CERTIFICATE,
         .public_cert_or_psk_identity = CLIENT_CERT,
@@ -169,14 +446,21 @@ static int setup_security_object(anjay_t *anjay) {
         .server_public_key_size = SERVER_CERT_LEN
 #elif defined(CONFIG_ANJAY_SECURITY_MODE_PSK)
         .security_mode = ANJAY_SECURITY_PSK,
-        .public_cert_or_psk_identity = (const uint8_t *) IDENTITY,
-        .public_cert_or_psk_identity_size = strlen(IDENTITY),
-        .private_cert_or_psk_key = (const uint8_t *) PSK,
-        .private_cert_or_psk_key_size = strlen(PSK)
+        .public_cert_or_psk_identity =
+                (const uint8_t *) client_config.identity,
+        .public_cert_or_psk_identity_size = strlen(client_config.identity),
+        .private_cert_or_psk_key = (const uint8_t *) client_config.psk,
+        .private_cert_or_psk_key_size = strlen(client_config.psk)
 #else
         .security_mode = ANJAY_SECURITY_NOSEC
 #endif // CONFIG_ANJAY_SECURITY_MODE_CERTIFICATES
     };
+#ifdef CONFIG_ANJAY_CLIENT_BG96_TLS_OFFLOAD
+    if (tls_offload_enabled()) {
+        // Anjay sees a plain TCP connection, the modem wraps it in TLS
+        security_instance.security_mode = ANJAY_SECURITY_NOSEC;
+    }
+#endif // CONFIG_ANJAY_CLIENT_BG96_TLS_OFFLOAD
 
     // Anjay will assign Instance ID automatically
     anjay_iid_t security_instance_id = ANJAY_ID_INVALID;
@@ -188,6 +472,52 @@ static int setup_security_object(anjay_t *anjay) {
     return 0;
 }
 
+static int setup_security_object(anjay_t *anjay) {
+    if (anjay_security_object_install(anjay)) {
+        return -1;
+    }
+    return add_security_instance(anjay);
+}
+
+#ifdef CONFIG_ANJAY_CLIENT_BG96_TLS_OFFLOAD
+static void offload_tls(void) {
+    static const char SECURE_SCHEME[] = "coaps+tcp://";
+    static const char PLAIN_SCHEME[] = "coap+tcp://";
+    char *server_uri = client_config.server_uri;
+
+    if (!anjay) {
+        return;
+    }
+    if (strncmp(server_uri, SECURE_SCHEME, strlen(SECURE_SCHEME))) {
+        avs_log(tutorial, WARNING, "%s is not a coaps+tcp URI, not offloading",
+                server_uri);
+        return;
+    }
+    const tls_offload_credentials_t credentials = {
+        .server_cert = SERVER_CERT,
+        .server_cert_size = SERVER_CERT_LEN,
+        .client_cert = CLIENT_CERT,
+        .client_cert_size = CLIENT_CERT_LEN,
+        .client_key = CLIENT_PRIVATE_KEY,
+        .client_key_size = CLIENT_PRIVATE_KEY_LEN
+    };
+    if (tls_offload_provision(&credentials)) {
+        avs_log(tutorial, WARNING, "Falling back to on-chip TLS");
+        return;
+    }
+    memmove(server_uri + strlen(PLAIN_SCHEME),
+            server_uri + strlen(SECURE_SCHEME),
+            strlen(server_uri) - strlen(SECURE_SCHEME) + 1);
+    memcpy(server_uri, PLAIN_SCHEME, strlen(PLAIN_SCHEME));
+
+    // The Security object was populated before the modem was up
+    anjay_security_object_purge(anjay);
+    if (add_security_instance(anjay)) {
+        avs_log(tutorial, ERROR, "Could not update Security object");
+    }
+}
+#endif // CONFIG_ANJAY_CLIENT_BG96_TLS_OFFLOAD
+
 // Installs Server Object and adds and instance of it.
 // An instance of Server Object provides the data related to a LwM2M Server.
 static int setup_server_object(anjay_t *anjay) {
@@ -207,11 +537,10 @@ static int setup_server_object(anjay_t *anjay) {
         // Disable Disable Timeout resource
         .disable_timeout = -1,
         // Sets preferred transport
-        .binding = MAIN_PREFERRED_TRANSPORT
+        .binding = MAIN_PREFERRED_TRANSPORT MAIN_QUEUE_MODE_BINDING
     };
 
     // Anjay will assign Instance ID automatically
-    anjay_iid_t server_instance_id = ANJAY_ID_INVALID;
     if (anjay_server_object_add_instance(anjay, &server_instance,
                                          &server_instance_id)) {
         return -1;
@@ -220,16 +549,95 @@ static int setup_server_object(anjay_t *anjay) {
     return 0;
 }
 
+#ifdef CONFIG_ANJAY_CLIENT_INTERFACE_BG96_MODULE
+#    ifdef CONFIG_ANJAY_CLIENT_CELLULAR_POWER_SAVING
+// Without PSM_EINT, the modem can only be reached while it is awake for its
+// periodic TAU, so the Update is sent then rather than when Anjay schedules it
+static void psm_wakeup_job(avs_sched_t *sched, const void *anjay_ptr) {
+    anjay_t *anjay = *(anjay_t *const *) anjay_ptr;
+
+    power_saving_note_activity();
+    anjay_schedule_registration_update(anjay, ANJAY_SSID_ANY);
+}
+
+static void schedule_psm_wakeup(anjay_t *anjay) {
+    static avs_time_monotonic_t scheduled_wakeup;
+    avs_time_monotonic_t wakeup = power_saving_next_wakeup();
+
+    if (!avs_time_monotonic_valid(wakeup)) {
+        avs_sched_del(&psm_wakeup_job_handle);
+        return;
+    }
+    if (psm_wakeup_job_handle
+            && avs_time_monotonic_equal(wakeup, scheduled_wakeup)) {
+        return;
+    }
+    avs_sched_del(&psm_wakeup_job_handle);
+    scheduled_wakeup = wakeup;
+    SCHED_STATS_DELAYED(anjay_get_scheduler(anjay), &psm_wakeup_job_handle,
+                        avs_time_monotonic_diff(wakeup,
+                                                avs_time_monotonic_now()),
+                        psm_wakeup_job, &anjay, sizeof(anjay));
+}
+#    endif // CONFIG_ANJAY_CLIENT_CELLULAR_POWER_SAVING
+
+#    ifdef CONFIG_ANJAY_CLIENT_CELLULAR_POWER_SAVING
+// Failed attempts are retried with a backoff, as each one wakes the modem
+#        define POWER_SAVING_RETRY_MIN_DELAY_S 5
+#        define POWER_SAVING_RETRY_MAX_DELAY_S 600
+#    endif // CONFIG_ANJAY_CLIENT_CELLULAR_POWER_SAVING
+
+// Keeps modem power saving timers in line with the registration lifetime,
+// which may be changed by the server at any time
+static void update_power_saving(anjay_t *anjay) {
+#    ifdef CONFIG_ANJAY_CLIENT_CELLULAR_POWER_SAVING
+    static int64_t applied_lifetime = -1;
+    static avs_time_monotonic_t next_attempt;
+    static int64_t retry_delay_s = POWER_SAVING_RETRY_MIN_DELAY_S;
+    const anjay_uri_path_t lifetime_path =
+            ANJAY_MAKE_RESOURCE_PATH(1, server_instance_id, 1);
+    int64_t lifetime;
+
+    if (server_instance_id != ANJAY_ID_INVALID
+            && !anjay_dm_read_resource_i64(anjay, &lifetime_path, &lifetime)
+            && lifetime != applied_lifetime
+            && !avs_time_monotonic_before(avs_time_monotonic_now(),
+                                          next_attempt)) {
+        if (!power_saving_apply(lifetime)) {
+            applied_lifetime = lifetime;
+            retry_delay_s = POWER_SAVING_RETRY_MIN_DELAY_S;
+        } else {
+            next_attempt = avs_time_monotonic_add(
+                    avs_time_monotonic_now(),
+                    avs_time_duration_from_scalar(retry_delay_s, AVS_TIME_S));
+            retry_delay_s =
+                    AVS_MIN(retry_delay_s * 2, POWER_SAVING_RETRY_MAX_DELAY_S);
+        }
+    } else {
+        power_saving_refresh();
+    }
+    schedule_psm_wakeup(anjay);
+#    endif // CONFIG_ANJAY_CLIENT_CELLULAR_POWER_SAVING
+    cellular_connectivity_object_update(anjay, CELLULAR_CONNECTIVITY_OBJ);
+}
+#endif // CONFIG_ANJAY_CLIENT_INTERFACE_BG96_MODULE
+
 static void update_objects_job(avs_sched_t *sched, const void *anjay_ptr) {
     anjay_t *anjay = *(anjay_t *const *) anjay_ptr;
 
     device_object_update(anjay, DEVICE_OBJ);
     push_button_object_update(anjay, PUSH_BUTTON_OBJ);
     sensors_update(anjay);
+    scheduler_stats_object_update(anjay, SCHEDULER_STATS_OBJ);
+#ifdef CONFIG_ANJAY_CLIENT_INTERFACE_BG96_MODULE
+    update_power_saving(anjay);
+    connectivity_statistics_object_update(anjay, CONNECTIVITY_STATISTICS_OBJ);
+#endif // CONFIG_ANJAY_CLIENT_INTERFACE_BG96_MODULE
+    connectivity_monitoring_object_update(anjay, CONNECTIVITY_MONITORING_OBJ);
 
-    AVS_SCHED_DELAYED(sched, &sensors_job_handle,
-                      avs_time_duration_from_scalar(1, AVS_TIME_S),
-                      &update_objects_job, &anjay, sizeof(anjay));
+    SCHED_STATS_DELAYED(sched, &sensors_job_handle,
+                        avs_time_duration_from_scalar(1, AVS_TIME_S),
+                        update_objects_job, &anjay, sizeof(anjay));
 }
 
 #ifdef CONFIG_ANJAY_CLIENT_LCD
@@ -246,6 +654,19 @@ static void check_and_write_connection_status(anjay_t *anjay) {
 }
 #endif // CONFIG_ANJAY_CLIENT_LCD
 
+#ifdef CONFIG_ANJAY_WIFI_CONNECT_IPV6
+// Remembers the family of the registered server connection, so that it is
+// tried first on the next start
+static void update_family_cache(anjay_t *anjay) {
+    AVS_LIST(const anjay_socket_entry_t) entry =
+            anjay_get_socket_entries(anjay);
+    if (entry && !anjay_ongoing_registration_exists(anjay)
+            && !anjay_all_connections_failed(anjay)) {
+        family_cache_update(client_config.server_uri, entry->socket);
+    }
+}
+#endif // CONFIG_ANJAY_WIFI_CONNECT_IPV6
+
 static void update_connection_status_job(avs_sched_t *sched,
                                          const void *anjay_ptr) {
     anjay_t *anjay = *(anjay_t *const *) anjay_ptr;
@@ -257,6 +678,28 @@ static void update_connection_status_job(avs_sched_t *sched,
     bool err;
 
 #if defined(CONFIG_ANJAY_CLIENT_INTERFACE_BG96_MODULE)
+    // Over UDP, a stale cached address only shows up as a failed DTLS
+    // handshake or registration. If the failed connection used a cached
+    // address, it is dropped and the connection retried once with a freshly
+    // resolved one; otherwise Anjay's own retry policy stands.
+    static bool connections_failed_prev;
+    bool connections_failed = anjay_all_connections_failed(anjay);
+    if (connections_failed && !connections_failed_prev
+            && !dns_cache_invalidate_last_hit()) {
+        anjay_transport_schedule_reconnect(anjay, ANJAY_TRANSPORT_SET_IP);
+    }
+    connections_failed_prev = connections_failed;
+
+    // The modem does not answer AT commands in PSM, which is not a loss of
+    // connectivity; the registration state is checked again after wakeup
+    if (power_saving_modem_may_sleep()) {
+        SCHED_STATS_DELAYED(sched, &connection_status_job_handle,
+                            avs_time_duration_from_scalar(1, AVS_TIME_S),
+                            update_connection_status_job, &anjay,
+                            sizeof(anjay));
+        return;
+    }
+
     CellularServiceStatus_t service_status = { 0 };
     err = (bool) Cellular_GetServiceStatus(CellularHandle, &service_status);
 
@@ -273,32 +716,131 @@ static void update_connection_status_job(avs_sched_t *sched,
 #elif defined(CONFIG_ANJAY_CLIENT_INTERFACE_ONBOARD_WIFI)
     wifi_ap_record_t ap_info;
     err = (bool) esp_wifi_sta_get_ap_info(&ap_info);
+    // Anjay does not report registration starts, e.g. lifetime-driven Updates
+    if (anjay_ongoing_registration_exists(anjay)) {
+        note_network_activity();
+    }
+#    ifdef CONFIG_ANJAY_WIFI_CONNECT_IPV6
+    update_family_cache(anjay);
+#    endif // CONFIG_ANJAY_WIFI_CONNECT_IPV6
 #endif // CONFIG_ANJAY_CLIENT_INTERFACE_BG96_MODULE
 
     if (connected_prev && err) {
         connected_prev = false;
         anjay_transport_enter_offline(anjay, ANJAY_TRANSPORT_SET_IP);
     } else if (!connected_prev && !err) {
+        note_network_activity();
         anjay_transport_exit_offline(anjay, ANJAY_TRANSPORT_SET_IP);
         connected_prev = true;
     }
 
-    AVS_SCHED_DELAYED(sched, &connection_status_job_handle,
-                      avs_time_duration_from_scalar(1, AVS_TIME_S),
-                      update_connection_status_job, &anjay, sizeof(anjay));
+    SCHED_STATS_DELAYED(sched, &connection_status_job_handle,
+                        avs_time_duration_from_scalar(1, AVS_TIME_S),
+                        update_connection_status_job, &anjay, sizeof(anjay));
+}
+
+#if defined(CONFIG_ANJAY_CLIENT_INTERFACE_ONBOARD_WIFI) \
+        && !defined(CONFIG_ANJAY_WIFI_POWER_SAVE_NONE)
+static avs_time_monotonic_t wifi_last_activity;
+
+// Ends the low-latency window, unless there was activity in the meantime or
+// an exchange that is not visible on the serve path is still in progress
+static void wifi_power_save_job(avs_sched_t *sched, const void *anjay_ptr) {
+    anjay_t *anjay = *(anjay_t *const *) anjay_ptr;
+    avs_time_monotonic_t now = avs_time_monotonic_now();
+
+    if (anjay_ongoing_registration_exists(anjay)
+            || fw_update_download_in_progress()) {
+        wifi_last_activity = now;
+    }
+    avs_time_duration_t remaining = avs_time_monotonic_diff(
+            avs_time_monotonic_add(
+                    wifi_last_activity,
+                    avs_time_duration_from_scalar(
+                            CONFIG_ANJAY_WIFI_POWER_SAVE_LINGER, AVS_TIME_MS)),
+            now);
+    if (avs_time_duration_less(AVS_TIME_DURATION_ZERO, remaining)) {
+        SCHED_STATS_DELAYED(sched, &wifi_power_save_job_handle, remaining,
+                            wifi_power_save_job, &anjay, sizeof(anjay));
+        return;
+    }
+    wifi_power_save_set_low_latency(false);
+}
+#endif // defined(CONFIG_ANJAY_CLIENT_INTERFACE_ONBOARD_WIFI) &&
+       // !defined(CONFIG_ANJAY_WIFI_POWER_SAVE_NONE)
+
+// Keeps the radio awake while an exchange is likely in progress, so that
+// responses are not held by the access point until the next wakeup
+void note_network_activity(void) {
+#if defined(CONFIG_ANJAY_CLIENT_INTERFACE_ONBOARD_WIFI) \
+        && !defined(CONFIG_ANJAY_WIFI_POWER_SAVE_NONE)
+    wifi_last_activity = avs_time_monotonic_now();
+    wifi_power_save_set_low_latency(true);
+    if (!wifi_power_save_job_handle) {
+        SCHED_STATS_DELAYED(anjay_get_scheduler(anjay),
+                            &wifi_power_save_job_handle,
+                            avs_time_duration_from_scalar(
+                                    CONFIG_ANJAY_WIFI_POWER_SAVE_LINGER,
+                                    AVS_TIME_MS),
+                            wifi_power_save_job, &anjay, sizeof(anjay));
+    }
+#endif // defined(CONFIG_ANJAY_CLIENT_INTERFACE_ONBOARD_WIFI) &&
+       // !defined(CONFIG_ANJAY_WIFI_POWER_SAVE_NONE)
+}
+
+static void log_stats_job(avs_sched_t *sched, const void *args_ptr) {
+    (void) args_ptr;
+
+    task_stats_log();
+    sched_stats_log();
+    event_loop_log_stats();
+    dtls_stats_log();
+#ifdef CONFIG_ANJAY_CLIENT_INTERFACE_ONBOARD_WIFI
+    wifi_log_reconnect_stats();
+    wifi_log_power_save_stats();
+#    ifdef CONFIG_ANJAY_WIFI_ROAMING
+    wifi_roaming_log_stats();
+#    endif // CONFIG_ANJAY_WIFI_ROAMING
+#endif // CONFIG_ANJAY_CLIENT_INTERFACE_ONBOARD_WIFI
+
+    SCHED_STATS_DELAYED(sched, &stats_job_handle,
+                        avs_time_duration_from_scalar(
+                                CONFIG_ANJAY_CLIENT_STATS_LOG_INTERVAL,
+                                AVS_TIME_S),
+                        log_stats_job, NULL, 0);
 }
 
 static void anjay_init(void) {
+    // Read necessary data for object install
+    read_anjay_config();
+
+#ifdef CONFIG_ANJAY_WIFI_CONNECT_IPV6
+    // Only a preference: the other family is still tried if this one fails
+    const avs_net_af_t preferred_family =
+            family_cache_get(client_config.server_uri);
+#endif // CONFIG_ANJAY_WIFI_CONNECT_IPV6
     const anjay_configuration_t CONFIG = {
-        .endpoint_name = ENDPOINT_NAME,
+        .endpoint_name = client_config.endpoint_name,
         .in_buffer_size = 4000,
         .out_buffer_size = 4000,
-        .msg_cache_size = 4000
+        .msg_cache_size = 4000,
+#ifdef CONFIG_ANJAY_WIFI_CONNECT_IPV6
+        .udp_socket_config = {
+            .preferred_family = preferred_family
+        },
+#    ifdef CONFIG_ANJAY_CLIENT_SOCKET_TCP
+        .tcp_socket_config = {
+            .preferred_family = preferred_family
+        },
+#    endif // CONFIG_ANJAY_CLIENT_SOCKET_TCP
+#endif     // CONFIG_ANJAY_WIFI_CONNECT_IPV6
+#ifdef CONFIG_ANJAY_CLIENT_DTLS_CONNECTION_ID
+        // Lets the server keep the DTLS session when the client address
+        // changes (NAT rebinding, cellular reattach), avoiding a handshake
+        .use_connection_id = true
+#endif // CONFIG_ANJAY_CLIENT_DTLS_CONNECTION_ID
     };
 
-    // Read necessary data for object install
-    read_anjay_config();
-
     anjay = anjay_new(&CONFIG);
     if (!anjay) {
         avs_log(tutorial, ERROR, "Could not create Anjay object");
@@ -326,11 +868,31 @@ static void anjay_init(void) {
         anjay_register_object(anjay, PUSH_BUTTON_OBJ);
     }
 
+    if ((SCHEDULER_STATS_OBJ = scheduler_stats_object_create())) {
+        anjay_register_object(anjay, SCHEDULER_STATS_OBJ);
+    }
+
+#ifdef CONFIG_ANJAY_CLIENT_INTERFACE_BG96_MODULE
+    if ((CELLULAR_CONNECTIVITY_OBJ = cellular_connectivity_object_create())) {
+        anjay_register_object(anjay, CELLULAR_CONNECTIVITY_OBJ);
+    }
+    if ((CONNECTIVITY_STATISTICS_OBJ =
+                 connectivity_statistics_object_create())) {
+        anjay_register_object(anjay, CONNECTIVITY_STATISTICS_OBJ);
+    }
+#endif // CONFIG_ANJAY_CLIENT_INTERFACE_BG96_MODULE
+
 #ifdef CONFIG_ANJAY_CLIENT_INTERFACE_ONBOARD_WIFI
     if ((WLAN_OBJ = wlan_object_create())) {
         anjay_register_object(anjay, WLAN_OBJ);
     }
 #endif // CONFIG_ANJAY_CLIENT_INTERFACE_ONBOARD_WIFI
+
+    // Backed by the modem or the Wi-Fi status, depending on the interface
+    if ((CONNECTIVITY_MONITORING_OBJ =
+                 connectivity_monitoring_object_create())) {
+        anjay_register_object(anjay, CONNECTIVITY_MONITORING_OBJ);
+    }
 }
 
 static void anjay_task(void *pvParameters) {
@@ -338,19 +900,38 @@ static void anjay_task(void *pvParameters) {
 
     update_connection_status_job(anjay_get_scheduler(anjay), &anjay);
     update_objects_job(anjay_get_scheduler(anjay), &anjay);
+#if defined(CONFIG_ANJAY_CLIENT_INTERFACE_ONBOARD_WIFI) \
+        && defined(CONFIG_ANJAY_WIFI_ROAMING)
+    SCHED_STATS_DELAYED(anjay_get_scheduler(anjay), &wifi_roaming_job_handle,
+                        avs_time_duration_from_scalar(
+                                CONFIG_ANJAY_WIFI_ROAMING_SCAN_INTERVAL_WEAK,
+                                AVS_TIME_S),
+                        wifi_roaming_job, NULL, 0);
+#endif // defined(CONFIG_ANJAY_CLIENT_INTERFACE_ONBOARD_WIFI) &&
+       // defined(CONFIG_ANJAY_WIFI_ROAMING)
+    if (CONFIG_ANJAY_CLIENT_STATS_LOG_INTERVAL > 0) {
+        log_stats_job(anjay_get_scheduler(anjay), NULL);
+    }
 
-#if defined(CONFIG_ANJAY_CLIENT_CELLULAR_EVENT_LOOP) \
-        && !defined(CONFIG_ANJAY_WITH_EVENT_LOOP)
-    cellular_event_loop_run(anjay);
-#elif defined(CONFIG_ANJAY_WITH_EVENT_LOOP) \
-        && !defined(CONFIG_ANJAY_CLIENT_CELLULAR_EVENT_LOOP)
-    anjay_event_loop_run(anjay, avs_time_duration_from_scalar(1, AVS_TIME_S));
-#else
-#    error "Exactly one Event Loop configuration should be enabled at a time: ANJAY_CLIENT_CELLULAR_EVENT_LOOP or ANJAY_WITH_EVENT_LOOP."
-#endif // defined(CONFIG_ANJAY_CLIENT_CELLULAR_EVENT_LOOP) &&
-       // !defined(CONFIG_ANJAY_WITH_EVENT_LOOP)
+    event_loop_run(anjay, EVENT_LOOP_DEFAULT_BACKEND);
     avs_sched_del(&sensors_job_handle);
     avs_sched_del(&connection_status_job_handle);
+    avs_sched_del(&stats_job_handle);
+#if defined(CONFIG_ANJAY_CLIENT_INTERFACE_ONBOARD_WIFI) \
+        && !defined(CONFIG_ANJAY_WIFI_POWER_SAVE_NONE)
+    avs_sched_del(&wifi_power_save_job_handle);
+#endif // defined(CONFIG_ANJAY_CLIENT_INTERFACE_ONBOARD_WIFI) &&
+       // !defined(CONFIG_ANJAY_WIFI_POWER_SAVE_NONE)
+#if defined(CONFIG_ANJAY_CLIENT_INTERFACE_ONBOARD_WIFI) \
+        && defined(CONFIG_ANJAY_WIFI_ROAMING)
+    avs_sched_del(&wifi_roaming_job_handle);
+#endif // defined(CONFIG_ANJAY_CLIENT_INTERFACE_ONBOARD_WIFI) &&
+       // defined(CONFIG_ANJAY_WIFI_ROAMING)
+#if defined(CONFIG_ANJAY_CLIENT_INTERFACE_BG96_MODULE) \
+        && defined(CONFIG_ANJAY_CLIENT_CELLULAR_POWER_SAVING)
+    avs_sched_del(&psm_wakeup_job_handle);
+#endif // defined(CONFIG_ANJAY_CLIENT_INTERFACE_BG96_MODULE) &&
+       // defined(CONFIG_ANJAY_CLIENT_CELLULAR_POWER_SAVING)
     anjay_delete(anjay);
     sensors_release();
 
@@ -385,85 +966,53 @@ log_handler(avs_log_level_t level, const char *module, const char *msg) {
     ESP_LOG_LEVEL_LOCAL(esp_level, "anjay", "%s", msg);
 }
 
-static int read_nvs_anjay_config(void) {
-    nvs_handle_t nvs_h;
-
-    if (nvs_open(MAIN_NVS_CONFIG_NAMESPACE, NVS_READONLY, &nvs_h)) {
-        return -1;
-    }
-
-    int result = (nvs_get_str(nvs_h, "uri", SERVER_URI,
-                              &(size_t) { sizeof(SERVER_URI) })
-                  || nvs_get_str(nvs_h, "endpoint_name", ENDPOINT_NAME,
-                                 &(size_t) { sizeof(ENDPOINT_NAME) })
-#ifdef CONFIG_ANJAY_SECURITY_MODE_PSK
-                  || nvs_get_str(nvs_h, "psk", PSK, &(size_t) { sizeof(PSK) })
-                  || nvs_get_str(nvs_h, "identity", IDENTITY,
-                                 &(size_t) { sizeof(IDENTITY) })
-#endif // CONFIG_ANJAY_SECURITY_MODE_PSK
-                          )
-                         ? -1
-                         : 0;
-    nvs_close(nvs_h);
-
-    return result;
-}
-
 static int read_anjay_config(void) {
-    int err = 0;
-    avs_log(tutorial, INFO, "Opening Non-Volatile Storage (NVS) handle... ");
-    if (read_nvs_anjay_config()) {
+    if (config_store_load_client(&client_config)) {
         avs_log(tutorial, WARNING,
                 "Reading from NVS has failed, attempt with Kconfig");
-        snprintf(ENDPOINT_NAME, sizeof(ENDPOINT_NAME), "%s",
+        snprintf(client_config.endpoint_name,
+                 sizeof(client_config.endpoint_name), "%s",
                  CONFIG_ANJAY_CLIENT_ENDPOINT_NAME);
-        snprintf(SERVER_URI, sizeof(SERVER_URI), "%s",
-                 CONFIG_ANJAY_CLIENT_SERVER_URI);
+        snprintf(client_config.server_uri, sizeof(client_config.server_uri),
+                 "%s", CONFIG_ANJAY_CLIENT_SERVER_URI);
 #ifdef CONFIG_ANJAY_SECURITY_MODE_PSK
-        snprintf(PSK, sizeof(PSK), "%s", CONFIG_ANJAY_CLIENT_PSK_KEY);
-        snprintf(IDENTITY, sizeof(IDENTITY), "%s",
+        snprintf(client_config.psk, sizeof(client_config.psk), "%s",
+                 CONFIG_ANJAY_CLIENT_PSK_KEY);
+        snprintf(client_config.identity, sizeof(client_config.identity), "%s",
                  CONFIG_ANJAY_CLIENT_PSK_IDENTITY);
 #endif // CONFIG_ANJAY_SECURITY_MODE_PSK
-        err = -1;
+        return -1;
     }
-    return err;
+    return 0;
 }
 
 #ifdef CONFIG_ANJAY_CLIENT_INTERFACE_ONBOARD_WIFI
 static int read_nvs_wifi_config(const char *namespace,
                                 wifi_config_t *wifi_config,
                                 uint8_t *en) {
-    nvs_handle_t nvs_h;
-
-    if (nvs_open(namespace, NVS_READONLY, &nvs_h)) {
+    config_store_wifi_t record;
+    if (config_store_load_wifi(namespace, &record)) {
         return -1;
     }
-
-    int result =
-            (nvs_get_str(nvs_h, MAIN_NVS_WIFI_SSID_KEY,
-                         (char *) wifi_config->sta.ssid,
-                         &(size_t) { sizeof(wifi_config->sta.ssid) })
-             || nvs_get_str(nvs_h, MAIN_NVS_WIFI_PASSWORD_KEY,
-                            (char *) wifi_config->sta.password,
-                            &(size_t) { sizeof(wifi_config->sta.password) })
-             || nvs_get_u8(nvs_h, MAIN_NVS_ENABLE_KEY, en))
-                    ? -1
-                    : 0;
-    nvs_close(nvs_h);
-
-    return result;
+    memcpy(wifi_config->sta.ssid, record.ssid, sizeof(record.ssid));
+    memcpy(wifi_config->sta.password, record.password,
+           sizeof(record.password));
+    if (en) {
+        *en = record.enable;
+    }
+    return 0;
 }
 
 static int read_wifi_config(void) {
     wifi_config_t preconf_wifi_config = { 0 };
-    uint8_t preconf_en = 0;
     wifi_config_t writable_wifi_config = { 0 };
     uint8_t writable_en = 0;
     int err = 0;
 
-    avs_log(tutorial, INFO, "Opening Non-Volatile Storage (NVS) handle... ");
+    // The preconfigured instance is used whenever the writable one is not, so
+    // the Enable flag stored along with it is not needed
     if (read_nvs_wifi_config(MAIN_NVS_CONFIG_NAMESPACE, &preconf_wifi_config,
-                             &preconf_en)) {
+                             NULL)) {
         avs_log(tutorial, WARNING,
                 "Reading from NVS has failed, attempt with Kconfig");
 
@@ -477,9 +1026,6 @@ static int read_wifi_config(void) {
         err = -1;
     }
 
-    avs_log(tutorial, INFO,
-            "Opening Non-Volatile Storage (NVS) with wifi writable "
-            "configuration handle... ");
     if (read_nvs_wifi_config(MAIN_NVS_WRITABLE_WIFI_CONFIG_NAMESPACE,
                              &writable_wifi_config, &writable_en)) {
         avs_log(tutorial, WARNING, "Reading from NVS has failed");
@@ -495,12 +1041,29 @@ static int read_wifi_config(void) {
     wlan_object_set_instance_wifi_config(anjay, WLAN_OBJ,
                                          ANJAY_WIFI_OBJ_WRITABLE_INSTANCE,
                                          &writable_wifi_config);
-    wlan_object_set_instance_enable(anjay, WLAN_OBJ,
-                                    ANJAY_WIFI_OBJ_PRECONFIGURED_INSTANCE,
-                                    (bool) preconf_en);
-    wlan_object_set_instance_enable(anjay, WLAN_OBJ,
-                                    ANJAY_WIFI_OBJ_WRITABLE_INSTANCE,
-                                    (bool) writable_en);
+    wlan_object_select_instance(
+            anjay, WLAN_OBJ,
+            writable_en ? ANJAY_WIFI_OBJ_WRITABLE_INSTANCE
+                        : ANJAY_WIFI_OBJ_PRECONFIGURED_INSTANCE);
+
+    // Additional networks are optional, so their absence is not an error
+    size_t count = wlan_object_instance_count(WLAN_OBJ);
+    for (anjay_iid_t iid = ANJAY_WIFI_OBJ_ADDITIONAL_INSTANCE; iid < count;
+         iid++) {
+        char namespace[16];
+        wifi_config_t wifi_config = { 0 };
+        uint8_t en = 0;
+        snprintf(namespace, sizeof(namespace),
+                 MAIN_NVS_ADDITIONAL_WIFI_CONFIG_NAMESPACE_FMT,
+                 (unsigned) iid);
+        if (read_nvs_wifi_config(namespace, &wifi_config, &en)) {
+            continue;
+        }
+        wifi_config.sta.scan_method = WIFI_ALL_CHANNEL_SCAN;
+        wlan_object_set_instance_wifi_config(anjay, WLAN_OBJ, iid,
+                                             &wifi_config);
+        wlan_object_set_instance_enable(anjay, WLAN_OBJ, iid, (bool) en);
+    }
     return err;
 }
 
@@ -523,11 +1086,8 @@ static void set_wifi_config(wifi_config_t *wifi_config) {
             // preconfigured instance
             *wifi_config = wlan_object_get_instance_wifi_config(
                     WLAN_OBJ, ANJAY_WIFI_OBJ_PRECONFIGURED_INSTANCE);
-            wlan_object_set_instance_enable(
-                    anjay, WLAN_OBJ, ANJAY_WIFI_OBJ_PRECONFIGURED_INSTANCE,
-                    true);
-            wlan_object_set_instance_enable(
-                    anjay, WLAN_OBJ, ANJAY_WIFI_OBJ_WRITABLE_INSTANCE, false);
+            wlan_object_select_instance(
+                    anjay, WLAN_OBJ, ANJAY_WIFI_OBJ_PRECONFIGURED_INSTANCE);
             avs_log(tutorial, INFO,
                     "Using wifi configuration from preconfigured instance");
         } else {
@@ -548,6 +1108,7 @@ void app_main(void) {
     ESP_ERROR_CHECK(esp_netif_init());
     ESP_ERROR_CHECK(esp_event_loop_create_default());
     avs_log_set_handler(log_handler);
+    storage_init();
 
     avs_log_set_default_level(AVS_LOG_TRACE);
     anjay_init();
@@ -562,32 +1123,42 @@ void app_main(void) {
 #endif     // CONFIG_ANJAY_CLIENT_LCD
 
 #if defined(CONFIG_ANJAY_CLIENT_INTERFACE_BG96_MODULE)
-    while (!setupCellular()) {
-        avs_log(tutorial, WARNING, "Cellular setup has failed");
-        Cellular_Cleanup(CellularHandle);
-        vTaskDelay(pdMS_TO_TICKS(100));
-    }
+    modem_bringup_run();
+#    ifdef CONFIG_ANJAY_CLIENT_BG96_TLS_OFFLOAD
+    offload_tls();
+#    endif // CONFIG_ANJAY_CLIENT_BG96_TLS_OFFLOAD
 #elif defined(CONFIG_ANJAY_CLIENT_INTERFACE_ONBOARD_WIFI)
     wifi_initialize();
     read_wifi_config();
+#    ifdef CONFIG_ANJAY_WIFI_ROAMING
+    wifi_roaming_init(on_wifi_roaming_scan_done);
+#    endif // CONFIG_ANJAY_WIFI_ROAMING
 
     wifi_config_t wifi_config = { 0 };
     set_wifi_config(&wifi_config);
+#    ifdef CONFIG_ANJAY_WIFI_CONNECT_STRESS_TEST
+    connect_stress_test_run(&wifi_config);
+#    endif // CONFIG_ANJAY_WIFI_CONNECT_STRESS_TEST
 
     if (wifi_connect(&wifi_config)) {
         wifi_config = wlan_object_get_instance_wifi_config(
                 WLAN_OBJ, ANJAY_WIFI_OBJ_PRECONFIGURED_INSTANCE);
+        backoff_t backoff;
+        backoff_init(&backoff, CONFIG_ANJAY_WIFI_RECONNECT_BACKOFF_BASE,
+                     CONFIG_ANJAY_WIFI_RECONNECT_BACKOFF_MAX,
+                     CONFIG_ANJAY_WIFI_RECONNECT_BACKOFF_JITTER);
         while (wifi_connect(&wifi_config)) {
+            uint32_t delay_ms = backoff_next_ms(&backoff);
             avs_log(tutorial, WARNING,
                     "Connection attempt to preconfigured wifi has failed, "
-                    "reconnection in progress...");
+                    "retrying in %" PRIu32 " ms", delay_ms);
+            vTaskDelay(pdMS_TO_TICKS(delay_ms));
         }
-        wlan_object_set_instance_enable(
-                anjay, WLAN_OBJ, ANJAY_WIFI_OBJ_PRECONFIGURED_INSTANCE, true);
-        wlan_object_set_instance_enable(
-                anjay, WLAN_OBJ, ANJAY_WIFI_OBJ_WRITABLE_INSTANCE, false);
+        wlan_object_select_instance(anjay, WLAN_OBJ,
+                                    ANJAY_WIFI_OBJ_PRECONFIGURED_INSTANCE);
         wlan_object_set_writable_iface_failed(anjay, WLAN_OBJ, true);
     }
+    wifi_applied_config = wifi_config;
 #endif // CONFIG_ANJAY_CLIENT_INTERFACE_BG96_MODULE
 
 #ifdef CONFIG_ANJAY_CLIENT_LCD
@@ -598,5 +1169,7 @@ void app_main(void) {
 #    endif // CONFIG_ANJAY_CLIENT_INTERFACE_BG96_MODULE
 #endif     // CONFIG_ANJAY_CLIENT_LCD
 
-    xTaskCreate(&anjay_task, "anjay_task", 16384, NULL, 5, NULL);
+    xTaskCreatePinnedToCore(&anjay_task, "anjay_task", ANJAY_TASK_STACK_SIZE,
+                            NULL, ANJAY_TASK_PRIORITY, NULL,
+                            ANJAY_TASK_CORE_ID);
 }
@@ -19,10 +19,17 @@
 
 #define MAIN_NVS_CONFIG_NAMESPACE "config"
 #define MAIN_NVS_WRITABLE_WIFI_CONFIG_NAMESPACE "writable_wifi"
-#define MAIN_NVS_WIFI_SSID_KEY "wifi_ssid"
-#define MAIN_NVS_WIFI_PASSWORD_KEY "wifi_pswd"
-#define MAIN_NVS_ENABLE_KEY "wifi_inter_en"
+#define MAIN_NVS_ADDITIONAL_WIFI_CONFIG_NAMESPACE_FMT "wifi_net%u"
 
 void schedule_change_config(void);
 
+/**
+ * Records traffic that is likely to be followed by more, e.g. a served
+ * message or the start of a registration or download. With WiFi power save
+ * enabled, the radio is kept in low-latency mode until
+ * CONFIG_ANJAY_WIFI_POWER_SAVE_LINGER ms after the last such call. Must be
+ * called from the Anjay task.
+ */
+void note_network_activity(void);
+
 #endif // _MAIN_H_
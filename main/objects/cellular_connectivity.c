@@ -0,0 +1,226 @@
+/*
+ * Copyright 2021-2025 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <assert.h>
+#include <stdbool.h>
+
+#include <anjay/anjay.h>
+#include <avsystem/commons/avs_defs.h>
+#include <avsystem/commons/avs_memory.h>
+
+#include "../cellular_anjay_impl/power_saving.h"
+#include "objects.h"
+
+/**
+ * Cellular Connectivity object ID
+ */
+#define OID_CELLULAR_CONNECTIVITY 10
+
+/**
+ * PSM Timer: RW, Single, Optional
+ * type: integer, range: 0..1116000, unit: s
+ * Power Saving Mode timer (T3412) currently in use. Exposed as read-only; it
+ * follows the Lifetime of the Server object.
+ */
+#define RID_PSM_TIMER 4
+
+/**
+ * Active Timer: RW, Single, Optional
+ * type: integer, range: 0..1860, unit: s
+ * Active timer (T3324) currently in use. Exposed as read-only.
+ */
+#define RID_ACTIVE_TIMER 5
+
+/**
+ * eDRX parameters for WB-S1 mode: RW, Single, Optional
+ * type: opaque, range: 8 bits, unit: N/A
+ * Extended DRX parameters (PTW and eDRX cycle) for WB-S1 mode. Exposed as
+ * read-only.
+ */
+#define RID_EDRX_WB_S1 8
+
+/**
+ * eDRX parameters for NB-S1 mode: RW, Single, Optional
+ * type: opaque, range: 8 bits, unit: N/A
+ * Extended DRX parameters (PTW and eDRX cycle) for NB-S1 mode. Exposed as
+ * read-only.
+ */
+#define RID_EDRX_NB_S1 9
+
+/**
+ * Activated Profile Names: R, Multiple, Mandatory
+ * type: objlnk, range: N/A, unit: N/A
+ * Links to instances of the APN Connection Profile object. The APN is
+ * configured by the cellular library, so no instances are reported.
+ */
+#define RID_ACTIVATED_PROFILE_NAMES 11
+
+typedef struct cellular_connectivity_object_struct {
+    const anjay_dm_object_def_t *def;
+    power_saving_status_t reported_status;
+} cellular_connectivity_object_t;
+
+static inline cellular_connectivity_object_t *
+get_obj(const anjay_dm_object_def_t *const *obj_ptr) {
+    assert(obj_ptr);
+    return AVS_CONTAINER_OF(obj_ptr, cellular_connectivity_object_t, def);
+}
+
+static int list_resources(anjay_t *anjay,
+                          const anjay_dm_object_def_t *const *obj_ptr,
+                          anjay_iid_t iid,
+                          anjay_dm_resource_list_ctx_t *ctx) {
+    (void) anjay;
+    (void) iid;
+
+    const power_saving_status_t *status = &get_obj(obj_ptr)->reported_status;
+    anjay_dm_emit_res(ctx, RID_PSM_TIMER, ANJAY_DM_RES_R,
+                      status->psm_enabled ? ANJAY_DM_RES_PRESENT
+                                          : ANJAY_DM_RES_ABSENT);
+    anjay_dm_emit_res(ctx, RID_ACTIVE_TIMER, ANJAY_DM_RES_R,
+                      status->psm_enabled ? ANJAY_DM_RES_PRESENT
+                                          : ANJAY_DM_RES_ABSENT);
+    anjay_dm_emit_res(ctx, RID_EDRX_WB_S1, ANJAY_DM_RES_R,
+                      status->edrx_enabled ? ANJAY_DM_RES_PRESENT
+                                           : ANJAY_DM_RES_ABSENT);
+    anjay_dm_emit_res(ctx, RID_EDRX_NB_S1, ANJAY_DM_RES_R,
+                      status->edrx_enabled ? ANJAY_DM_RES_PRESENT
+                                           : ANJAY_DM_RES_ABSENT);
+    anjay_dm_emit_res(ctx, RID_ACTIVATED_PROFILE_NAMES, ANJAY_DM_RES_RM,
+                      ANJAY_DM_RES_PRESENT);
+    return 0;
+}
+
+static int resource_read(anjay_t *anjay,
+                         const anjay_dm_object_def_t *const *obj_ptr,
+                         anjay_iid_t iid,
+                         anjay_rid_t rid,
+                         anjay_riid_t riid,
+                         anjay_output_ctx_t *ctx) {
+    (void) anjay;
+    (void) iid;
+
+    const power_saving_status_t *status = &get_obj(obj_ptr)->reported_status;
+
+    switch (rid) {
+    case RID_PSM_TIMER:
+        assert(riid == ANJAY_ID_INVALID);
+        return anjay_ret_i64(ctx, status->periodic_tau_s);
+
+    case RID_ACTIVE_TIMER:
+        assert(riid == ANJAY_ID_INVALID);
+        return anjay_ret_i64(ctx, status->active_time_s);
+
+    case RID_EDRX_WB_S1:
+        assert(riid == ANJAY_ID_INVALID);
+        return anjay_ret_bytes(ctx, &status->edrx_wb_s1,
+                               sizeof(status->edrx_wb_s1));
+
+    case RID_EDRX_NB_S1:
+        assert(riid == ANJAY_ID_INVALID);
+        return anjay_ret_bytes(ctx, &status->edrx_nb_s1,
+                               sizeof(status->edrx_nb_s1));
+
+    default:
+        return ANJAY_ERR_METHOD_NOT_ALLOWED;
+    }
+}
+
+static int list_resource_instances(anjay_t *anjay,
+                                   const anjay_dm_object_def_t *const *obj_ptr,
+                                   anjay_iid_t iid,
+                                   anjay_rid_t rid,
+                                   anjay_dm_list_ctx_t *ctx) {
+    (void) anjay;
+    (void) obj_ptr;
+    (void) iid;
+    (void) ctx;
+
+    switch (rid) {
+    case RID_ACTIVATED_PROFILE_NAMES:
+        return 0;
+    default:
+        return ANJAY_ERR_METHOD_NOT_ALLOWED;
+    }
+}
+
+static const anjay_dm_object_def_t OBJ_DEF = {
+    .oid = OID_CELLULAR_CONNECTIVITY,
+    .handlers = {
+        .list_instances = anjay_dm_list_instances_SINGLE,
+        .list_resources = list_resources,
+        .resource_read = resource_read,
+        .list_resource_instances = list_resource_instances
+    }
+};
+
+const anjay_dm_object_def_t **cellular_connectivity_object_create(void) {
+    cellular_connectivity_object_t *obj =
+            (cellular_connectivity_object_t *) avs_calloc(
+                    1, sizeof(cellular_connectivity_object_t));
+    if (!obj) {
+        return NULL;
+    }
+    obj->def = &OBJ_DEF;
+    obj->reported_status = *power_saving_get_status();
+
+    return &obj->def;
+}
+
+void cellular_connectivity_object_release(const anjay_dm_object_def_t **def) {
+    if (def) {
+        cellular_connectivity_object_t *obj = get_obj(def);
+        avs_free(obj);
+    }
+}
+
+void cellular_connectivity_object_update(
+        anjay_t *anjay, const anjay_dm_object_def_t *const *def) {
+    if (!anjay || !def) {
+        return;
+    }
+
+    cellular_connectivity_object_t *obj = get_obj(def);
+    const power_saving_status_t *status = power_saving_get_status();
+    power_saving_status_t *reported = &obj->reported_status;
+
+    if (reported->psm_enabled != status->psm_enabled
+            || reported->edrx_enabled != status->edrx_enabled) {
+        *reported = *status;
+        (void) anjay_notify_instances_changed(anjay, OID_CELLULAR_CONNECTIVITY);
+        return;
+    }
+    if (reported->periodic_tau_s != status->periodic_tau_s) {
+        reported->periodic_tau_s = status->periodic_tau_s;
+        (void) anjay_notify_changed(anjay, OID_CELLULAR_CONNECTIVITY, 0,
+                                    RID_PSM_TIMER);
+    }
+    if (reported->active_time_s != status->active_time_s) {
+        reported->active_time_s = status->active_time_s;
+        (void) anjay_notify_changed(anjay, OID_CELLULAR_CONNECTIVITY, 0,
+                                    RID_ACTIVE_TIMER);
+    }
+    if (reported->edrx_wb_s1 != status->edrx_wb_s1) {
+        reported->edrx_wb_s1 = status->edrx_wb_s1;
+        (void) anjay_notify_changed(anjay, OID_CELLULAR_CONNECTIVITY, 0,
+                                    RID_EDRX_WB_S1);
+    }
+    if (reported->edrx_nb_s1 != status->edrx_nb_s1) {
+        reported->edrx_nb_s1 = status->edrx_nb_s1;
+        (void) anjay_notify_changed(anjay, OID_CELLULAR_CONNECTIVITY, 0,
+                                    RID_EDRX_NB_S1);
+    }
+}
@@ -0,0 +1,313 @@
+/*
+ * Copyright 2021-2025 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <assert.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include <anjay/anjay.h>
+#include <avsystem/commons/avs_defs.h>
+#include <avsystem/commons/avs_memory.h>
+
+#include "../cellular_anjay_impl/modem_status.h"
+#include "objects.h"
+
+/**
+ * Connectivity Monitoring object ID
+ */
+#define OID_CONNECTIVITY_MONITORING 4
+
+/**
+ * Network Bearer: R, Single, Mandatory
+ * type: integer, range: N/A, unit: N/A
+ * Network bearer used for the current LwM2M communication session.
+ */
+#define RID_NETWORK_BEARER 0
+
+/**
+ * Available Network Bearer: R, Multiple, Mandatory
+ * type: integer, range: N/A, unit: N/A
+ * Current available network bearers.
+ */
+#define RID_AVAILABLE_NETWORK_BEARER 1
+
+/**
+ * Radio Signal Strength: R, Single, Mandatory
+ * type: integer, range: N/A, unit: dBm
+ * Average received signal strength; RSRP for LTE.
+ */
+#define RID_RADIO_SIGNAL_STRENGTH 2
+
+/**
+ * Link Quality: R, Single, Optional
+ * type: integer, range: N/A, unit: N/A
+ * Received link quality; RSRQ (dB) for LTE.
+ */
+#define RID_LINK_QUALITY 3
+
+/**
+ * IP Addresses: R, Multiple, Mandatory
+ * type: string, range: N/A, unit: N/A
+ * IP addresses assigned to the connectivity interface.
+ */
+#define RID_IP_ADDRESSES 4
+
+/**
+ * Cell ID: R, Single, Optional
+ * type: integer, range: N/A, unit: N/A
+ * Serving cell ID.
+ */
+#define RID_CELL_ID 8
+
+/**
+ * SMNC: R, Single, Optional
+ * type: integer, range: N/A, unit: N/A
+ * Serving Mobile Network Code.
+ */
+#define RID_SMNC 9
+
+/**
+ * SMCC: R, Single, Optional
+ * type: integer, range: N/A, unit: N/A
+ * Serving Mobile Country Code.
+ */
+#define RID_SMCC 10
+
+/**
+ * SignalSNR: R, Single, Optional
+ * type: integer, range: N/A, unit: dB
+ * SINR of the serving cell.
+ */
+#define RID_SIGNAL_SNR 11
+
+/**
+ * LAC: R, Single, Optional
+ * type: integer, range: N/A, unit: N/A
+ * Location (tracking) area code.
+ */
+#define RID_LAC 12
+
+// Network Bearer values defined by the object
+#define NETWORK_BEARER_GSM 0
+#define NETWORK_BEARER_LTE_FDD 6
+#define NETWORK_BEARER_NB_IOT 7
+
+typedef struct connectivity_monitoring_object_struct {
+    const anjay_dm_object_def_t *def;
+    modem_status_t reported;
+} connectivity_monitoring_object_t;
+
+static inline connectivity_monitoring_object_t *
+get_obj(const anjay_dm_object_def_t *const *obj_ptr) {
+    assert(obj_ptr);
+    return AVS_CONTAINER_OF(obj_ptr, connectivity_monitoring_object_t, def);
+}
+
+static int32_t network_bearer(modem_status_rat_t rat) {
+    switch (rat) {
+    case MODEM_STATUS_RAT_GSM:
+        return NETWORK_BEARER_GSM;
+    case MODEM_STATUS_RAT_NB_IOT:
+        return NETWORK_BEARER_NB_IOT;
+    default:
+        // BG96 LTE-M operates in FDD bands only
+        return NETWORK_BEARER_LTE_FDD;
+    }
+}
+
+static int list_resources(anjay_t *anjay,
+                          const anjay_dm_object_def_t *const *obj_ptr,
+                          anjay_iid_t iid,
+                          anjay_dm_resource_list_ctx_t *ctx) {
+    (void) anjay;
+    (void) iid;
+
+    const modem_status_t *status = &get_obj(obj_ptr)->reported;
+    anjay_dm_resource_presence_t cell_presence =
+            status->valid ? ANJAY_DM_RES_PRESENT : ANJAY_DM_RES_ABSENT;
+
+    anjay_dm_emit_res(ctx, RID_NETWORK_BEARER, ANJAY_DM_RES_R,
+                      ANJAY_DM_RES_PRESENT);
+    anjay_dm_emit_res(ctx, RID_AVAILABLE_NETWORK_BEARER, ANJAY_DM_RES_RM,
+                      ANJAY_DM_RES_PRESENT);
+    anjay_dm_emit_res(ctx, RID_RADIO_SIGNAL_STRENGTH, ANJAY_DM_RES_R,
+                      ANJAY_DM_RES_PRESENT);
+    anjay_dm_emit_res(ctx, RID_LINK_QUALITY, ANJAY_DM_RES_R, cell_presence);
+    anjay_dm_emit_res(ctx, RID_IP_ADDRESSES, ANJAY_DM_RES_RM,
+                      ANJAY_DM_RES_PRESENT);
+    anjay_dm_emit_res(ctx, RID_CELL_ID, ANJAY_DM_RES_R, cell_presence);
+    anjay_dm_emit_res(ctx, RID_SMNC, ANJAY_DM_RES_R, cell_presence);
+    anjay_dm_emit_res(ctx, RID_SMCC, ANJAY_DM_RES_R, cell_presence);
+    anjay_dm_emit_res(ctx, RID_SIGNAL_SNR, ANJAY_DM_RES_R, cell_presence);
+    anjay_dm_emit_res(ctx, RID_LAC, ANJAY_DM_RES_R, cell_presence);
+    return 0;
+}
+
+static int resource_read(anjay_t *anjay,
+                         const anjay_dm_object_def_t *const *obj_ptr,
+                         anjay_iid_t iid,
+                         anjay_rid_t rid,
+                         anjay_riid_t riid,
+                         anjay_output_ctx_t *ctx) {
+    (void) anjay;
+    (void) iid;
+
+    // Values are served from the cache; stale ones are refreshed by the next
+    // update rather than with a synchronous AT exchange
+    const modem_status_t *status = &get_obj(obj_ptr)->reported;
+    modem_status_request_refresh();
+
+    switch (rid) {
+    case RID_NETWORK_BEARER:
+    case RID_AVAILABLE_NETWORK_BEARER:
+        assert(rid == RID_NETWORK_BEARER ? riid == ANJAY_ID_INVALID
+                                         : riid == 0);
+        return anjay_ret_i32(ctx, network_bearer(status->rat));
+
+    case RID_RADIO_SIGNAL_STRENGTH:
+        assert(riid == ANJAY_ID_INVALID);
+        return anjay_ret_i32(ctx, status->valid ? status->rsrp_dbm : 0);
+
+    case RID_LINK_QUALITY:
+        assert(riid == ANJAY_ID_INVALID);
+        return anjay_ret_i32(ctx, status->rsrq_db);
+
+    case RID_IP_ADDRESSES:
+        assert(riid == 0);
+        return anjay_ret_string(ctx, status->ip_address);
+
+    case RID_CELL_ID:
+        assert(riid == ANJAY_ID_INVALID);
+        return anjay_ret_i64(ctx, status->cell_id);
+
+    case RID_SMNC:
+        assert(riid == ANJAY_ID_INVALID);
+        return anjay_ret_i32(ctx, status->mnc);
+
+    case RID_SMCC:
+        assert(riid == ANJAY_ID_INVALID);
+        return anjay_ret_i32(ctx, status->mcc);
+
+    case RID_SIGNAL_SNR:
+        assert(riid == ANJAY_ID_INVALID);
+        return anjay_ret_i32(ctx, status->sinr_db);
+
+    case RID_LAC:
+        assert(riid == ANJAY_ID_INVALID);
+        return anjay_ret_i32(ctx, status->tac);
+
+    default:
+        return ANJAY_ERR_METHOD_NOT_ALLOWED;
+    }
+}
+
+static int list_resource_instances(anjay_t *anjay,
+                                   const anjay_dm_object_def_t *const *obj_ptr,
+                                   anjay_iid_t iid,
+                                   anjay_rid_t rid,
+                                   anjay_dm_list_ctx_t *ctx) {
+    (void) anjay;
+    (void) iid;
+
+    switch (rid) {
+    case RID_AVAILABLE_NETWORK_BEARER:
+        anjay_dm_emit(ctx, 0);
+        return 0;
+    case RID_IP_ADDRESSES:
+        if (get_obj(obj_ptr)->reported.ip_address[0]) {
+            anjay_dm_emit(ctx, 0);
+        }
+        return 0;
+    default:
+        return ANJAY_ERR_METHOD_NOT_ALLOWED;
+    }
+}
+
+static const anjay_dm_object_def_t OBJ_DEF = {
+    .oid = OID_CONNECTIVITY_MONITORING,
+    .handlers = {
+        .list_instances = anjay_dm_list_instances_SINGLE,
+        .list_resources = list_resources,
+        .resource_read = resource_read,
+        .list_resource_instances = list_resource_instances
+    }
+};
+
+const anjay_dm_object_def_t **connectivity_monitoring_object_create(void) {
+    connectivity_monitoring_object_t *obj =
+            (connectivity_monitoring_object_t *) avs_calloc(
+                    1, sizeof(connectivity_monitoring_object_t));
+    if (!obj) {
+        return NULL;
+    }
+    obj->def = &OBJ_DEF;
+    obj->reported = *modem_status_get();
+
+    return &obj->def;
+}
+
+void connectivity_monitoring_object_release(
+        const anjay_dm_object_def_t **def) {
+    if (def) {
+        connectivity_monitoring_object_t *obj = get_obj(def);
+        avs_free(obj);
+    }
+}
+
+static void notify_if_changed(anjay_t *anjay,
+                              anjay_rid_t rid,
+                              int64_t reported,
+                              int64_t current) {
+    if (reported != current) {
+        (void) anjay_notify_changed(anjay, OID_CONNECTIVITY_MONITORING, 0,
+                                    rid);
+    }
+}
+
+void connectivity_monitoring_object_update(
+        anjay_t *anjay, const anjay_dm_object_def_t *const *def) {
+    if (!anjay || !def || !modem_status_refresh()) {
+        return;
+    }
+
+    connectivity_monitoring_object_t *obj = get_obj(def);
+    const modem_status_t *status = modem_status_get();
+    modem_status_t *reported = &obj->reported;
+
+    if (reported->valid != status->valid
+            || !reported->ip_address[0] != !status->ip_address[0]) {
+        *reported = *status;
+        (void) anjay_notify_instances_changed(anjay,
+                                              OID_CONNECTIVITY_MONITORING);
+        return;
+    }
+    notify_if_changed(anjay, RID_NETWORK_BEARER, reported->rat, status->rat);
+    notify_if_changed(anjay, RID_RADIO_SIGNAL_STRENGTH, reported->rsrp_dbm,
+                      status->rsrp_dbm);
+    notify_if_changed(anjay, RID_LINK_QUALITY, reported->rsrq_db,
+                      status->rsrq_db);
+    notify_if_changed(anjay, RID_CELL_ID, reported->cell_id, status->cell_id);
+    notify_if_changed(anjay, RID_SMNC, reported->mnc, status->mnc);
+    notify_if_changed(anjay, RID_SMCC, reported->mcc, status->mcc);
+    notify_if_changed(anjay, RID_SIGNAL_SNR, reported->sinr_db,
+                      status->sinr_db);
+    notify_if_changed(anjay, RID_LAC, reported->tac, status->tac);
+    if (strcmp(reported->ip_address, status->ip_address)) {
+        (void) anjay_notify_changed(anjay, OID_CONNECTIVITY_MONITORING, 0,
+                                    RID_IP_ADDRESSES);
+    }
+    *reported = *status;
+}
@@ -0,0 +1,328 @@
+/*
+ * Copyright 2021-2025 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <anjay/anjay.h>
+#include <avsystem/commons/avs_defs.h>
+#include <avsystem/commons/avs_memory.h>
+#include <avsystem/commons/avs_time.h>
+
+#include "../cellular_anjay_impl/net_impl.h"
+#include "objects.h"
+
+/**
+ * Connectivity Statistics object ID
+ */
+#define OID_CONNECTIVITY_STATISTICS 7
+
+/**
+ * Tx Data: R, Single, Optional
+ * type: integer, range: N/A, unit: kB
+ * Total amount of data transmitted during the collection period.
+ */
+#define RID_TX_DATA 2
+
+/**
+ * Rx Data: R, Single, Optional
+ * type: integer, range: N/A, unit: kB
+ * Total amount of data received during the collection period.
+ */
+#define RID_RX_DATA 3
+
+/**
+ * Max Message Size: R, Single, Optional
+ * type: integer, range: N/A, unit: B
+ * The maximum message size that is used during the collection period.
+ */
+#define RID_MAX_MESSAGE_SIZE 4
+
+/**
+ * Average Message Size: R, Single, Optional
+ * type: integer, range: N/A, unit: B
+ * The average message size that is used during the collection period.
+ */
+#define RID_AVERAGE_MESSAGE_SIZE 5
+
+/**
+ * Start: E, Single, Mandatory
+ * type: N/A, range: N/A, unit: N/A
+ * Resets the counters and starts collecting information.
+ */
+#define RID_START 6
+
+/**
+ * Stop: E, Single, Mandatory
+ * type: N/A, range: N/A, unit: N/A
+ * Stops collecting information, the counters keep their values.
+ */
+#define RID_STOP 7
+
+/**
+ * Collection Period: RW, Single, Optional
+ * type: integer, range: N/A, unit: s
+ * Time after which collection stops automatically, 0 to collect until Stop is
+ * executed.
+ */
+#define RID_COLLECTION_PERIOD 8
+
+typedef struct connectivity_statistics_object_struct {
+    const anjay_dm_object_def_t *def;
+    bool collecting;
+    avs_time_monotonic_t started;
+    int32_t collection_period_s;
+    int32_t collection_period_s_backup;
+    // Counters frozen by Stop
+    net_impl_traffic_stats_t stopped_stats;
+    // Last values notified to observers
+    net_impl_traffic_stats_t reported_stats;
+} connectivity_statistics_object_t;
+
+static inline connectivity_statistics_object_t *
+get_obj(const anjay_dm_object_def_t *const *obj_ptr) {
+    assert(obj_ptr);
+    return AVS_CONTAINER_OF(obj_ptr, connectivity_statistics_object_t, def);
+}
+
+static const net_impl_traffic_stats_t *
+current_stats(const connectivity_statistics_object_t *obj) {
+    return obj->collecting ? net_impl_get_traffic_stats()
+                           : &obj->stopped_stats;
+}
+
+static int list_resources(anjay_t *anjay,
+                          const anjay_dm_object_def_t *const *obj_ptr,
+                          anjay_iid_t iid,
+                          anjay_dm_resource_list_ctx_t *ctx) {
+    (void) anjay;
+    (void) obj_ptr;
+    (void) iid;
+
+    anjay_dm_emit_res(ctx, RID_TX_DATA, ANJAY_DM_RES_R, ANJAY_DM_RES_PRESENT);
+    anjay_dm_emit_res(ctx, RID_RX_DATA, ANJAY_DM_RES_R, ANJAY_DM_RES_PRESENT);
+    anjay_dm_emit_res(ctx, RID_MAX_MESSAGE_SIZE, ANJAY_DM_RES_R,
+                      ANJAY_DM_RES_PRESENT);
+    anjay_dm_emit_res(ctx, RID_AVERAGE_MESSAGE_SIZE, ANJAY_DM_RES_R,
+                      ANJAY_DM_RES_PRESENT);
+    anjay_dm_emit_res(ctx, RID_START, ANJAY_DM_RES_E, ANJAY_DM_RES_PRESENT);
+    anjay_dm_emit_res(ctx, RID_STOP, ANJAY_DM_RES_E, ANJAY_DM_RES_PRESENT);
+    anjay_dm_emit_res(ctx, RID_COLLECTION_PERIOD, ANJAY_DM_RES_RW,
+                      ANJAY_DM_RES_PRESENT);
+    return 0;
+}
+
+static int resource_read(anjay_t *anjay,
+                         const anjay_dm_object_def_t *const *obj_ptr,
+                         anjay_iid_t iid,
+                         anjay_rid_t rid,
+                         anjay_riid_t riid,
+                         anjay_output_ctx_t *ctx) {
+    (void) anjay;
+    (void) iid;
+    (void) riid;
+    assert(riid == ANJAY_ID_INVALID);
+
+    connectivity_statistics_object_t *obj = get_obj(obj_ptr);
+    const net_impl_traffic_stats_t *stats = current_stats(obj);
+    uint32_t messages = stats->messages_sent + stats->messages_received;
+
+    switch (rid) {
+    case RID_TX_DATA:
+        return anjay_ret_i64(ctx, (int64_t) (stats->bytes_sent / 1024));
+
+    case RID_RX_DATA:
+        return anjay_ret_i64(ctx, (int64_t) (stats->bytes_received / 1024));
+
+    case RID_MAX_MESSAGE_SIZE:
+        return anjay_ret_i64(ctx, (int64_t) stats->max_message_size);
+
+    case RID_AVERAGE_MESSAGE_SIZE:
+        return anjay_ret_i64(
+                ctx, messages ? (int64_t) ((stats->bytes_sent
+                                            + stats->bytes_received)
+                                           / messages)
+                              : 0);
+
+    case RID_COLLECTION_PERIOD:
+        return anjay_ret_i32(ctx, obj->collection_period_s);
+
+    default:
+        return ANJAY_ERR_METHOD_NOT_ALLOWED;
+    }
+}
+
+static int resource_write(anjay_t *anjay,
+                          const anjay_dm_object_def_t *const *obj_ptr,
+                          anjay_iid_t iid,
+                          anjay_rid_t rid,
+                          anjay_riid_t riid,
+                          anjay_input_ctx_t *ctx) {
+    (void) anjay;
+    (void) iid;
+    (void) riid;
+
+    connectivity_statistics_object_t *obj = get_obj(obj_ptr);
+
+    switch (rid) {
+    case RID_COLLECTION_PERIOD:
+        assert(riid == ANJAY_ID_INVALID);
+        return anjay_get_i32(ctx, &obj->collection_period_s);
+
+    default:
+        return ANJAY_ERR_METHOD_NOT_ALLOWED;
+    }
+}
+
+static void start_collecting(connectivity_statistics_object_t *obj) {
+    net_impl_reset_traffic_stats();
+    obj->collecting = true;
+    obj->started = avs_time_monotonic_now();
+}
+
+static void stop_collecting(connectivity_statistics_object_t *obj) {
+    if (obj->collecting) {
+        obj->stopped_stats = *net_impl_get_traffic_stats();
+        obj->collecting = false;
+    }
+}
+
+static int resource_execute(anjay_t *anjay,
+                            const anjay_dm_object_def_t *const *obj_ptr,
+                            anjay_iid_t iid,
+                            anjay_rid_t rid,
+                            anjay_execute_ctx_t *arg_ctx) {
+    (void) anjay;
+    (void) iid;
+    (void) arg_ctx;
+
+    connectivity_statistics_object_t *obj = get_obj(obj_ptr);
+
+    switch (rid) {
+    case RID_START:
+        start_collecting(obj);
+        return 0;
+
+    case RID_STOP:
+        stop_collecting(obj);
+        return 0;
+
+    default:
+        return ANJAY_ERR_METHOD_NOT_ALLOWED;
+    }
+}
+
+static int transaction_begin(anjay_t *anjay,
+                             const anjay_dm_object_def_t *const *obj_ptr) {
+    (void) anjay;
+
+    connectivity_statistics_object_t *obj = get_obj(obj_ptr);
+    obj->collection_period_s_backup = obj->collection_period_s;
+    return 0;
+}
+
+static int transaction_validate(anjay_t *anjay,
+                                const anjay_dm_object_def_t *const *obj_ptr) {
+    (void) anjay;
+
+    return get_obj(obj_ptr)->collection_period_s < 0 ? ANJAY_ERR_BAD_REQUEST
+                                                     : 0;
+}
+
+static int transaction_rollback(anjay_t *anjay,
+                                const anjay_dm_object_def_t *const *obj_ptr) {
+    (void) anjay;
+
+    connectivity_statistics_object_t *obj = get_obj(obj_ptr);
+    obj->collection_period_s = obj->collection_period_s_backup;
+    return 0;
+}
+
+static const anjay_dm_object_def_t OBJ_DEF = {
+    .oid = OID_CONNECTIVITY_STATISTICS,
+    .handlers = {
+        .list_instances = anjay_dm_list_instances_SINGLE,
+        .list_resources = list_resources,
+        .resource_read = resource_read,
+        .resource_write = resource_write,
+        .resource_execute = resource_execute,
+
+        .transaction_begin = transaction_begin,
+        .transaction_validate = transaction_validate,
+        .transaction_commit = anjay_dm_transaction_NOOP,
+        .transaction_rollback = transaction_rollback
+    }
+};
+
+const anjay_dm_object_def_t **connectivity_statistics_object_create(void) {
+    connectivity_statistics_object_t *obj =
+            (connectivity_statistics_object_t *) avs_calloc(
+                    1, sizeof(connectivity_statistics_object_t));
+    if (!obj) {
+        return NULL;
+    }
+    obj->def = &OBJ_DEF;
+    // Traffic is counted from boot, so that it is visible without Start
+    obj->collecting = true;
+    obj->started = avs_time_monotonic_now();
+
+    return &obj->def;
+}
+
+void connectivity_statistics_object_release(
+        const anjay_dm_object_def_t **def) {
+    if (def) {
+        connectivity_statistics_object_t *obj = get_obj(def);
+        avs_free(obj);
+    }
+}
+
+void connectivity_statistics_object_update(
+        anjay_t *anjay, const anjay_dm_object_def_t *const *def) {
+    if (!anjay || !def) {
+        return;
+    }
+
+    connectivity_statistics_object_t *obj = get_obj(def);
+    if (obj->collecting && obj->collection_period_s > 0
+            && !avs_time_monotonic_before(
+                       avs_time_monotonic_now(),
+                       avs_time_monotonic_add(
+                               obj->started,
+                               avs_time_duration_from_scalar(
+                                       obj->collection_period_s,
+                                       AVS_TIME_S)))) {
+        stop_collecting(obj);
+    }
+
+    const net_impl_traffic_stats_t *stats = current_stats(obj);
+    net_impl_traffic_stats_t *reported = &obj->reported_stats;
+    // Notified in kB granularity, like the resources themselves
+    if (reported->bytes_sent / 1024 != stats->bytes_sent / 1024) {
+        (void) anjay_notify_changed(anjay, OID_CONNECTIVITY_STATISTICS, 0,
+                                    RID_TX_DATA);
+    }
+    if (reported->bytes_received / 1024 != stats->bytes_received / 1024) {
+        (void) anjay_notify_changed(anjay, OID_CONNECTIVITY_STATISTICS, 0,
+                                    RID_RX_DATA);
+    }
+    if (reported->max_message_size != stats->max_message_size) {
+        (void) anjay_notify_changed(anjay, OID_CONNECTIVITY_STATISTICS, 0,
+                                    RID_MAX_MESSAGE_SIZE);
+    }
+    *reported = *stats;
+}
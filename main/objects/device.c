@@ -24,6 +24,7 @@
 #include <esp_system.h>
 
 #include "../default_config.h"
+#include "../storage.h"
 #include "../utils.h"
 #include "objects.h"
 
@@ -294,6 +295,7 @@ void device_object_update(anjay_t *anjay,
     if (obj->do_reboot) {
         // This is a bit harsh, but this is the nicest way to ensure
         // the reboot using the public ESP32 API
+        storage_flush();
         esp_system_abort("Rebooting ...");
     }
 }
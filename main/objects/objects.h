@@ -30,7 +30,8 @@ typedef struct three_axis_sensor_data_struct {
 
 typedef enum {
     ANJAY_WIFI_OBJ_WRITABLE_INSTANCE,
-    ANJAY_WIFI_OBJ_PRECONFIGURED_INSTANCE
+    ANJAY_WIFI_OBJ_PRECONFIGURED_INSTANCE,
+    ANJAY_WIFI_OBJ_ADDITIONAL_INSTANCE
 } wifi_instance_t;
 
 const anjay_dm_object_def_t **push_button_object_create(void);
@@ -46,6 +47,28 @@ void device_object_release(const anjay_dm_object_def_t **def);
 void device_object_update(anjay_t *anjay,
                           const anjay_dm_object_def_t *const *def);
 
+const anjay_dm_object_def_t **scheduler_stats_object_create(void);
+void scheduler_stats_object_release(const anjay_dm_object_def_t **def);
+void scheduler_stats_object_update(anjay_t *anjay,
+                                   const anjay_dm_object_def_t *const *def);
+
+const anjay_dm_object_def_t **cellular_connectivity_object_create(void);
+void cellular_connectivity_object_release(const anjay_dm_object_def_t **def);
+void cellular_connectivity_object_update(
+        anjay_t *anjay, const anjay_dm_object_def_t *const *def);
+
+const anjay_dm_object_def_t **connectivity_monitoring_object_create(void);
+void connectivity_monitoring_object_release(
+        const anjay_dm_object_def_t **def);
+void connectivity_monitoring_object_update(
+        anjay_t *anjay, const anjay_dm_object_def_t *const *def);
+
+const anjay_dm_object_def_t **connectivity_statistics_object_create(void);
+void connectivity_statistics_object_release(
+        const anjay_dm_object_def_t **def);
+void connectivity_statistics_object_update(
+        anjay_t *anjay, const anjay_dm_object_def_t *const *def);
+
 const anjay_dm_object_def_t **wlan_object_create(void);
 void wlan_object_release(const anjay_dm_object_def_t **def);
 void wlan_object_set_instance_wifi_config(
@@ -60,12 +83,26 @@ void wlan_object_set_instance_enable(
         const anjay_dm_object_def_t *const *obj_ptr,
         wifi_instance_t iid,
         bool en);
+/**
+ * Makes @p iid, either the writable or the preconfigured instance, the one in
+ * use and disables the other, persisting both flags at once.
+ */
+void wlan_object_select_instance(const anjay_t *anjay,
+                                 const anjay_dm_object_def_t *const *obj_ptr,
+                                 wifi_instance_t iid);
 bool wlan_object_is_instance_enabled(
         const anjay_dm_object_def_t *const *obj_ptr, wifi_instance_t iid);
 void wlan_object_set_writable_iface_failed(
         const anjay_t *anjay,
         const anjay_dm_object_def_t *const *obj_ptr,
         bool val);
+size_t wlan_object_instance_count(const anjay_dm_object_def_t *const *obj_ptr);
+/**
+ * Notifies the scan result resources of each instance whose values differ
+ * from the ones seen at the previous call.
+ */
+void wlan_object_scan_results_changed(
+        anjay_t *anjay, const anjay_dm_object_def_t *const *obj_ptr);
 
 void sensors_install(anjay_t *anjay);
 void sensors_update(anjay_t *anjay);
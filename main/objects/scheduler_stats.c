@@ -0,0 +1,276 @@
+/*
+ * Copyright 2021-2025 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <assert.h>
+#include <stdbool.h>
+
+#include <anjay/anjay.h>
+#include <avsystem/commons/avs_defs.h>
+#include <avsystem/commons/avs_memory.h>
+
+#include "../sched_stats.h"
+#include "objects.h"
+
+/**
+ * Scheduler statistics object ID
+ */
+#define OID_SCHEDULER_STATS 26241
+
+/**
+ * Job Name: R, Single, Mandatory
+ * type: string, range: N/A, unit: N/A
+ * Name of the scheduler job callback.
+ */
+#define RID_JOB_NAME 0
+
+/**
+ * Run Count: R, Single, Mandatory
+ * type: integer, range: N/A, unit: N/A
+ * Number of times the job has been executed since the last reset.
+ */
+#define RID_RUN_COUNT 1
+
+/**
+ * Lateness Histogram: R, Multiple, Mandatory
+ * type: integer, range: N/A, unit: N/A
+ * Number of runs started with lateness falling into each bucket described by
+ * the Bucket Bounds resource.
+ */
+#define RID_LATENESS_HISTOGRAM 2
+
+/**
+ * Duration Histogram: R, Multiple, Mandatory
+ * type: integer, range: N/A, unit: N/A
+ * Number of runs whose execution time fell into each bucket described by
+ * the Bucket Bounds resource.
+ */
+#define RID_DURATION_HISTOGRAM 3
+
+/**
+ * Max Lateness: R, Single, Mandatory
+ * type: integer, range: N/A, unit: us
+ * Largest observed difference between the scheduled and actual start time.
+ */
+#define RID_MAX_LATENESS 4
+
+/**
+ * Max Duration: R, Single, Mandatory
+ * type: integer, range: N/A, unit: us
+ * Longest observed execution time of the job.
+ */
+#define RID_MAX_DURATION 5
+
+/**
+ * Bucket Bounds: R, Multiple, Mandatory
+ * type: integer, range: N/A, unit: us
+ * Exclusive upper bound of each histogram bucket, -1 for the last one.
+ */
+#define RID_BUCKET_BOUNDS 6
+
+/**
+ * Reset: E, Single, Optional
+ * type: N/A, range: N/A, unit: N/A
+ * Clears statistics of all jobs.
+ */
+#define RID_RESET 7
+
+typedef struct scheduler_stats_object_struct {
+    const anjay_dm_object_def_t *def;
+    size_t reported_jobs;
+} scheduler_stats_object_t;
+
+static inline scheduler_stats_object_t *
+get_obj(const anjay_dm_object_def_t *const *obj_ptr) {
+    assert(obj_ptr);
+    return AVS_CONTAINER_OF(obj_ptr, scheduler_stats_object_t, def);
+}
+
+static int list_instances(anjay_t *anjay,
+                          const anjay_dm_object_def_t *const *obj_ptr,
+                          anjay_dm_list_ctx_t *ctx) {
+    (void) anjay;
+
+    scheduler_stats_object_t *obj = get_obj(obj_ptr);
+    obj->reported_jobs = sched_stats_job_count();
+    for (anjay_iid_t iid = 0; iid < obj->reported_jobs; iid++) {
+        anjay_dm_emit(ctx, iid);
+    }
+    return 0;
+}
+
+static int list_resources(anjay_t *anjay,
+                          const anjay_dm_object_def_t *const *obj_ptr,
+                          anjay_iid_t iid,
+                          anjay_dm_resource_list_ctx_t *ctx) {
+    (void) anjay;
+    (void) obj_ptr;
+    (void) iid;
+
+    anjay_dm_emit_res(ctx, RID_JOB_NAME, ANJAY_DM_RES_R, ANJAY_DM_RES_PRESENT);
+    anjay_dm_emit_res(ctx, RID_RUN_COUNT, ANJAY_DM_RES_R, ANJAY_DM_RES_PRESENT);
+    anjay_dm_emit_res(ctx, RID_LATENESS_HISTOGRAM, ANJAY_DM_RES_RM,
+                      ANJAY_DM_RES_PRESENT);
+    anjay_dm_emit_res(ctx, RID_DURATION_HISTOGRAM, ANJAY_DM_RES_RM,
+                      ANJAY_DM_RES_PRESENT);
+    anjay_dm_emit_res(ctx, RID_MAX_LATENESS, ANJAY_DM_RES_R,
+                      ANJAY_DM_RES_PRESENT);
+    anjay_dm_emit_res(ctx, RID_MAX_DURATION, ANJAY_DM_RES_R,
+                      ANJAY_DM_RES_PRESENT);
+    anjay_dm_emit_res(ctx, RID_BUCKET_BOUNDS, ANJAY_DM_RES_RM,
+                      ANJAY_DM_RES_PRESENT);
+    anjay_dm_emit_res(ctx, RID_RESET, ANJAY_DM_RES_E, ANJAY_DM_RES_PRESENT);
+    return 0;
+}
+
+static int resource_read(anjay_t *anjay,
+                         const anjay_dm_object_def_t *const *obj_ptr,
+                         anjay_iid_t iid,
+                         anjay_rid_t rid,
+                         anjay_riid_t riid,
+                         anjay_output_ctx_t *ctx) {
+    (void) anjay;
+    (void) obj_ptr;
+
+    const sched_stats_job_t *job = sched_stats_get_job(iid);
+    if (!job) {
+        return ANJAY_ERR_NOT_FOUND;
+    }
+
+    switch (rid) {
+    case RID_JOB_NAME:
+        assert(riid == ANJAY_ID_INVALID);
+        return anjay_ret_string(ctx, job->name);
+
+    case RID_RUN_COUNT:
+        assert(riid == ANJAY_ID_INVALID);
+        return anjay_ret_i64(ctx, job->runs);
+
+    case RID_LATENESS_HISTOGRAM:
+        assert(riid < SCHED_STATS_BUCKETS);
+        return anjay_ret_i64(ctx, job->lateness_histogram[riid]);
+
+    case RID_DURATION_HISTOGRAM:
+        assert(riid < SCHED_STATS_BUCKETS);
+        return anjay_ret_i64(ctx, job->duration_histogram[riid]);
+
+    case RID_MAX_LATENESS:
+        assert(riid == ANJAY_ID_INVALID);
+        return anjay_ret_i64(ctx, job->max_lateness_us);
+
+    case RID_MAX_DURATION:
+        assert(riid == ANJAY_ID_INVALID);
+        return anjay_ret_i64(ctx, job->max_duration_us);
+
+    case RID_BUCKET_BOUNDS:
+        assert(riid < SCHED_STATS_BUCKETS);
+        return anjay_ret_i64(ctx, SCHED_STATS_BUCKET_BOUNDS_US[riid]);
+
+    default:
+        return ANJAY_ERR_METHOD_NOT_ALLOWED;
+    }
+}
+
+static int resource_execute(anjay_t *anjay,
+                            const anjay_dm_object_def_t *const *obj_ptr,
+                            anjay_iid_t iid,
+                            anjay_rid_t rid,
+                            anjay_execute_ctx_t *arg_ctx) {
+    (void) obj_ptr;
+    (void) iid;
+    (void) arg_ctx;
+
+    switch (rid) {
+    case RID_RESET:
+        sched_stats_reset();
+        anjay_notify_instances_changed(anjay, OID_SCHEDULER_STATS);
+        return 0;
+
+    default:
+        return ANJAY_ERR_METHOD_NOT_ALLOWED;
+    }
+}
+
+static int list_resource_instances(anjay_t *anjay,
+                                   const anjay_dm_object_def_t *const *obj_ptr,
+                                   anjay_iid_t iid,
+                                   anjay_rid_t rid,
+                                   anjay_dm_list_ctx_t *ctx) {
+    (void) anjay;
+    (void) obj_ptr;
+    (void) iid;
+
+    switch (rid) {
+    case RID_LATENESS_HISTOGRAM:
+    case RID_DURATION_HISTOGRAM:
+    case RID_BUCKET_BOUNDS:
+        for (anjay_riid_t riid = 0; riid < SCHED_STATS_BUCKETS; riid++) {
+            anjay_dm_emit(ctx, riid);
+        }
+        return 0;
+    default:
+        return ANJAY_ERR_METHOD_NOT_ALLOWED;
+    }
+}
+
+static const anjay_dm_object_def_t OBJ_DEF = {
+    .oid = OID_SCHEDULER_STATS,
+    .handlers = {
+        .list_instances = list_instances,
+
+        .list_resources = list_resources,
+        .resource_read = resource_read,
+        .resource_execute = resource_execute,
+        .list_resource_instances = list_resource_instances,
+
+        .transaction_begin = anjay_dm_transaction_NOOP,
+        .transaction_validate = anjay_dm_transaction_NOOP,
+        .transaction_commit = anjay_dm_transaction_NOOP,
+        .transaction_rollback = anjay_dm_transaction_NOOP
+    }
+};
+
+const anjay_dm_object_def_t **scheduler_stats_object_create(void) {
+    scheduler_stats_object_t *obj = (scheduler_stats_object_t *) avs_calloc(
+            1, sizeof(scheduler_stats_object_t));
+    if (!obj) {
+        return NULL;
+    }
+    obj->def = &OBJ_DEF;
+
+    return &obj->def;
+}
+
+void scheduler_stats_object_release(const anjay_dm_object_def_t **def) {
+    if (def) {
+        scheduler_stats_object_t *obj = get_obj(def);
+        avs_free(obj);
+    }
+}
+
+void scheduler_stats_object_update(anjay_t *anjay,
+                                   const anjay_dm_object_def_t *const *def) {
+    if (!anjay || !def) {
+        return;
+    }
+
+    // Jobs are tracked lazily, on their first registration, so new instances
+    // may appear at runtime
+    scheduler_stats_object_t *obj = get_obj(def);
+    if (obj->reported_jobs != sched_stats_job_count()) {
+        obj->reported_jobs = sched_stats_job_count();
+        anjay_notify_instances_changed(anjay, OID_SCHEDULER_STATS);
+    }
+}
@@ -15,23 +15,34 @@
  */
 
 #include <assert.h>
+#include <stdatomic.h>
 #include <stdbool.h>
 
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
 #include <anjay/anjay.h>
 #include <anjay/ipso_objects.h>
 
 #include <avsystem/commons/avs_defs.h>
 #include <avsystem/commons/avs_log.h>
 
+#include "lf_queue.h"
 #include "mpu6886.h"
 #include "objects/objects.h"
 #include "sdkconfig.h"
+#include "task_stats.h"
+#include "task_topology.h"
+
+#define SENSORS_ACQUISITION_PERIOD_MS 1000
+#define SENSORS_QUEUE_CAPACITY 8
 
 typedef struct {
     const char *name;
     const char *unit;
     anjay_oid_t oid;
     double data;
+    bool data_valid;
     int (*read_data)(void);
     void (*get_data)(double *sensor_data);
 } basic_sensor_context_t;
@@ -43,6 +54,7 @@ typedef struct {
     double min_value;
     double max_value;
     three_axis_sensor_data_t data;
+    bool data_valid;
     int (*read_data)(void);
     void (*get_data)(three_axis_sensor_data_t *sensor_data);
 } three_axis_sensor_context_t;
@@ -84,6 +96,142 @@ static basic_sensor_context_t BASIC_SENSORS_DEF[] = {
 #endif // CONFIG_ANJAY_CLIENT_TEMPERATURE_SENSOR_AVAILABLE
 };
 
+#ifdef CONFIG_ANJAY_CLIENT_WORKER_TASKS
+typedef struct {
+    bool three_axis;
+    int index;
+    union {
+        double basic;
+        three_axis_sensor_data_t three_axis;
+    } data;
+} sensor_sample_t;
+
+static lf_queue_t sample_queue;
+static TaskHandle_t acquisition_task_handle;
+static TaskHandle_t acquisition_stop_waiter;
+static atomic_bool acquisition_running;
+
+// Runs on the acquisition task: performs all I2C transfers and hands the
+// samples over to the Anjay task, which only ever touches the cached values.
+void sensors_read_data(void) {
+    sensor_sample_t sample;
+
+    for (int i = 0; i < (int) AVS_ARRAY_SIZE(BASIC_SENSORS_DEF); i++) {
+        basic_sensor_context_t *ctx = &BASIC_SENSORS_DEF[i];
+        if (!ctx->read_data()) {
+            sample.three_axis = false;
+            sample.index = i;
+            ctx->get_data(&sample.data.basic);
+            lf_queue_push(&sample_queue, &sample);
+        }
+    }
+    for (int i = 0; i < (int) AVS_ARRAY_SIZE(THREE_AXIS_SENSORS_DEF); i++) {
+        three_axis_sensor_context_t *ctx = &THREE_AXIS_SENSORS_DEF[i];
+        if (!ctx->read_data()) {
+            sample.three_axis = true;
+            sample.index = i;
+            ctx->get_data(&sample.data.three_axis);
+            lf_queue_push(&sample_queue, &sample);
+        }
+    }
+}
+
+static void acquisition_task(void *pvParameters) {
+    (void) pvParameters;
+
+    TickType_t last_wake = xTaskGetTickCount();
+    while (atomic_load(&acquisition_running)) {
+        sensors_read_data();
+        vTaskDelayUntil(&last_wake,
+                        pdMS_TO_TICKS(SENSORS_ACQUISITION_PERIOD_MS));
+    }
+    xTaskNotifyGive(acquisition_stop_waiter);
+    vTaskDelete(NULL);
+}
+
+static void drain_samples(void) {
+    sensor_sample_t sample;
+
+    while (!lf_queue_pop(&sample_queue, &sample)) {
+        if (sample.three_axis) {
+            THREE_AXIS_SENSORS_DEF[sample.index].data = sample.data.three_axis;
+            THREE_AXIS_SENSORS_DEF[sample.index].data_valid = true;
+        } else {
+            BASIC_SENSORS_DEF[sample.index].data = sample.data.basic;
+            BASIC_SENSORS_DEF[sample.index].data_valid = true;
+        }
+    }
+}
+
+static void start_acquisition(void) {
+    if (!AVS_ARRAY_SIZE(BASIC_SENSORS_DEF)
+            && !AVS_ARRAY_SIZE(THREE_AXIS_SENSORS_DEF)) {
+        return;
+    }
+    if (lf_queue_init(&sample_queue, "sensors", SENSORS_QUEUE_CAPACITY,
+                      sizeof(sensor_sample_t))) {
+        avs_log(ipso_object, WARNING, "Could not allocate sensor queue");
+        return;
+    }
+    atomic_store(&acquisition_running, true);
+    if (xTaskCreatePinnedToCore(acquisition_task, "acquisition_task",
+                                ACQUISITION_TASK_STACK_SIZE, NULL,
+                                ACQUISITION_TASK_PRIORITY,
+                                &acquisition_task_handle, WORKER_TASK_CORE_ID)
+            != pdPASS) {
+        avs_log(ipso_object, WARNING, "Could not create acquisition task");
+        atomic_store(&acquisition_running, false);
+        acquisition_task_handle = NULL;
+        lf_queue_release(&sample_queue);
+        return;
+    }
+    task_stats_register_queue(&sample_queue);
+}
+
+static void stop_acquisition(void) {
+    if (!acquisition_task_handle) {
+        return;
+    }
+    acquisition_stop_waiter = xTaskGetCurrentTaskHandle();
+    atomic_store(&acquisition_running, false);
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    acquisition_task_handle = NULL;
+    task_stats_unregister_queue(&sample_queue);
+    lf_queue_release(&sample_queue);
+}
+
+int basic_sensor_get_value(anjay_iid_t iid, void *_ctx, double *value) {
+    basic_sensor_context_t *ctx = (basic_sensor_context_t *) _ctx;
+
+    assert(value);
+
+    if (!ctx->data_valid) {
+        return -1;
+    }
+    *value = ctx->data;
+    return 0;
+}
+
+int three_axis_sensor_get_values(anjay_iid_t iid,
+                                 void *_ctx,
+                                 double *x_value,
+                                 double *y_value,
+                                 double *z_value) {
+    three_axis_sensor_context_t *ctx = (three_axis_sensor_context_t *) _ctx;
+
+    assert(x_value);
+    assert(y_value);
+    assert(z_value);
+
+    if (!ctx->data_valid) {
+        return -1;
+    }
+    *x_value = ctx->data.x_value;
+    *y_value = ctx->data.y_value;
+    *z_value = ctx->data.z_value;
+    return 0;
+}
+#else  // CONFIG_ANJAY_CLIENT_WORKER_TASKS
 int basic_sensor_get_value(anjay_iid_t iid, void *_ctx, double *value) {
     basic_sensor_context_t *ctx = (basic_sensor_context_t *) _ctx;
 
@@ -124,6 +272,8 @@ int three_axis_sensor_get_values(anjay_iid_t iid,
     }
 }
 
+#endif // CONFIG_ANJAY_CLIENT_WORKER_TASKS
+
 void sensors_install(anjay_t *anjay) {
 #if CONFIG_ANJAY_CLIENT_BOARD_M5STICKC_PLUS
     if (mpu6886_device_init()) {
@@ -192,9 +342,16 @@ void sensors_install(anjay_t *anjay) {
                     ctx->name);
         }
     }
+
+#ifdef CONFIG_ANJAY_CLIENT_WORKER_TASKS
+    start_acquisition();
+#endif // CONFIG_ANJAY_CLIENT_WORKER_TASKS
 }
 
 void sensors_update(anjay_t *anjay) {
+#ifdef CONFIG_ANJAY_CLIENT_WORKER_TASKS
+    drain_samples();
+#endif // CONFIG_ANJAY_CLIENT_WORKER_TASKS
     for (int i = 0; i < (int) AVS_ARRAY_SIZE(BASIC_SENSORS_DEF); i++) {
         anjay_ipso_basic_sensor_update(anjay, BASIC_SENSORS_DEF[i].oid, 0);
     }
@@ -204,6 +361,9 @@ void sensors_update(anjay_t *anjay) {
 }
 
 void sensors_release(void) {
+#ifdef CONFIG_ANJAY_CLIENT_WORKER_TASKS
+    stop_acquisition();
+#endif // CONFIG_ANJAY_CLIENT_WORKER_TASKS
 #if CONFIG_ANJAY_CLIENT_BOARD_M5STICKC_PLUS
     mpu6886_driver_release();
 #endif // CONFIG_ANJAY_CLIENT_BOARD_M5STICKC_PLUS
@@ -17,17 +17,23 @@
 #include <assert.h>
 #include <pthread.h>
 #include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
 
 #include <anjay/anjay.h>
 #include <avsystem/commons/avs_defs.h>
 #include <avsystem/commons/avs_log.h>
 #include <avsystem/commons/avs_memory.h>
 
-#include "nvs_flash.h"
-
+#include "../config_store.h"
+#include "../storage.h"
 #include "connect.h"
 #include "main.h"
 #include "objects.h"
+#include "sdkconfig.h"
+#ifdef CONFIG_ANJAY_WIFI_ROAMING
+#    include "../wifi_roaming.h"
+#endif // CONFIG_ANJAY_WIFI_ROAMING
 
 /**
  * Wlan connectivity object ID
@@ -106,16 +112,67 @@
  */
 #define RID_WPA_KEY_PHRASE 18
 
+#ifdef CONFIG_ANJAY_WIFI_ROAMING
+/*
+ * Vendor-specific resources below are not defined by OMA for this object;
+ * they expose what the background scan knows about each network.
+ */
+
+/**
+ * Signal Strength: R, Single, Optional
+ * type: integer, range: N/A, unit: dBm
+ * RSSI of the access point in use if the station is connected to this
+ * network, otherwise of the strongest one found by the last scan. Absent if
+ * neither is known.
+ */
+#    define RID_SIGNAL_STRENGTH 100
+
+/**
+ * Candidate BSSIDs: R, Multiple, Optional
+ * type: string, range: 12 bytes, unit: N/A
+ * Access points of this network found by the last scan, best first.
+ */
+#    define RID_CANDIDATE_BSSIDS 101
+
+/**
+ * Candidate Signal Strengths: R, Multiple, Optional
+ * type: integer, range: N/A, unit: dBm
+ * RSSI of the access points listed in Candidate BSSIDs, in the same order.
+ */
+#    define RID_CANDIDATE_SIGNAL_STRENGTHS 102
+#endif // CONFIG_ANJAY_WIFI_ROAMING
+
+/**
+ * Instances from ANJAY_WIFI_OBJ_ADDITIONAL_INSTANCE onwards are additional
+ * networks, writable by the server and used as roaming targets when enabled.
+ */
+#define WLAN_INSTANCES CONFIG_ANJAY_WIFI_NETWORKS
+
+#ifdef CONFIG_ANJAY_WIFI_ROAMING
+// Values of the resources that depend on scan results
+typedef struct {
+    bool signal_strength_present;
+    int8_t signal_strength;
+    size_t candidates_count;
+    uint8_t candidate_bssids[WIFI_ROAMING_MAX_CANDIDATES][6];
+    int8_t candidate_signal_strengths[WIFI_ROAMING_MAX_CANDIDATES];
+} wlan_scan_results_t;
+#endif // CONFIG_ANJAY_WIFI_ROAMING
+
 typedef struct wlan_connectivity_instance_struct {
     bool enable;
     bool enable_backup;
     wifi_config_t wifi_config;
     wifi_config_t wifi_config_backup;
+#ifdef CONFIG_ANJAY_WIFI_ROAMING
+    // As of the last wlan_object_scan_results_changed() call
+    wlan_scan_results_t reported_scan_results;
+#endif // CONFIG_ANJAY_WIFI_ROAMING
 } wlan_connectivity_instance_t;
 
 typedef struct wlan_connectivity_object_struct {
     const anjay_dm_object_def_t *def;
-    wlan_connectivity_instance_t instances[2];
+    wlan_connectivity_instance_t instances[WLAN_INSTANCES];
     bool writable_iface_failed;
 } wlan_connectivity_object_t;
 
@@ -125,6 +182,82 @@ get_obj(const anjay_dm_object_def_t *const *obj_ptr) {
     return AVS_CONTAINER_OF(obj_ptr, wlan_connectivity_object_t, def);
 }
 
+static bool is_server_writable(anjay_iid_t iid) {
+    return iid != ANJAY_WIFI_OBJ_PRECONFIGURED_INSTANCE;
+}
+
+static void get_instance_namespace(anjay_iid_t iid,
+                                   char *buf,
+                                   size_t buf_size) {
+    if (iid == ANJAY_WIFI_OBJ_WRITABLE_INSTANCE) {
+        snprintf(buf, buf_size, "%s", MAIN_NVS_WRITABLE_WIFI_CONFIG_NAMESPACE);
+    } else if (iid == ANJAY_WIFI_OBJ_PRECONFIGURED_INSTANCE) {
+        snprintf(buf, buf_size, "%s", MAIN_NVS_CONFIG_NAMESPACE);
+    } else {
+        snprintf(buf, buf_size, MAIN_NVS_ADDITIONAL_WIFI_CONFIG_NAMESPACE_FMT,
+                 (unsigned) iid);
+    }
+}
+
+static bool is_current_network(const wlan_connectivity_instance_t *inst,
+                               int8_t *out_rssi) {
+    wifi_ap_record_t ap_info;
+    if (!inst->wifi_config.sta.ssid[0]
+            || esp_wifi_sta_get_ap_info(&ap_info) != ESP_OK
+            || strncmp((const char *) ap_info.ssid,
+                       (const char *) inst->wifi_config.sta.ssid,
+                       sizeof(inst->wifi_config.sta.ssid))) {
+        return false;
+    }
+    if (out_rssi) {
+        *out_rssi = ap_info.rssi;
+    }
+    return true;
+}
+
+#ifdef CONFIG_ANJAY_WIFI_ROAMING
+static const wifi_roaming_candidate_t *
+get_candidate(const wlan_connectivity_instance_t *inst, anjay_riid_t riid) {
+    anjay_riid_t matching = 0;
+    const wifi_roaming_candidate_t *candidate;
+    for (size_t i = 0; (candidate = wifi_roaming_get_candidate(i)); i++) {
+        if (!strncmp(candidate->ssid, (const char *) inst->wifi_config.sta.ssid,
+                     sizeof(inst->wifi_config.sta.ssid))
+                && matching++ == riid) {
+            return candidate;
+        }
+    }
+    return NULL;
+}
+
+static bool get_signal_strength(const wlan_connectivity_instance_t *inst,
+                                int8_t *out_rssi) {
+    if (is_current_network(inst, out_rssi)) {
+        return true;
+    }
+    const wifi_roaming_candidate_t *best = get_candidate(inst, 0);
+    if (best) {
+        *out_rssi = best->rssi;
+    }
+    return best;
+}
+
+static void get_scan_results(const wlan_connectivity_instance_t *inst,
+                             wlan_scan_results_t *out) {
+    memset(out, 0, sizeof(*out));
+    out->signal_strength_present =
+            get_signal_strength(inst, &out->signal_strength);
+    const wifi_roaming_candidate_t *candidate;
+    for (anjay_riid_t riid = 0; (candidate = get_candidate(inst, riid));
+         riid++) {
+        memcpy(out->candidate_bssids[riid], candidate->bssid,
+               sizeof(out->candidate_bssids[riid]));
+        out->candidate_signal_strengths[riid] = candidate->rssi;
+        out->candidates_count++;
+    }
+}
+#endif // CONFIG_ANJAY_WIFI_ROAMING
+
 static int list_instances(anjay_t *anjay,
                           const anjay_dm_object_def_t *const *obj_ptr,
                           anjay_dm_list_ctx_t *ctx) {
@@ -144,12 +277,14 @@ static int instance_reset(anjay_t *anjay,
     wlan_connectivity_object_t *obj = get_obj(obj_ptr);
     assert(obj);
     assert(iid < AVS_ARRAY_SIZE(obj->instances));
-    if (iid == ANJAY_WIFI_OBJ_WRITABLE_INSTANCE) {
+    if (is_server_writable(iid)) {
         wlan_connectivity_instance_t *inst = &obj->instances[iid];
         inst->wifi_config.sta.ssid[0] = '\0';
         inst->wifi_config.sta.password[0] = '\0';
         inst->enable = false;
-        obj->writable_iface_failed = false;
+        if (iid == ANJAY_WIFI_OBJ_WRITABLE_INSTANCE) {
+            obj->writable_iface_failed = false;
+        }
     } else {
         return ANJAY_ERR_METHOD_NOT_ALLOWED;
     }
@@ -161,8 +296,16 @@ static int list_resources(anjay_t *anjay,
                           anjay_iid_t iid,
                           anjay_dm_resource_list_ctx_t *ctx) {
     (void) anjay;
-    (void) obj_ptr;
-    (void) iid;
+
+    wlan_connectivity_object_t *obj = get_obj(obj_ptr);
+    assert(obj);
+    assert(iid < AVS_ARRAY_SIZE(obj->instances));
+#ifdef CONFIG_ANJAY_WIFI_ROAMING
+    const wlan_connectivity_instance_t *inst = &obj->instances[iid];
+    int8_t rssi;
+#else  // CONFIG_ANJAY_WIFI_ROAMING
+    (void) obj;
+#endif // CONFIG_ANJAY_WIFI_ROAMING
 
     anjay_dm_emit_res(ctx, RID_INTERFACE_NAME, ANJAY_DM_RES_R,
                       ANJAY_DM_RES_PRESENT);
@@ -177,6 +320,15 @@ static int list_resources(anjay_t *anjay,
                       ANJAY_DM_RES_PRESENT);
     anjay_dm_emit_res(ctx, RID_WPA_KEY_PHRASE, ANJAY_DM_RES_W,
                       ANJAY_DM_RES_PRESENT);
+#ifdef CONFIG_ANJAY_WIFI_ROAMING
+    anjay_dm_emit_res(ctx, RID_SIGNAL_STRENGTH, ANJAY_DM_RES_R,
+                      get_signal_strength(inst, &rssi) ? ANJAY_DM_RES_PRESENT
+                                                       : ANJAY_DM_RES_ABSENT);
+    anjay_dm_emit_res(ctx, RID_CANDIDATE_BSSIDS, ANJAY_DM_RES_RM,
+                      ANJAY_DM_RES_PRESENT);
+    anjay_dm_emit_res(ctx, RID_CANDIDATE_SIGNAL_STRENGTHS, ANJAY_DM_RES_RM,
+                      ANJAY_DM_RES_PRESENT);
+#endif // CONFIG_ANJAY_WIFI_ROAMING
     return 0;
 }
 
@@ -195,10 +347,12 @@ static int resource_read(anjay_t *anjay,
     switch (rid) {
     case RID_INTERFACE_NAME: {
         assert(riid == ANJAY_ID_INVALID);
-        return anjay_ret_string(ctx,
-                                iid == ANJAY_WIFI_OBJ_WRITABLE_INSTANCE
-                                        ? "writable wlan config"
-                                        : "preconfigured fallback");
+        if (iid == ANJAY_WIFI_OBJ_WRITABLE_INSTANCE) {
+            return anjay_ret_string(ctx, "writable wlan config");
+        } else if (iid == ANJAY_WIFI_OBJ_PRECONFIGURED_INSTANCE) {
+            return anjay_ret_string(ctx, "preconfigured fallback");
+        }
+        return anjay_ret_string(ctx, "additional wlan config");
     }
 
     case RID_ENABLE: {
@@ -212,6 +366,8 @@ static int resource_read(anjay_t *anjay,
         if (iid == ANJAY_WIFI_OBJ_WRITABLE_INSTANCE
                 && obj->writable_iface_failed) {
             status = 2;
+        } else if (iid >= ANJAY_WIFI_OBJ_ADDITIONAL_INSTANCE) {
+            status = inst->enable && is_current_network(inst, NULL);
         } else {
             status = inst->enable;
         }
@@ -283,6 +439,38 @@ static int resource_read(anjay_t *anjay,
         return anjay_ret_i32(ctx, 1);
     }
 
+#ifdef CONFIG_ANJAY_WIFI_ROAMING
+    case RID_SIGNAL_STRENGTH: {
+        assert(riid == ANJAY_ID_INVALID);
+        int8_t rssi;
+        if (!get_signal_strength(inst, &rssi)) {
+            return ANJAY_ERR_NOT_FOUND;
+        }
+        return anjay_ret_i32(ctx, rssi);
+    }
+
+    case RID_CANDIDATE_BSSIDS: {
+        const wifi_roaming_candidate_t *candidate = get_candidate(inst, riid);
+        if (!candidate) {
+            return ANJAY_ERR_NOT_FOUND;
+        }
+        char bssid[12 + 1];
+        snprintf(bssid, sizeof(bssid), "%02X%02X%02X%02X%02X%02X",
+                 candidate->bssid[0], candidate->bssid[1], candidate->bssid[2],
+                 candidate->bssid[3], candidate->bssid[4],
+                 candidate->bssid[5]);
+        return anjay_ret_string(ctx, bssid);
+    }
+
+    case RID_CANDIDATE_SIGNAL_STRENGTHS: {
+        const wifi_roaming_candidate_t *candidate = get_candidate(inst, riid);
+        if (!candidate) {
+            return ANJAY_ERR_NOT_FOUND;
+        }
+        return anjay_ret_i32(ctx, candidate->rssi);
+    }
+#endif // CONFIG_ANJAY_WIFI_ROAMING
+
     default:
         return ANJAY_ERR_METHOD_NOT_ALLOWED;
     }
@@ -300,7 +488,7 @@ static int resource_write(anjay_t *anjay,
     assert(obj);
     assert(iid < AVS_ARRAY_SIZE(obj->instances));
     wlan_connectivity_instance_t *inst = &obj->instances[iid];
-    if (iid == ANJAY_WIFI_OBJ_WRITABLE_INSTANCE) {
+    if (is_server_writable(iid)) {
         switch (rid) {
         case RID_ENABLE: {
             assert(riid == ANJAY_ID_INVALID);
@@ -328,46 +516,31 @@ static int resource_write(anjay_t *anjay,
     }
 }
 
-static int nvs_write_u8(const char *namespace, const char *key, uint8_t val) {
-    nvs_handle_t nvs_h;
-    int result = 0;
-
-    avs_log(tutorial, INFO, "Opening Non-Volatile Storage (NVS) handle... ");
-    result = nvs_open(namespace, NVS_READWRITE, &nvs_h);
-    if (result != ESP_OK) {
-        avs_log(tutorial, ERROR, "Error (%s) opening NVS handle!",
-                esp_err_to_name(result));
-        return ANJAY_ERR_INTERNAL;
-    }
-
-    if (nvs_set_u8(nvs_h, key, val) != ESP_OK || nvs_commit(nvs_h) != ESP_OK) {
-        avs_log(tutorial, ERROR, "Error during saving new value in NVS");
-        result = ANJAY_ERR_INTERNAL;
-    }
-    nvs_close(nvs_h);
-    return result;
-}
-
-static int
-nvs_write_str(const char *namespace, const char *key, const char *val) {
-    nvs_handle_t nvs_h;
-    int result = 0;
+#ifdef CONFIG_ANJAY_WIFI_ROAMING
+static int list_resource_instances(anjay_t *anjay,
+                                   const anjay_dm_object_def_t *const *obj_ptr,
+                                   anjay_iid_t iid,
+                                   anjay_rid_t rid,
+                                   anjay_dm_list_ctx_t *ctx) {
+    (void) anjay;
 
-    avs_log(tutorial, INFO, "Opening Non-Volatile Storage (NVS) handle... ");
-    result = nvs_open(namespace, NVS_READWRITE, &nvs_h);
-    if (result != ESP_OK) {
-        avs_log(tutorial, ERROR, "Error (%s) opening NVS handle!",
-                esp_err_to_name(result));
-        return ANJAY_ERR_INTERNAL;
-    }
+    wlan_connectivity_object_t *obj = get_obj(obj_ptr);
+    assert(obj);
+    assert(iid < AVS_ARRAY_SIZE(obj->instances));
+    const wlan_connectivity_instance_t *inst = &obj->instances[iid];
 
-    if (nvs_set_str(nvs_h, key, val) != ESP_OK || nvs_commit(nvs_h) != ESP_OK) {
-        avs_log(tutorial, ERROR, "Error during saving new value in NVS");
-        result = ANJAY_ERR_INTERNAL;
+    switch (rid) {
+    case RID_CANDIDATE_BSSIDS:
+    case RID_CANDIDATE_SIGNAL_STRENGTHS:
+        for (anjay_riid_t riid = 0; get_candidate(inst, riid); riid++) {
+            anjay_dm_emit(ctx, riid);
+        }
+        return 0;
+    default:
+        return ANJAY_ERR_METHOD_NOT_ALLOWED;
     }
-    nvs_close(nvs_h);
-    return result;
 }
+#endif // CONFIG_ANJAY_WIFI_ROAMING
 
 static int transaction_begin(anjay_t *anjay,
                              const anjay_dm_object_def_t *const *obj_ptr) {
@@ -375,11 +548,11 @@ static int transaction_begin(anjay_t *anjay,
 
     wlan_connectivity_object_t *obj = get_obj(obj_ptr);
     assert(obj);
-    wlan_connectivity_instance_t *inst =
-            &obj->instances[ANJAY_WIFI_OBJ_WRITABLE_INSTANCE];
-
-    inst->wifi_config_backup = inst->wifi_config;
-    inst->enable_backup = inst->enable;
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(obj->instances); i++) {
+        wlan_connectivity_instance_t *inst = &obj->instances[i];
+        inst->wifi_config_backup = inst->wifi_config;
+        inst->enable_backup = inst->enable;
+    }
     return 0;
 }
 
@@ -389,50 +562,87 @@ static int transaction_rollback(anjay_t *anjay,
 
     wlan_connectivity_object_t *obj = get_obj(obj_ptr);
     assert(obj);
-    wlan_connectivity_instance_t *inst =
-            &obj->instances[ANJAY_WIFI_OBJ_WRITABLE_INSTANCE];
-
-    inst->wifi_config = inst->wifi_config_backup;
-    inst->enable = inst->enable_backup;
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(obj->instances); i++) {
+        wlan_connectivity_instance_t *inst = &obj->instances[i];
+        inst->wifi_config = inst->wifi_config_backup;
+        inst->enable = inst->enable_backup;
+    }
     return 0;
 }
 
-static int transaction_commit(anjay_t *anjay,
-                              const anjay_dm_object_def_t *const *obj_ptr) {
-    (void) anjay;
+/*
+ * Instances are stored as whole records. The preconfigured one holds
+ * provisioned settings and is never written; its Enable is always the opposite
+ * of the writable instance's and is restored from there at boot.
+ */
+static void save_instance(storage_txn_t *txn,
+                          anjay_iid_t iid,
+                          const wlan_connectivity_instance_t *inst) {
+    if (iid == ANJAY_WIFI_OBJ_PRECONFIGURED_INSTANCE) {
+        return;
+    }
 
-    wlan_connectivity_object_t *obj = get_obj(obj_ptr);
-    assert(obj);
-    wlan_connectivity_instance_t *inst =
-            &obj->instances[ANJAY_WIFI_OBJ_WRITABLE_INSTANCE];
+    config_store_wifi_t record = {
+        .enable = inst->enable
+    };
+    memcpy(record.ssid, inst->wifi_config.sta.ssid, sizeof(record.ssid));
+    memcpy(record.password, inst->wifi_config.sta.password,
+           sizeof(record.password));
+
+    char namespace[16];
+    get_instance_namespace(iid, namespace, sizeof(namespace));
+    config_store_save_wifi(txn, namespace, &record);
+}
+
+static bool is_instance_changed(const wlan_connectivity_instance_t *inst) {
+    return inst->enable != inst->enable_backup
+           || strcmp((char *) inst->wifi_config.sta.ssid,
+                     (char *) inst->wifi_config_backup.sta.ssid)
+           || strcmp((char *) inst->wifi_config.sta.password,
+                     (char *) inst->wifi_config_backup.sta.password);
+}
 
-    if (inst->enable != inst->enable_backup) {
+static void commit_writable_instance(storage_txn_t *txn,
+                                     wlan_connectivity_instance_t *inst) {
+    if (!is_instance_changed(inst)) {
+        return;
+    }
+    if (inst->enable || inst->enable != inst->enable_backup) {
         schedule_change_config();
-        nvs_write_u8(MAIN_NVS_WRITABLE_WIFI_CONFIG_NAMESPACE,
-                     MAIN_NVS_ENABLE_KEY, (uint8_t) inst->enable);
-        nvs_write_u8(MAIN_NVS_CONFIG_NAMESPACE, MAIN_NVS_ENABLE_KEY,
-                     (uint8_t) (!inst->enable));
     }
+    save_instance(txn, ANJAY_WIFI_OBJ_WRITABLE_INSTANCE, inst);
+}
 
-    if (strcmp((char *) inst->wifi_config.sta.ssid,
-               (char *) inst->wifi_config_backup.sta.ssid)) {
-        if (inst->enable) {
-            schedule_change_config();
-        }
-        nvs_write_str(MAIN_NVS_WRITABLE_WIFI_CONFIG_NAMESPACE,
-                      MAIN_NVS_WIFI_SSID_KEY,
-                      (char *) inst->wifi_config.sta.ssid);
+// Additional networks only become roaming targets, so changing them does not
+// trigger a reconnection
+static void commit_additional_instance(storage_txn_t *txn,
+                                       anjay_iid_t iid,
+                                       wlan_connectivity_instance_t *inst) {
+    if (is_instance_changed(inst)) {
+        save_instance(txn, iid, inst);
     }
+}
 
-    if (strcmp((char *) inst->wifi_config.sta.password,
-               (char *) inst->wifi_config_backup.sta.password)) {
-        if (inst->enable) {
-            schedule_change_config();
-        }
-        nvs_write_str(MAIN_NVS_WRITABLE_WIFI_CONFIG_NAMESPACE,
-                      MAIN_NVS_WIFI_PASSWORD_KEY,
-                      (char *) inst->wifi_config.sta.password);
+static int transaction_commit(anjay_t *anjay,
+                              const anjay_dm_object_def_t *const *obj_ptr) {
+    (void) anjay;
+
+    wlan_connectivity_object_t *obj = get_obj(obj_ptr);
+    assert(obj);
+
+    // All changes made by the transaction reach flash with one commit per
+    // NVS namespace; each instance is stored as a single record
+    storage_request_t writes[WLAN_INSTANCES];
+    storage_txn_t txn;
+    storage_txn_begin(&txn, writes, AVS_ARRAY_SIZE(writes));
+    commit_writable_instance(
+            &txn, &obj->instances[ANJAY_WIFI_OBJ_WRITABLE_INSTANCE]);
+    for (anjay_iid_t iid = ANJAY_WIFI_OBJ_ADDITIONAL_INSTANCE;
+         iid < AVS_ARRAY_SIZE(obj->instances);
+         iid++) {
+        commit_additional_instance(&txn, iid, &obj->instances[iid]);
     }
+    storage_txn_commit(&txn);
     return 0;
 }
 
@@ -445,6 +655,9 @@ static const anjay_dm_object_def_t OBJ_DEF = {
         .list_resources = list_resources,
         .resource_read = resource_read,
         .resource_write = resource_write,
+#ifdef CONFIG_ANJAY_WIFI_ROAMING
+        .list_resource_instances = list_resource_instances,
+#endif // CONFIG_ANJAY_WIFI_ROAMING
 
         .transaction_begin = transaction_begin,
         .transaction_validate = anjay_dm_transaction_NOOP,
@@ -505,13 +718,11 @@ wifi_config_t wlan_object_get_instance_wifi_config(
     return inst->wifi_config;
 }
 
-void wlan_object_set_instance_enable(
-        const anjay_t *anjay,
-        const anjay_dm_object_def_t *const *obj_ptr,
-        wifi_instance_t iid,
-        bool en) {
-    wlan_connectivity_object_t *obj = get_obj(obj_ptr);
-    assert(obj);
+static void set_instance_enable(const anjay_t *anjay,
+                                wlan_connectivity_object_t *obj,
+                                storage_txn_t *txn,
+                                wifi_instance_t iid,
+                                bool en) {
     assert(iid < AVS_ARRAY_SIZE(obj->instances));
     wlan_connectivity_instance_t *inst = &obj->instances[iid];
 
@@ -522,16 +733,44 @@ void wlan_object_set_instance_enable(
         anjay_notify_changed((anjay_t *) anjay, OID_WLAN_CONNECTIVITY, iid,
                              RID_STATUS);
 
-        if (iid == ANJAY_WIFI_OBJ_WRITABLE_INSTANCE) {
-            nvs_write_u8(MAIN_NVS_WRITABLE_WIFI_CONFIG_NAMESPACE,
-                         MAIN_NVS_ENABLE_KEY, (uint8_t) en);
-        } else {
-            nvs_write_u8(MAIN_NVS_CONFIG_NAMESPACE, MAIN_NVS_ENABLE_KEY,
-                         (uint8_t) en);
-        }
+        save_instance(txn, iid, inst);
     }
 }
 
+void wlan_object_set_instance_enable(
+        const anjay_t *anjay,
+        const anjay_dm_object_def_t *const *obj_ptr,
+        wifi_instance_t iid,
+        bool en) {
+    wlan_connectivity_object_t *obj = get_obj(obj_ptr);
+    assert(obj);
+
+    storage_request_t writes[1];
+    storage_txn_t txn;
+    storage_txn_begin(&txn, writes, AVS_ARRAY_SIZE(writes));
+    set_instance_enable(anjay, obj, &txn, iid, en);
+    storage_txn_commit(&txn);
+}
+
+void wlan_object_select_instance(const anjay_t *anjay,
+                                 const anjay_dm_object_def_t *const *obj_ptr,
+                                 wifi_instance_t iid) {
+    wlan_connectivity_object_t *obj = get_obj(obj_ptr);
+    assert(obj);
+    assert(iid == ANJAY_WIFI_OBJ_WRITABLE_INSTANCE
+           || iid == ANJAY_WIFI_OBJ_PRECONFIGURED_INSTANCE);
+
+    storage_request_t writes[2];
+    storage_txn_t txn;
+    storage_txn_begin(&txn, writes, AVS_ARRAY_SIZE(writes));
+    set_instance_enable(anjay, obj, &txn, ANJAY_WIFI_OBJ_WRITABLE_INSTANCE,
+                        iid == ANJAY_WIFI_OBJ_WRITABLE_INSTANCE);
+    set_instance_enable(anjay, obj, &txn,
+                        ANJAY_WIFI_OBJ_PRECONFIGURED_INSTANCE,
+                        iid == ANJAY_WIFI_OBJ_PRECONFIGURED_INSTANCE);
+    storage_txn_commit(&txn);
+}
+
 bool wlan_object_is_instance_enabled(
         const anjay_dm_object_def_t *const *obj_ptr, wifi_instance_t iid) {
     wlan_connectivity_object_t *obj = get_obj(obj_ptr);
@@ -554,3 +793,44 @@ void wlan_object_set_writable_iface_failed(
                              ANJAY_WIFI_OBJ_WRITABLE_INSTANCE, RID_STATUS);
     }
 }
+
+size_t wlan_object_instance_count(const anjay_dm_object_def_t *const *obj_ptr) {
+    wlan_connectivity_object_t *obj = get_obj(obj_ptr);
+    assert(obj);
+    return AVS_ARRAY_SIZE(obj->instances);
+}
+
+#ifdef CONFIG_ANJAY_WIFI_ROAMING
+void wlan_object_scan_results_changed(
+        anjay_t *anjay, const anjay_dm_object_def_t *const *obj_ptr) {
+    wlan_connectivity_object_t *obj = get_obj(obj_ptr);
+    assert(obj);
+    for (anjay_iid_t iid = 0; iid < AVS_ARRAY_SIZE(obj->instances); iid++) {
+        wlan_scan_results_t *reported =
+                &obj->instances[iid].reported_scan_results;
+        wlan_scan_results_t current;
+        get_scan_results(&obj->instances[iid], &current);
+
+        if (current.signal_strength_present
+                        != reported->signal_strength_present
+                || current.signal_strength != reported->signal_strength) {
+            anjay_notify_changed(anjay, OID_WLAN_CONNECTIVITY, iid,
+                                 RID_SIGNAL_STRENGTH);
+        }
+        if (current.candidates_count != reported->candidates_count
+                || memcmp(current.candidate_bssids, reported->candidate_bssids,
+                          sizeof(current.candidate_bssids))) {
+            anjay_notify_changed(anjay, OID_WLAN_CONNECTIVITY, iid,
+                                 RID_CANDIDATE_BSSIDS);
+        }
+        if (current.candidates_count != reported->candidates_count
+                || memcmp(current.candidate_signal_strengths,
+                          reported->candidate_signal_strengths,
+                          sizeof(current.candidate_signal_strengths))) {
+            anjay_notify_changed(anjay, OID_WLAN_CONNECTIVITY, iid,
+                                 RID_CANDIDATE_SIGNAL_STRENGTHS);
+        }
+        *reported = current;
+    }
+}
+#endif // CONFIG_ANJAY_WIFI_ROAMING
@@ -0,0 +1,274 @@
+/*
+ * Copyright 2021-2025 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <anjay/anjay.h>
+#include <avsystem/commons/avs_defs.h>
+#include <avsystem/commons/avs_memory.h>
+
+#include "../wifi_status.h"
+#include "objects.h"
+#include "sdkconfig.h"
+
+/**
+ * Connectivity Monitoring object ID
+ */
+#define OID_CONNECTIVITY_MONITORING 4
+
+/**
+ * Network Bearer: R, Single, Mandatory
+ * type: integer, range: N/A, unit: N/A
+ * Network bearer used for the current LwM2M communication session.
+ */
+#define RID_NETWORK_BEARER 0
+
+/**
+ * Available Network Bearer: R, Multiple, Mandatory
+ * type: integer, range: N/A, unit: N/A
+ * Current available network bearers.
+ */
+#define RID_AVAILABLE_NETWORK_BEARER 1
+
+/**
+ * Radio Signal Strength: R, Single, Mandatory
+ * type: integer, range: N/A, unit: dBm
+ * Average received signal strength; RSSI of the access point for WLAN.
+ */
+#define RID_RADIO_SIGNAL_STRENGTH 2
+
+/**
+ * Link Quality: R, Single, Optional
+ * type: integer, range: N/A, unit: N/A
+ * Received link quality; for WLAN, a 0-100 estimate derived from the RSSI.
+ */
+#define RID_LINK_QUALITY 3
+
+/**
+ * IP Addresses: R, Multiple, Mandatory
+ * type: string, range: N/A, unit: N/A
+ * IP addresses assigned to the connectivity interface.
+ */
+#define RID_IP_ADDRESSES 4
+
+/**
+ * Router IP Addresses: R, Multiple, Optional
+ * type: string, range: N/A, unit: N/A
+ * IP addresses of the next-hop routers.
+ */
+#define RID_ROUTER_IP_ADDRESSES 5
+
+// Network Bearer value defined by the object
+#define NETWORK_BEARER_WLAN 21
+
+// Resource Instance IDs of IP Addresses
+#define RIID_IPV4 0
+#define RIID_IPV6 1
+
+typedef struct connectivity_monitoring_object_struct {
+    const anjay_dm_object_def_t *def;
+    wifi_status_t reported;
+    // Radio Signal Strength as of the last notification
+    int8_t notified_rssi;
+} connectivity_monitoring_object_t;
+
+static inline connectivity_monitoring_object_t *
+get_obj(const anjay_dm_object_def_t *const *obj_ptr) {
+    assert(obj_ptr);
+    return AVS_CONTAINER_OF(obj_ptr, connectivity_monitoring_object_t, def);
+}
+
+static int32_t link_quality(int8_t rssi) {
+    // Linear between -100 dBm (unusable) and -50 dBm (excellent)
+    return AVS_MIN(AVS_MAX(2 * (rssi + 100), 0), 100);
+}
+
+static int list_resources(anjay_t *anjay,
+                          const anjay_dm_object_def_t *const *obj_ptr,
+                          anjay_iid_t iid,
+                          anjay_dm_resource_list_ctx_t *ctx) {
+    (void) anjay;
+    (void) iid;
+
+    const wifi_status_t *status = &get_obj(obj_ptr)->reported;
+
+    anjay_dm_emit_res(ctx, RID_NETWORK_BEARER, ANJAY_DM_RES_R,
+                      ANJAY_DM_RES_PRESENT);
+    anjay_dm_emit_res(ctx, RID_AVAILABLE_NETWORK_BEARER, ANJAY_DM_RES_RM,
+                      ANJAY_DM_RES_PRESENT);
+    anjay_dm_emit_res(ctx, RID_RADIO_SIGNAL_STRENGTH, ANJAY_DM_RES_R,
+                      ANJAY_DM_RES_PRESENT);
+    anjay_dm_emit_res(ctx, RID_LINK_QUALITY, ANJAY_DM_RES_R,
+                      status->associated ? ANJAY_DM_RES_PRESENT
+                                         : ANJAY_DM_RES_ABSENT);
+    anjay_dm_emit_res(ctx, RID_IP_ADDRESSES, ANJAY_DM_RES_RM,
+                      ANJAY_DM_RES_PRESENT);
+    anjay_dm_emit_res(ctx, RID_ROUTER_IP_ADDRESSES, ANJAY_DM_RES_RM,
+                      status->ipv4_gateway[0] ? ANJAY_DM_RES_PRESENT
+                                              : ANJAY_DM_RES_ABSENT);
+    return 0;
+}
+
+static int resource_read(anjay_t *anjay,
+                         const anjay_dm_object_def_t *const *obj_ptr,
+                         anjay_iid_t iid,
+                         anjay_rid_t rid,
+                         anjay_riid_t riid,
+                         anjay_output_ctx_t *ctx) {
+    (void) anjay;
+    (void) iid;
+
+    // Values are served from the cache kept up to date by Wi-Fi events and
+    // the RSSI sampler in connectivity_monitoring_object_update()
+    const wifi_status_t *status = &get_obj(obj_ptr)->reported;
+
+    switch (rid) {
+    case RID_NETWORK_BEARER:
+    case RID_AVAILABLE_NETWORK_BEARER:
+        assert(rid == RID_NETWORK_BEARER ? riid == ANJAY_ID_INVALID
+                                         : riid == 0);
+        return anjay_ret_i32(ctx, NETWORK_BEARER_WLAN);
+
+    case RID_RADIO_SIGNAL_STRENGTH:
+        assert(riid == ANJAY_ID_INVALID);
+        return anjay_ret_i32(ctx, status->associated ? status->rssi : 0);
+
+    case RID_LINK_QUALITY:
+        assert(riid == ANJAY_ID_INVALID);
+        return anjay_ret_i32(ctx, link_quality(status->rssi));
+
+    case RID_IP_ADDRESSES:
+        assert(riid == RIID_IPV4 || riid == RIID_IPV6);
+        return anjay_ret_string(ctx, riid == RIID_IPV4
+                                             ? status->ipv4_address
+                                             : status->ipv6_address);
+
+    case RID_ROUTER_IP_ADDRESSES:
+        assert(riid == 0);
+        return anjay_ret_string(ctx, status->ipv4_gateway);
+
+    default:
+        return ANJAY_ERR_METHOD_NOT_ALLOWED;
+    }
+}
+
+static int list_resource_instances(anjay_t *anjay,
+                                   const anjay_dm_object_def_t *const *obj_ptr,
+                                   anjay_iid_t iid,
+                                   anjay_rid_t rid,
+                                   anjay_dm_list_ctx_t *ctx) {
+    (void) anjay;
+    (void) iid;
+
+    const wifi_status_t *status = &get_obj(obj_ptr)->reported;
+
+    switch (rid) {
+    case RID_AVAILABLE_NETWORK_BEARER:
+        anjay_dm_emit(ctx, 0);
+        return 0;
+    case RID_IP_ADDRESSES:
+        if (status->ipv4_address[0]) {
+            anjay_dm_emit(ctx, RIID_IPV4);
+        }
+        if (status->ipv6_address[0]) {
+            anjay_dm_emit(ctx, RIID_IPV6);
+        }
+        return 0;
+    case RID_ROUTER_IP_ADDRESSES:
+        if (status->ipv4_gateway[0]) {
+            anjay_dm_emit(ctx, 0);
+        }
+        return 0;
+    default:
+        return ANJAY_ERR_METHOD_NOT_ALLOWED;
+    }
+}
+
+static const anjay_dm_object_def_t OBJ_DEF = {
+    .oid = OID_CONNECTIVITY_MONITORING,
+    .handlers = {
+        .list_instances = anjay_dm_list_instances_SINGLE,
+        .list_resources = list_resources,
+        .resource_read = resource_read,
+        .list_resource_instances = list_resource_instances
+    }
+};
+
+const anjay_dm_object_def_t **connectivity_monitoring_object_create(void) {
+    connectivity_monitoring_object_t *obj =
+            (connectivity_monitoring_object_t *) avs_calloc(
+                    1, sizeof(connectivity_monitoring_object_t));
+    if (!obj) {
+        return NULL;
+    }
+    obj->def = &OBJ_DEF;
+    wifi_status_get(&obj->reported);
+    obj->notified_rssi = obj->reported.rssi;
+
+    return &obj->def;
+}
+
+void connectivity_monitoring_object_release(
+        const anjay_dm_object_def_t **def) {
+    if (def) {
+        connectivity_monitoring_object_t *obj = get_obj(def);
+        avs_free(obj);
+    }
+}
+
+void connectivity_monitoring_object_update(
+        anjay_t *anjay, const anjay_dm_object_def_t *const *def) {
+    if (!anjay || !def || !wifi_status_refresh()) {
+        return;
+    }
+
+    connectivity_monitoring_object_t *obj = get_obj(def);
+    wifi_status_t status;
+    wifi_status_get(&status);
+    wifi_status_t *reported = &obj->reported;
+
+    if (reported->associated != status.associated
+            || !reported->ipv4_gateway[0] != !status.ipv4_gateway[0]) {
+        *reported = status;
+        obj->notified_rssi = status.rssi;
+        (void) anjay_notify_instances_changed(anjay,
+                                              OID_CONNECTIVITY_MONITORING);
+        return;
+    }
+    // Small RSSI fluctuations are not worth waking up the server for; reads
+    // still return the latest sample
+    if (abs(status.rssi - obj->notified_rssi)
+            >= CONFIG_ANJAY_WIFI_STATUS_RSSI_STEP) {
+        obj->notified_rssi = status.rssi;
+        (void) anjay_notify_changed(anjay, OID_CONNECTIVITY_MONITORING, 0,
+                                    RID_RADIO_SIGNAL_STRENGTH);
+        (void) anjay_notify_changed(anjay, OID_CONNECTIVITY_MONITORING, 0,
+                                    RID_LINK_QUALITY);
+    }
+    if (strcmp(reported->ipv4_address, status.ipv4_address)
+            || strcmp(reported->ipv6_address, status.ipv6_address)) {
+        (void) anjay_notify_changed(anjay, OID_CONNECTIVITY_MONITORING, 0,
+                                    RID_IP_ADDRESSES);
+    }
+    if (strcmp(reported->ipv4_gateway, status.ipv4_gateway)) {
+        (void) anjay_notify_changed(anjay, OID_CONNECTIVITY_MONITORING, 0,
+                                    RID_ROUTER_IP_ADDRESSES);
+    }
+    *reported = status;
+}
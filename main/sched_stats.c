@@ -0,0 +1,198 @@
+/*
+ * Copyright 2021-2025 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <inttypes.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <avsystem/commons/avs_defs.h>
+#include <avsystem/commons/avs_log.h>
+#include <avsystem/commons/avs_sched.h>
+#include <avsystem/commons/avs_time.h>
+
+#include "sched_stats.h"
+
+#define SCHED_STATS_MAX_ARGS_SIZE 16
+
+const int64_t SCHED_STATS_BUCKET_BOUNDS_US[SCHED_STATS_BUCKETS] = {
+    500,   1000,   2000,   5000,   10000,   20000,
+    50000, 100000, 200000, 500000, 1000000, -1
+};
+
+typedef struct {
+    sched_stats_job_t *job;
+    avs_sched_clb_t *clb;
+    avs_time_monotonic_t target;
+    union {
+        void *align;
+        uint8_t bytes[SCHED_STATS_MAX_ARGS_SIZE];
+    } args;
+} sched_stats_wrapper_args_t;
+
+static sched_stats_job_t jobs[SCHED_STATS_MAX_JOBS];
+static size_t jobs_count;
+
+static sched_stats_job_t *get_job(const char *name, avs_sched_clb_t *clb) {
+    for (size_t i = 0; i < jobs_count; i++) {
+        if (jobs[i].clb == clb) {
+            return &jobs[i];
+        }
+    }
+    if (jobs_count >= AVS_ARRAY_SIZE(jobs)) {
+        return NULL;
+    }
+    jobs[jobs_count].name = name;
+    jobs[jobs_count].clb = clb;
+    return &jobs[jobs_count++];
+}
+
+static size_t bucket_index(int64_t value_us) {
+    size_t i = 0;
+    while (i < SCHED_STATS_BUCKETS - 1
+           && value_us >= SCHED_STATS_BUCKET_BOUNDS_US[i]) {
+        i++;
+    }
+    return i;
+}
+
+static int64_t elapsed_us(avs_time_monotonic_t since,
+                          avs_time_monotonic_t until) {
+    int64_t result;
+    if (avs_time_duration_to_scalar(&result, AVS_TIME_US,
+                                    avs_time_monotonic_diff(until, since))) {
+        return 0;
+    }
+    return result < 0 ? 0 : result;
+}
+
+static void record(sched_stats_job_t *job,
+                   int64_t lateness_us,
+                   int64_t duration_us) {
+    job->runs++;
+    job->lateness_histogram[bucket_index(lateness_us)]++;
+    job->duration_histogram[bucket_index(duration_us)]++;
+    job->max_lateness_us = AVS_MAX(job->max_lateness_us, lateness_us);
+    job->max_duration_us = AVS_MAX(job->max_duration_us, duration_us);
+}
+
+static void wrapper_job(avs_sched_t *sched, const void *args_ptr) {
+    const sched_stats_wrapper_args_t *args =
+            (const sched_stats_wrapper_args_t *) args_ptr;
+    sched_stats_job_t *job = args->job;
+    avs_time_monotonic_t target = args->target;
+    avs_time_monotonic_t start = avs_time_monotonic_now();
+
+    args->clb(sched, args->args.bytes);
+
+    if (job) {
+        record(job, elapsed_us(target, start),
+               elapsed_us(start, avs_time_monotonic_now()));
+    }
+}
+
+int sched_stats_schedule(avs_sched_t *sched,
+                         avs_sched_handle_t *out_handle,
+                         const char *name,
+                         avs_time_duration_t delay,
+                         avs_sched_clb_t *clb,
+                         const void *clb_data,
+                         size_t clb_data_size) {
+    if (clb_data_size > SCHED_STATS_MAX_ARGS_SIZE) {
+        avs_log(sched_stats, ERROR, "Arguments of %s too large: %u B", name,
+                (unsigned) clb_data_size);
+        return -1;
+    }
+
+    sched_stats_wrapper_args_t args = {
+        .job = get_job(name, clb),
+        .clb = clb,
+        .target = avs_time_monotonic_add(avs_time_monotonic_now(), delay)
+    };
+    if (clb_data_size) {
+        memcpy(args.args.bytes, clb_data, clb_data_size);
+    }
+    return AVS_SCHED_AT(sched, out_handle, args.target, wrapper_job, &args,
+                        sizeof(args));
+}
+
+size_t sched_stats_job_count(void) {
+    return jobs_count;
+}
+
+const sched_stats_job_t *sched_stats_get_job(size_t index) {
+    return index < jobs_count ? &jobs[index] : NULL;
+}
+
+void sched_stats_reset(void) {
+    for (size_t i = 0; i < jobs_count; i++) {
+        const char *name = jobs[i].name;
+        avs_sched_clb_t *clb = jobs[i].clb;
+        memset(&jobs[i], 0, sizeof(jobs[i]));
+        jobs[i].name = name;
+        jobs[i].clb = clb;
+    }
+}
+
+static const char *percentile(char *buf,
+                              size_t buf_size,
+                              const uint32_t *histogram,
+                              uint32_t runs,
+                              uint32_t percent) {
+    uint64_t threshold = ((uint64_t) runs * percent + 99) / 100;
+    uint64_t cumulative = 0;
+    size_t i = 0;
+    for (; i < SCHED_STATS_BUCKETS - 1; i++) {
+        cumulative += histogram[i];
+        if (cumulative >= threshold) {
+            break;
+        }
+    }
+    if (i < SCHED_STATS_BUCKETS - 1) {
+        snprintf(buf, buf_size, "<%" PRId64 "us",
+                 SCHED_STATS_BUCKET_BOUNDS_US[i]);
+    } else {
+        snprintf(buf, buf_size, ">=%" PRId64 "us",
+                 SCHED_STATS_BUCKET_BOUNDS_US[i - 1]);
+    }
+    return buf;
+}
+
+void sched_stats_log(void) {
+    char bufs[4][16];
+
+    for (size_t i = 0; i < jobs_count; i++) {
+        const sched_stats_job_t *job = &jobs[i];
+        if (!job->runs) {
+            continue;
+        }
+        avs_log(sched_stats, INFO,
+                "%s: runs %" PRIu32 ", lateness p50 %s p99 %s max %" PRId64
+                "us, duration p50 %s p99 %s max %" PRId64 "us",
+                job->name, job->runs,
+                percentile(bufs[0], sizeof(bufs[0]), job->lateness_histogram,
+                           job->runs, 50),
+                percentile(bufs[1], sizeof(bufs[1]), job->lateness_histogram,
+                           job->runs, 99),
+                job->max_lateness_us,
+                percentile(bufs[2], sizeof(bufs[2]), job->duration_histogram,
+                           job->runs, 50),
+                percentile(bufs[3], sizeof(bufs[3]), job->duration_histogram,
+                           job->runs, 99),
+                job->max_duration_us);
+    }
+}
@@ -0,0 +1,76 @@
+/*
+ * Copyright 2021-2025 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SCHED_STATS_H
+#define SCHED_STATS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <avsystem/commons/avs_sched.h>
+
+#define SCHED_STATS_MAX_JOBS 8
+#define SCHED_STATS_BUCKETS 12
+
+typedef struct {
+    const char *name;
+    avs_sched_clb_t *clb;
+    uint32_t runs;
+    int64_t max_lateness_us;
+    int64_t max_duration_us;
+    uint32_t lateness_histogram[SCHED_STATS_BUCKETS];
+    uint32_t duration_histogram[SCHED_STATS_BUCKETS];
+} sched_stats_job_t;
+
+/**
+ * Upper bounds (exclusive, in microseconds) of the histogram buckets. The last
+ * bucket collects everything above the previous bound and its bound is -1.
+ */
+extern const int64_t SCHED_STATS_BUCKET_BOUNDS_US[SCHED_STATS_BUCKETS];
+
+/**
+ * Equivalents of AVS_SCHED_DELAYED() and AVS_SCHED_NOW() that additionally
+ * record how late the job started relative to its scheduled time and how long
+ * it ran. Statistics are kept per callback. Callback data is limited to
+ * 16 bytes; larger data makes scheduling fail.
+ */
+#define SCHED_STATS_DELAYED(Sched, OutHandle, Delay, Clb, ClbData, Size) \
+    sched_stats_schedule((Sched), (OutHandle), #Clb, (Delay), (Clb),     \
+                         (ClbData), (Size))
+
+#define SCHED_STATS_NOW(Sched, OutHandle, Clb, ClbData, Size)          \
+    SCHED_STATS_DELAYED((Sched), (OutHandle), AVS_TIME_DURATION_ZERO, \
+                        Clb, (ClbData), (Size))
+
+int sched_stats_schedule(avs_sched_t *sched,
+                         avs_sched_handle_t *out_handle,
+                         const char *name,
+                         avs_time_duration_t delay,
+                         avs_sched_clb_t *clb,
+                         const void *clb_data,
+                         size_t clb_data_size);
+
+size_t sched_stats_job_count(void);
+const sched_stats_job_t *sched_stats_get_job(size_t index);
+void sched_stats_reset(void);
+
+/**
+ * Logs a one-line summary (runs, p50/p99/max lateness, p50/p99/max duration)
+ * of every tracked job.
+ */
+void sched_stats_log(void);
+
+#endif // SCHED_STATS_H
@@ -0,0 +1,398 @@
+/*
+ * Copyright 2021-2025 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <nvs.h>
+
+#include <avsystem/commons/avs_defs.h>
+#include <avsystem/commons/avs_log.h>
+
+#include "lf_queue.h"
+#include "sdkconfig.h"
+#include "storage.h"
+#include "task_stats.h"
+#include "task_topology.h"
+
+#define STORAGE_QUEUE_CAPACITY 8
+
+static bool is_same_namespace(const storage_request_t *a,
+                              const storage_request_t *b) {
+    return !strcmp(a->namespace, b->namespace);
+}
+
+static esp_err_t set_value(nvs_handle_t nvs_h,
+                           const storage_request_t *request) {
+    switch (request->type) {
+    case STORAGE_TYPE_U8:
+        return nvs_set_u8(nvs_h, request->key, request->value.u8);
+    case STORAGE_TYPE_STR:
+        return nvs_set_str(nvs_h, request->key, request->value.str);
+    default:
+        return nvs_set_blob(nvs_h, request->key, request->value.blob.data,
+                            request->value.blob.size);
+    }
+}
+
+/*
+ * Writes all requests belonging to the namespace of requests[first] with a
+ * single handle and commit. Requests of other namespaces are left alone.
+ */
+static int write_namespace(const storage_request_t *requests,
+                           size_t count,
+                           size_t first) {
+    nvs_handle_t nvs_h;
+
+    esp_err_t err = nvs_open(requests[first].namespace, NVS_READWRITE, &nvs_h);
+    if (err != ESP_OK) {
+        avs_log(storage, ERROR, "Error (%s) opening NVS handle!",
+                esp_err_to_name(err));
+        return -1;
+    }
+
+    for (size_t i = first; err == ESP_OK && i < count; i++) {
+        if (is_same_namespace(&requests[i], &requests[first])) {
+            err = set_value(nvs_h, &requests[i]);
+        }
+    }
+    if (err == ESP_OK) {
+        err = nvs_commit(nvs_h);
+    }
+    nvs_close(nvs_h);
+
+    if (err != ESP_OK) {
+        avs_log(storage, ERROR, "Error during saving %s in NVS",
+                requests[first].namespace);
+        return -1;
+    }
+    return 0;
+}
+
+static int write_requests(const storage_request_t *requests, size_t count) {
+    int result = 0;
+    for (size_t i = 0; i < count; i++) {
+        bool written = false;
+        for (size_t j = 0; !written && j < i; j++) {
+            written = is_same_namespace(&requests[j], &requests[i]);
+        }
+        if (!written && write_namespace(requests, count, i)) {
+            result = -1;
+        }
+    }
+    return result;
+}
+
+#ifdef CONFIG_ANJAY_CLIENT_WORKER_TASKS
+#    define STORAGE_CACHE_CAPACITY 16
+// Continuous writes postpone flushing by at most this many debounce intervals
+#    define STORAGE_MAX_DEBOUNCE_INTERVALS 4
+// Writers include the esp_event and Anjay tasks, which must not stall for long
+#    define STORAGE_SUBMIT_TIMEOUT_MS 100
+
+static lf_queue_t request_queue;
+static TaskHandle_t storage_task_handle;
+static atomic_uint pending_requests;
+static atomic_bool flush_requested;
+
+// Dirty values not yet written to NVS, owned by the storage task
+static storage_request_t cache[STORAGE_CACHE_CAPACITY];
+static size_t cache_count;
+static size_t cached_requests;
+
+static void cache_flush(void) {
+    if (cache_count) {
+        write_requests(cache, cache_count);
+    }
+    atomic_fetch_sub(&pending_requests, cached_requests);
+    cache_count = 0;
+    cached_requests = 0;
+}
+
+// Writes the cache out early if a new key does not fit in it
+static void cache_put(const storage_request_t *request) {
+    for (size_t i = 0; i < cache_count; i++) {
+        if (is_same_namespace(&cache[i], request)
+                && !strcmp(cache[i].key, request->key)) {
+            cache[i] = *request;
+            cached_requests++;
+            return;
+        }
+    }
+    if (cache_count >= AVS_ARRAY_SIZE(cache)) {
+        cache_flush();
+    }
+    cache[cache_count++] = *request;
+    cached_requests++;
+}
+
+static void drain_queue(void) {
+    storage_request_t request;
+    while (!lf_queue_pop(&request_queue, &request)) {
+        cache_put(&request);
+    }
+}
+
+static void storage_task(void *pvParameters) {
+    (void) pvParameters;
+
+    const TickType_t debounce =
+            pdMS_TO_TICKS(CONFIG_ANJAY_CLIENT_STORAGE_FLUSH_DELAY);
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        drain_queue();
+
+        // Writes are held back until none arrive for the debounce interval,
+        // so a burst of configuration changes costs one commit per namespace
+        TickType_t first_write = xTaskGetTickCount();
+        while (!atomic_load(&flush_requested)
+               && xTaskGetTickCount() - first_write
+                          < STORAGE_MAX_DEBOUNCE_INTERVALS * debounce
+               && ulTaskNotifyTake(pdTRUE, debounce)) {
+            drain_queue();
+        }
+        drain_queue();
+        atomic_store(&flush_requested, false);
+        cache_flush();
+    }
+}
+
+int storage_init(void) {
+    if (storage_task_handle) {
+        return 0;
+    }
+    if (lf_queue_init(&request_queue, "storage", STORAGE_QUEUE_CAPACITY,
+                      sizeof(storage_request_t))) {
+        avs_log(storage, ERROR, "Could not allocate storage queue");
+        return -1;
+    }
+    if (xTaskCreatePinnedToCore(storage_task, "storage_task",
+                                STORAGE_TASK_STACK_SIZE, NULL,
+                                STORAGE_TASK_PRIORITY, &storage_task_handle,
+                                WORKER_TASK_CORE_ID)
+            != pdPASS) {
+        avs_log(storage, ERROR, "Could not create storage task");
+        lf_queue_release(&request_queue);
+        storage_task_handle = NULL;
+        return -1;
+    }
+    task_stats_register_queue(&request_queue);
+    return 0;
+}
+
+static int submit_requests(const storage_request_t *requests, size_t count) {
+    if (!storage_task_handle) {
+        return write_requests(requests, count);
+    }
+
+    // Writing synchronously could be overwritten by an older value still
+    // held in the cache, so wait for the storage task to make room. It drains
+    // the queue without touching flash unless the cache is full. Room for the
+    // whole group is awaited first, so that a timeout usually drops all of it.
+    const TickType_t start = xTaskGetTickCount();
+    const TickType_t timeout = pdMS_TO_TICKS(STORAGE_SUBMIT_TIMEOUT_MS);
+    while (lf_queue_capacity(&request_queue) - lf_queue_depth(&request_queue)
+                   < count
+           && xTaskGetTickCount() - start < timeout) {
+        xTaskNotifyGive(storage_task_handle);
+        vTaskDelay(1);
+    }
+
+    atomic_fetch_add(&pending_requests, count);
+    size_t queued = 0;
+    while (queued < count) {
+        if (!lf_queue_push(&request_queue, &requests[queued])) {
+            queued++;
+        } else if (xTaskGetTickCount() - start < timeout) {
+            xTaskNotifyGive(storage_task_handle);
+            vTaskDelay(1);
+        } else {
+            break;
+        }
+    }
+    atomic_fetch_sub(&pending_requests, count - queued);
+    // Notified once, so that the whole group is picked up at the same time
+    xTaskNotifyGive(storage_task_handle);
+
+    if (queued < count) {
+        avs_log(storage, ERROR, "Storage queue full, dropped %u of %u writes",
+                (unsigned) (count - queued), (unsigned) count);
+        return -1;
+    }
+    return 0;
+}
+
+void storage_flush(void) {
+    if (!storage_task_handle) {
+        return;
+    }
+    while (atomic_load(&pending_requests)) {
+        // Cut the debounce interval short
+        atomic_store(&flush_requested, true);
+        xTaskNotifyGive(storage_task_handle);
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+}
+#else  // CONFIG_ANJAY_CLIENT_WORKER_TASKS
+int storage_init(void) {
+    return 0;
+}
+
+static int submit_requests(const storage_request_t *requests, size_t count) {
+    return write_requests(requests, count);
+}
+
+void storage_flush(void) {}
+#endif // CONFIG_ANJAY_CLIENT_WORKER_TASKS
+
+static int init_request(storage_request_t *request,
+                        storage_type_t type,
+                        const char *namespace,
+                        const char *key) {
+    request->type = type;
+    if (snprintf(request->namespace, sizeof(request->namespace), "%s",
+                 namespace)
+                    >= (int) sizeof(request->namespace)
+            || snprintf(request->key, sizeof(request->key), "%s", key)
+                           >= (int) sizeof(request->key)) {
+        return -1;
+    }
+    return 0;
+}
+
+int storage_write_u8(const char *namespace, const char *key, uint8_t value) {
+    storage_request_t request;
+    if (init_request(&request, STORAGE_TYPE_U8, namespace, key)) {
+        return -1;
+    }
+    request.value.u8 = value;
+    return submit_requests(&request, 1);
+}
+
+int storage_write_str(const char *namespace,
+                      const char *key,
+                      const char *value) {
+    storage_request_t request;
+    if (init_request(&request, STORAGE_TYPE_STR, namespace, key)
+            || snprintf(request.value.str, sizeof(request.value.str), "%s",
+                        value)
+                           >= (int) sizeof(request.value.str)) {
+        return -1;
+    }
+    return submit_requests(&request, 1);
+}
+
+void storage_txn_begin(storage_txn_t *txn,
+                       storage_request_t *writes,
+                       size_t capacity) {
+    txn->writes = writes;
+    txn->capacity = capacity;
+    txn->count = 0;
+    txn->failed = false;
+}
+
+static storage_request_t *txn_stage(storage_txn_t *txn,
+                                    storage_type_t type,
+                                    const char *namespace,
+                                    const char *key) {
+    storage_request_t request;
+    if (init_request(&request, type, namespace, key)) {
+        txn->failed = true;
+        return NULL;
+    }
+    for (size_t i = 0; i < txn->count; i++) {
+        if (is_same_namespace(&txn->writes[i], &request)
+                && !strcmp(txn->writes[i].key, request.key)) {
+            txn->writes[i] = request;
+            return &txn->writes[i];
+        }
+    }
+    if (txn->count >= txn->capacity) {
+        avs_log(storage, ERROR, "Too many writes in a transaction");
+        txn->failed = true;
+        return NULL;
+    }
+    txn->writes[txn->count] = request;
+    return &txn->writes[txn->count++];
+}
+
+int storage_txn_write_u8(storage_txn_t *txn,
+                         const char *namespace,
+                         const char *key,
+                         uint8_t value) {
+    storage_request_t *request =
+            txn_stage(txn, STORAGE_TYPE_U8, namespace, key);
+    if (!request) {
+        return -1;
+    }
+    request->value.u8 = value;
+    return 0;
+}
+
+int storage_txn_write_str(storage_txn_t *txn,
+                          const char *namespace,
+                          const char *key,
+                          const char *value) {
+    if (strlen(value) >= STORAGE_MAX_STR_VALUE_SIZE) {
+        txn->failed = true;
+        return -1;
+    }
+    storage_request_t *request =
+            txn_stage(txn, STORAGE_TYPE_STR, namespace, key);
+    if (!request) {
+        return -1;
+    }
+    strcpy(request->value.str, value);
+    return 0;
+}
+
+int storage_txn_write_blob(storage_txn_t *txn,
+                           const char *namespace,
+                           const char *key,
+                           const void *data,
+                           size_t size) {
+    if (size > STORAGE_MAX_BLOB_SIZE) {
+        txn->failed = true;
+        return -1;
+    }
+    storage_request_t *request =
+            txn_stage(txn, STORAGE_TYPE_BLOB, namespace, key);
+    if (!request) {
+        return -1;
+    }
+    request->value.blob.size = (uint8_t) size;
+    memcpy(request->value.blob.data, data, size);
+    return 0;
+}
+
+int storage_txn_commit(storage_txn_t *txn) {
+    int result;
+    if (txn->failed) {
+        avs_log(storage, ERROR, "Transaction not committed");
+        result = -1;
+    } else {
+        result = txn->count ? submit_requests(txn->writes, txn->count) : 0;
+    }
+    txn->count = 0;
+    txn->failed = false;
+    return result;
+}
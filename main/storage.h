@@ -0,0 +1,122 @@
+/*
+ * Copyright 2021-2025 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef STORAGE_H
+#define STORAGE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <nvs.h>
+
+#define STORAGE_MAX_STR_VALUE_SIZE 65
+#define STORAGE_MAX_BLOB_SIZE 112
+
+typedef enum {
+    STORAGE_TYPE_U8,
+    STORAGE_TYPE_STR,
+    STORAGE_TYPE_BLOB
+} storage_type_t;
+
+typedef struct {
+    storage_type_t type;
+    char namespace[NVS_KEY_NAME_MAX_SIZE];
+    char key[NVS_KEY_NAME_MAX_SIZE];
+    union {
+        uint8_t u8;
+        char str[STORAGE_MAX_STR_VALUE_SIZE];
+        struct {
+            uint8_t size;
+            uint8_t data[STORAGE_MAX_BLOB_SIZE];
+        } blob;
+    } value;
+} storage_request_t;
+
+/**
+ * Writes staged for a single commit, e.g. all changes made by one data model
+ * transaction. Meant to be allocated on the stack, together with a buffer
+ * sized for the most writes the caller may stage.
+ */
+typedef struct {
+    storage_request_t *writes;
+    size_t capacity;
+    size_t count;
+    bool failed;
+} storage_txn_t;
+
+/**
+ * Starts the storage worker. Must be called after nvs_flash_init(). Without
+ * CONFIG_ANJAY_CLIENT_WORKER_TASKS all writes are performed synchronously.
+ *
+ * The worker keeps written values in RAM and flushes them to NVS once no new
+ * write arrived for CONFIG_ANJAY_CLIENT_STORAGE_FLUSH_DELAY milliseconds.
+ */
+int storage_init(void);
+
+/**
+ * Stores a value in NVS. With the storage worker running the write is only
+ * queued; if the queue is full, the caller waits for room for a short while
+ * and then gives up.
+ *
+ * @returns 0 if the value was written or queued, -1 otherwise.
+ */
+int storage_write_u8(const char *namespace, const char *key, uint8_t value);
+int storage_write_str(const char *namespace,
+                      const char *key,
+                      const char *value);
+
+void storage_txn_begin(storage_txn_t *txn,
+                       storage_request_t *writes,
+                       size_t capacity);
+
+/**
+ * Stage a write in @p txn. A later write of the same key replaces an earlier
+ * one. A write that does not fit in @p txn fails the whole transaction, so
+ * that storage_txn_commit() does not persist only a part of it.
+ *
+ * @returns 0 on success, -1 if the arguments are too long or @p txn is full.
+ */
+int storage_txn_write_u8(storage_txn_t *txn,
+                         const char *namespace,
+                         const char *key,
+                         uint8_t value);
+int storage_txn_write_str(storage_txn_t *txn,
+                          const char *namespace,
+                          const char *key,
+                          const char *value);
+int storage_txn_write_blob(storage_txn_t *txn,
+                           const char *namespace,
+                           const char *key,
+                           const void *data,
+                           size_t size);
+
+/**
+ * Persists all writes staged in @p txn, opening and committing each NVS
+ * namespace only once. Queued like single writes when the storage worker is
+ * running. Nothing is written if staging any of the writes failed.
+ *
+ * @returns 0 if the writes were performed or queued, -1 otherwise.
+ */
+int storage_txn_commit(storage_txn_t *txn);
+
+/**
+ * Blocks until every queued or cached write has reached flash, without waiting
+ * for the flush delay to pass. Call before rebooting.
+ */
+void storage_flush(void);
+
+#endif // STORAGE_H
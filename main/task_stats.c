@@ -0,0 +1,147 @@
+/*
+ * Copyright 2021-2025 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <inttypes.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <avsystem/commons/avs_defs.h>
+#include <avsystem/commons/avs_log.h>
+#include <avsystem/commons/avs_memory.h>
+
+#include "lf_queue.h"
+#include "sdkconfig.h"
+#include "task_stats.h"
+
+#define TASK_STATS_MAX_QUEUES 8
+#define TASK_STATS_MAX_TASKS 32
+
+static const lf_queue_t *_Atomic registered_queues[TASK_STATS_MAX_QUEUES];
+
+int task_stats_register_queue(const lf_queue_t *queue) {
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(registered_queues); i++) {
+        const lf_queue_t *expected = NULL;
+        if (atomic_compare_exchange_strong(&registered_queues[i], &expected,
+                                           queue)) {
+            return 0;
+        }
+    }
+    return -1;
+}
+
+void task_stats_unregister_queue(const lf_queue_t *queue) {
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(registered_queues); i++) {
+        const lf_queue_t *expected = queue;
+        atomic_compare_exchange_strong(&registered_queues[i], &expected, NULL);
+    }
+}
+
+#if defined(CONFIG_FREERTOS_USE_TRACE_FACILITY) \
+        && defined(CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS)
+#    ifdef configRUN_TIME_COUNTER_TYPE
+typedef configRUN_TIME_COUNTER_TYPE run_time_counter_t;
+#    else
+typedef uint32_t run_time_counter_t;
+#    endif // configRUN_TIME_COUNTER_TYPE
+
+typedef struct {
+    TaskHandle_t handle;
+    run_time_counter_t run_time;
+} task_run_time_t;
+
+static task_run_time_t prev_run_times[TASK_STATS_MAX_TASKS];
+static run_time_counter_t prev_total_run_time;
+
+static run_time_counter_t get_prev_run_time(TaskHandle_t handle) {
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(prev_run_times); i++) {
+        if (prev_run_times[i].handle == handle) {
+            return prev_run_times[i].run_time;
+        }
+    }
+    return 0;
+}
+
+static void log_cpu_load(void) {
+    UBaseType_t count = uxTaskGetNumberOfTasks();
+    TaskStatus_t *statuses =
+            (TaskStatus_t *) avs_malloc(count * sizeof(TaskStatus_t));
+    if (!statuses) {
+        avs_log(task_stats, WARNING, "Out of memory, CPU load not reported");
+        return;
+    }
+
+    run_time_counter_t total_run_time;
+    count = uxTaskGetSystemState(statuses, count, &total_run_time);
+    run_time_counter_t elapsed = total_run_time - prev_total_run_time;
+
+    for (UBaseType_t i = 0; i < count && elapsed; i++) {
+        run_time_counter_t task_elapsed =
+                statuses[i].ulRunTimeCounter
+                - get_prev_run_time(statuses[i].xHandle);
+        int core = -1;
+#    ifdef CONFIG_FREERTOS_VTASKLIST_INCLUDE_COREID
+        core = statuses[i].xCoreID == tskNO_AFFINITY
+                       ? -1
+                       : (int) statuses[i].xCoreID;
+#    endif // CONFIG_FREERTOS_VTASKLIST_INCLUDE_COREID
+        avs_log(task_stats, INFO,
+                "task %-16s core %2d load %3" PRIu32
+                "%% stack free %" PRIu32,
+                statuses[i].pcTaskName, core,
+                (uint32_t) ((uint64_t) task_elapsed * 100 / elapsed),
+                (uint32_t) statuses[i].usStackHighWaterMark);
+    }
+
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(prev_run_times); i++) {
+        prev_run_times[i] = (task_run_time_t) {
+            .handle = i < count ? statuses[i].xHandle : NULL,
+            .run_time = i < count ? statuses[i].ulRunTimeCounter : 0
+        };
+    }
+    prev_total_run_time = total_run_time;
+    avs_free(statuses);
+}
+#else  // defined(CONFIG_FREERTOS_USE_TRACE_FACILITY) &&
+       // defined(CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS)
+static void log_cpu_load(void) {}
+#endif // defined(CONFIG_FREERTOS_USE_TRACE_FACILITY) &&
+       // defined(CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS)
+
+static void log_queues(void) {
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(registered_queues); i++) {
+        const lf_queue_t *queue = atomic_load(&registered_queues[i]);
+        if (!queue) {
+            continue;
+        }
+        avs_log(task_stats, INFO,
+                "queue %-12s depth %u/%u high watermark %u dropped %" PRIu32,
+                queue->name, (unsigned) lf_queue_depth(queue),
+                (unsigned) lf_queue_capacity(queue),
+                (unsigned) atomic_load(
+                        (atomic_size_t *) &queue->high_watermark),
+                (uint32_t) atomic_load(
+                        (atomic_uint_fast32_t *) &queue->dropped));
+    }
+}
+
+void task_stats_log(void) {
+    log_cpu_load();
+    log_queues();
+}
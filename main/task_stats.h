@@ -0,0 +1,35 @@
+/*
+ * Copyright 2021-2025 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TASK_STATS_H
+#define TASK_STATS_H
+
+#include "lf_queue.h"
+
+/**
+ * Adds a queue to the periodic statistics report. The queue must stay valid
+ * until @ref task_stats_unregister_queue is called.
+ */
+int task_stats_register_queue(const lf_queue_t *queue);
+void task_stats_unregister_queue(const lf_queue_t *queue);
+
+/**
+ * Logs CPU load of every task since the previous call, together with the
+ * current depth, high watermark and drop count of all registered queues.
+ */
+void task_stats_log(void);
+
+#endif // TASK_STATS_H
@@ -0,0 +1,47 @@
+/*
+ * Copyright 2021-2025 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TASK_TOPOLOGY_H
+#define TASK_TOPOLOGY_H
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include "sdkconfig.h"
+
+// Anjay, together with the network stack, owns core 0. Sensor acquisition,
+// LCD drawing and NVS writes are moved to core 1 so that they never delay
+// CoAP processing.
+#ifdef CONFIG_ANJAY_CLIENT_WORKER_TASKS
+#    define ANJAY_TASK_CORE_ID 0
+#    define WORKER_TASK_CORE_ID 1
+#else
+#    define ANJAY_TASK_CORE_ID tskNO_AFFINITY
+#endif // CONFIG_ANJAY_CLIENT_WORKER_TASKS
+
+#define ANJAY_TASK_STACK_SIZE 16384
+#define ANJAY_TASK_PRIORITY 5
+
+#define ACQUISITION_TASK_STACK_SIZE 3072
+#define ACQUISITION_TASK_PRIORITY 4
+
+#define DISPLAY_TASK_STACK_SIZE 4096
+#define DISPLAY_TASK_PRIORITY 3
+
+#define STORAGE_TASK_STACK_SIZE 3072
+#define STORAGE_TASK_PRIORITY 1
+
+#endif // TASK_TOPOLOGY_H
@@ -0,0 +1,247 @@
+/*
+ * Copyright 2021-2025 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <inttypes.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <esp_event.h>
+#include <esp_timer.h>
+#include <esp_wifi.h>
+
+#include <avsystem/commons/avs_defs.h>
+#include <avsystem/commons/avs_log.h>
+
+#include "wifi_roaming.h"
+
+#define WIFI_ROAMING_HISTORY_SIZE 8
+
+// WIFI_EVENT_SCAN_DONE is not posted for every aborted scan, so a scan that
+// has not finished by then is considered lost
+#define WIFI_ROAMING_SCAN_TIMEOUT_US (10 * 1000 * 1000)
+
+// Score adjustments, in dB
+#define WIFI_ROAMING_SUCCESS_BONUS 2
+#define WIFI_ROAMING_MAX_SUCCESS_BONUS 6
+#define WIFI_ROAMING_FAILURE_PENALTY 10
+
+typedef struct {
+    uint8_t bssid[6];
+    uint8_t successes;
+    uint8_t failures;
+} wifi_roaming_history_t;
+
+typedef struct {
+    uint32_t scans;
+    uint32_t failed_scans;
+    uint32_t successful_roams;
+    uint32_t failed_roams;
+} wifi_roaming_stats_t;
+
+static void (*scan_done_cb)(void);
+
+// Filled by the event loop task and consumed by wifi_roaming_rank(); the flag
+// hands the buffer over between them
+static wifi_roaming_candidate_t scan_results[WIFI_ROAMING_MAX_CANDIDATES];
+static size_t scan_results_count;
+static atomic_bool scan_results_ready;
+static atomic_bool scan_in_progress;
+static int64_t scan_started_us;
+
+static wifi_roaming_candidate_t candidates[WIFI_ROAMING_MAX_CANDIDATES];
+static size_t candidates_count;
+static wifi_roaming_history_t history[WIFI_ROAMING_HISTORY_SIZE];
+static size_t history_next;
+static wifi_roaming_stats_t stats;
+
+static void on_scan_done(void *arg,
+                         esp_event_base_t event_base,
+                         int32_t event_id,
+                         void *event_data) {
+    const wifi_event_sta_scan_done_t *event =
+            (const wifi_event_sta_scan_done_t *) event_data;
+    if (!atomic_load(&scan_in_progress)) {
+        // scan started by someone else
+        return;
+    }
+    atomic_store(&scan_in_progress, false);
+
+    if (event->status || atomic_load(&scan_results_ready)) {
+        // failed, or the previous results have not been consumed yet
+        esp_wifi_clear_ap_list();
+        stats.failed_scans++;
+        return;
+    }
+
+    wifi_ap_record_t record;
+    scan_results_count = 0;
+    // Records come sorted by RSSI, so the strongest ones are kept
+    while (scan_results_count < AVS_ARRAY_SIZE(scan_results)
+           && esp_wifi_scan_get_ap_record(&record) == ESP_OK) {
+        wifi_roaming_candidate_t *result = &scan_results[scan_results_count++];
+        snprintf(result->ssid, sizeof(result->ssid), "%.*s",
+                 (int) sizeof(record.ssid), (const char *) record.ssid);
+        memcpy(result->bssid, record.bssid, sizeof(result->bssid));
+        result->channel = record.primary;
+        result->rssi = record.rssi;
+    }
+    esp_wifi_clear_ap_list();
+    stats.scans++;
+    atomic_store(&scan_results_ready, true);
+
+    if (scan_done_cb) {
+        scan_done_cb();
+    }
+}
+
+// Stopping the station aborts a pending scan
+static void on_sta_stop(void *arg,
+                        esp_event_base_t event_base,
+                        int32_t event_id,
+                        void *event_data) {
+    atomic_store(&scan_in_progress, false);
+}
+
+int wifi_roaming_init(void (*scan_done)(void)) {
+    scan_done_cb = scan_done;
+    if (esp_event_handler_register(WIFI_EVENT, WIFI_EVENT_SCAN_DONE,
+                                   &on_scan_done, NULL)
+            || esp_event_handler_register(WIFI_EVENT, WIFI_EVENT_STA_STOP,
+                                          &on_sta_stop, NULL)) {
+        avs_log(wifi_roaming, ERROR, "Could not register scan handler");
+        wifi_roaming_cleanup();
+        return -1;
+    }
+    return 0;
+}
+
+void wifi_roaming_cleanup(void) {
+    esp_event_handler_unregister(WIFI_EVENT, WIFI_EVENT_SCAN_DONE,
+                                 &on_scan_done);
+    esp_event_handler_unregister(WIFI_EVENT, WIFI_EVENT_STA_STOP,
+                                 &on_sta_stop);
+    scan_done_cb = NULL;
+}
+
+int wifi_roaming_scan_start(void) {
+    int64_t now_us = esp_timer_get_time();
+    if (atomic_exchange(&scan_in_progress, true)) {
+        if (now_us - scan_started_us < WIFI_ROAMING_SCAN_TIMEOUT_US) {
+            return -1;
+        }
+        avs_log(wifi_roaming, DEBUG, "Previous scan did not finish");
+        stats.failed_scans++;
+    }
+    scan_started_us = now_us;
+    const wifi_scan_config_t config = {
+        .scan_type = WIFI_SCAN_TYPE_ACTIVE
+    };
+    esp_err_t err = esp_wifi_scan_start(&config, false);
+    if (err != ESP_OK) {
+        atomic_store(&scan_in_progress, false);
+        avs_log(wifi_roaming, DEBUG, "Could not start scan: %s",
+                esp_err_to_name(err));
+        stats.failed_scans++;
+        return -1;
+    }
+    return 0;
+}
+
+static wifi_roaming_history_t *find_history(const uint8_t *bssid) {
+    for (size_t i = 0; i < AVS_ARRAY_SIZE(history); i++) {
+        if (!memcmp(history[i].bssid, bssid, sizeof(history[i].bssid))) {
+            return &history[i];
+        }
+    }
+    return NULL;
+}
+
+int wifi_roaming_score(const uint8_t *bssid, int8_t rssi) {
+    int score = rssi;
+    const wifi_roaming_history_t *entry = find_history(bssid);
+    if (entry) {
+        score += AVS_MIN(entry->successes * WIFI_ROAMING_SUCCESS_BONUS,
+                         WIFI_ROAMING_MAX_SUCCESS_BONUS);
+        score -= entry->failures * WIFI_ROAMING_FAILURE_PENALTY;
+    }
+    return score;
+}
+
+size_t wifi_roaming_rank(wifi_roaming_filter_t *filter, void *arg) {
+    if (!atomic_load(&scan_results_ready)) {
+        return candidates_count;
+    }
+
+    candidates_count = 0;
+    for (size_t i = 0; i < scan_results_count; i++) {
+        wifi_roaming_candidate_t candidate = scan_results[i];
+        if (!filter(candidate.ssid, arg)) {
+            continue;
+        }
+        candidate.score = wifi_roaming_score(candidate.bssid, candidate.rssi);
+
+        size_t pos = candidates_count++;
+        while (pos > 0 && candidates[pos - 1].score < candidate.score) {
+            candidates[pos] = candidates[pos - 1];
+            pos--;
+        }
+        candidates[pos] = candidate;
+    }
+    atomic_store(&scan_results_ready, false);
+    return candidates_count;
+}
+
+size_t wifi_roaming_candidates_count(void) {
+    return candidates_count;
+}
+
+const wifi_roaming_candidate_t *wifi_roaming_get_candidate(size_t index) {
+    return index < candidates_count ? &candidates[index] : NULL;
+}
+
+void wifi_roaming_record_result(const uint8_t *bssid, bool success) {
+    wifi_roaming_history_t *entry = find_history(bssid);
+    if (!entry) {
+        entry = &history[history_next];
+        history_next = (history_next + 1) % AVS_ARRAY_SIZE(history);
+        memset(entry, 0, sizeof(*entry));
+        memcpy(entry->bssid, bssid, sizeof(entry->bssid));
+    }
+    if (success) {
+        if (entry->successes < UINT8_MAX) {
+            entry->successes++;
+        }
+        entry->failures = 0;
+        stats.successful_roams++;
+    } else {
+        if (entry->failures < UINT8_MAX) {
+            entry->failures++;
+        }
+        stats.failed_roams++;
+    }
+}
+
+void wifi_roaming_log_stats(void) {
+    avs_log(wifi_roaming, INFO,
+            "scans %" PRIu32 " (%" PRIu32 " failed), roams %" PRIu32
+            " (%" PRIu32 " failed), %u candidates",
+            stats.scans, stats.failed_scans, stats.successful_roams,
+            stats.failed_roams, (unsigned) candidates_count);
+}
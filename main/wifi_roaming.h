@@ -0,0 +1,83 @@
+/*
+ * Copyright 2021-2025 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef WIFI_ROAMING_H
+#define WIFI_ROAMING_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <esp_wifi_types.h>
+
+#define WIFI_ROAMING_MAX_CANDIDATES 16
+
+/**
+ * Access point found by the background scan, with its score: the RSSI
+ * adjusted by how connections to it have gone so far.
+ */
+typedef struct {
+    char ssid[sizeof(((wifi_ap_record_t *) NULL)->ssid) + 1];
+    uint8_t bssid[6];
+    uint8_t channel;
+    int8_t rssi;
+    int score;
+} wifi_roaming_candidate_t;
+
+typedef bool wifi_roaming_filter_t(const char *ssid, void *arg);
+
+/**
+ * Installs the scan completion handler. @p scan_done is called from the
+ * default event loop task after each scan started with
+ * @ref wifi_roaming_scan_start; the results are then available to
+ * @ref wifi_roaming_rank.
+ */
+int wifi_roaming_init(void (*scan_done)(void));
+void wifi_roaming_cleanup(void);
+
+/**
+ * Starts a background scan without waiting for it. Fails if the station is
+ * busy connecting or another scan is in progress.
+ */
+int wifi_roaming_scan_start(void);
+
+/**
+ * Replaces the candidate list with the access points of the last finished
+ * scan accepted by @p filter, best first. Does nothing if no new results
+ * have arrived since the previous call.
+ *
+ * @returns Number of candidates.
+ */
+size_t wifi_roaming_rank(wifi_roaming_filter_t *filter, void *arg);
+
+size_t wifi_roaming_candidates_count(void);
+const wifi_roaming_candidate_t *wifi_roaming_get_candidate(size_t index);
+
+/**
+ * Score of the given access point as it would be ranked by
+ * @ref wifi_roaming_rank.
+ */
+int wifi_roaming_score(const uint8_t *bssid, int8_t rssi);
+
+/**
+ * Records the outcome of a connection to @p bssid, which affects its score in
+ * subsequent rankings.
+ */
+void wifi_roaming_record_result(const uint8_t *bssid, bool success);
+
+void wifi_roaming_log_stats(void);
+
+#endif // WIFI_ROAMING_H
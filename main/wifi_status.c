@@ -0,0 +1,123 @@
+/*
+ * Copyright 2021-2025 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <freertos/FreeRTOS.h>
+
+#include <esp_netif.h>
+#include <esp_wifi.h>
+
+#include <avsystem/commons/avs_time.h>
+
+#include "sdkconfig.h"
+#include "wifi_status.h"
+
+// Written by the event loop task and the Anjay task, read by the latter
+static portMUX_TYPE status_lock = portMUX_INITIALIZER_UNLOCKED;
+static wifi_status_t status;
+static bool changed;
+static bool rssi_sample_requested;
+static avs_time_monotonic_t last_rssi_sample;
+
+void wifi_status_get(wifi_status_t *out_status) {
+    taskENTER_CRITICAL(&status_lock);
+    *out_status = status;
+    taskEXIT_CRITICAL(&status_lock);
+}
+
+static bool rssi_sample_due(void) {
+    taskENTER_CRITICAL(&status_lock);
+    bool requested = rssi_sample_requested;
+    rssi_sample_requested = false;
+    taskEXIT_CRITICAL(&status_lock);
+
+    return requested
+           || avs_time_duration_less(
+                      avs_time_duration_from_scalar(
+                              CONFIG_ANJAY_WIFI_STATUS_RSSI_INTERVAL,
+                              AVS_TIME_S),
+                      avs_time_monotonic_diff(avs_time_monotonic_now(),
+                                              last_rssi_sample));
+}
+
+bool wifi_status_refresh(void) {
+    if (rssi_sample_due()) {
+        wifi_ap_record_t ap_info;
+        last_rssi_sample = avs_time_monotonic_now();
+        if (esp_wifi_sta_get_ap_info(&ap_info) == ESP_OK) {
+            taskENTER_CRITICAL(&status_lock);
+            if (status.associated && status.rssi != ap_info.rssi) {
+                status.rssi = ap_info.rssi;
+                changed = true;
+            }
+            taskEXIT_CRITICAL(&status_lock);
+        }
+    }
+
+    taskENTER_CRITICAL(&status_lock);
+    bool result = changed;
+    changed = false;
+    taskEXIT_CRITICAL(&status_lock);
+    return result;
+}
+
+void wifi_status_set_associated(const wifi_event_sta_connected_t *event) {
+    taskENTER_CRITICAL(&status_lock);
+    status.associated = true;
+    status.channel = event->channel;
+    memcpy(status.bssid, event->bssid, sizeof(status.bssid));
+    // the event carries no RSSI, so it is sampled on the next refresh
+    rssi_sample_requested = true;
+    changed = true;
+    taskEXIT_CRITICAL(&status_lock);
+}
+
+void wifi_status_set_disconnected(void) {
+    taskENTER_CRITICAL(&status_lock);
+    if (status.associated || status.ipv4_address[0]
+            || status.ipv6_address[0]) {
+        memset(&status, 0, sizeof(status));
+        changed = true;
+    }
+    taskEXIT_CRITICAL(&status_lock);
+}
+
+void wifi_status_set_ipv4(const esp_netif_ip_info_t *ip_info) {
+    char address[WIFI_STATUS_IP_ADDRESS_MAX_SIZE];
+    char gateway[WIFI_STATUS_IP_ADDRESS_MAX_SIZE];
+    snprintf(address, sizeof(address), IPSTR, IP2STR(&ip_info->ip));
+    snprintf(gateway, sizeof(gateway), IPSTR, IP2STR(&ip_info->gw));
+
+    taskENTER_CRITICAL(&status_lock);
+    memcpy(status.ipv4_address, address, sizeof(address));
+    memcpy(status.ipv4_gateway, gateway, sizeof(gateway));
+    changed = true;
+    taskEXIT_CRITICAL(&status_lock);
+}
+
+void wifi_status_set_ipv6(const esp_ip6_addr_t *ip6_addr) {
+    char address[WIFI_STATUS_IP_ADDRESS_MAX_SIZE];
+    snprintf(address, sizeof(address), IPV6STR, IPV62STR(*ip6_addr));
+
+    taskENTER_CRITICAL(&status_lock);
+    memcpy(status.ipv6_address, address, sizeof(address));
+    changed = true;
+    taskEXIT_CRITICAL(&status_lock);
+}
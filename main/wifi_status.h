@@ -0,0 +1,65 @@
+/*
+ * Copyright 2021-2025 AVSystem <avsystem@avsystem.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef WIFI_STATUS_H
+#define WIFI_STATUS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <esp_netif_ip_addr.h>
+#include <esp_netif_types.h>
+#include <esp_wifi_types.h>
+
+// Enough for the longest address printed with IPV6STR
+#define WIFI_STATUS_IP_ADDRESS_MAX_SIZE 40
+
+typedef struct {
+    bool associated;
+    int8_t rssi;
+    uint8_t channel;
+    uint8_t bssid[6];
+    // empty strings if not assigned
+    char ipv4_address[WIFI_STATUS_IP_ADDRESS_MAX_SIZE];
+    char ipv4_gateway[WIFI_STATUS_IP_ADDRESS_MAX_SIZE];
+    char ipv6_address[WIFI_STATUS_IP_ADDRESS_MAX_SIZE];
+} wifi_status_t;
+
+/**
+ * Copies the cached link status. Never talks to the Wi-Fi driver, so it is
+ * safe to call from data model handlers.
+ */
+void wifi_status_get(wifi_status_t *out_status);
+
+/**
+ * Samples the RSSI of the current access point if the last sample is older
+ * than CONFIG_ANJAY_WIFI_STATUS_RSSI_INTERVAL seconds, or if the station has
+ * associated since. Everything else is updated by the event handlers below.
+ *
+ * @returns true if the cached values have changed since the previous call.
+ */
+bool wifi_status_refresh(void);
+
+/**
+ * Called from the Wi-Fi and IP event handlers in connect.c, on the default
+ * event loop task.
+ */
+void wifi_status_set_associated(const wifi_event_sta_connected_t *event);
+void wifi_status_set_disconnected(void);
+void wifi_status_set_ipv4(const esp_netif_ip_info_t *ip_info);
+void wifi_status_set_ipv6(const esp_ip6_addr_t *ip6_addr);
+
+#endif // WIFI_STATUS_H
@@ -0,0 +1,468 @@
+#!/usr/bin/env python3
+#
+# Copyright 2021-2025 AVSystem <avsystem@avsystem.com>
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""
+BG96 modem emulator for running the client on an ESP32 without a modem.
+
+Implements the AT subset used by the FreeRTOS cellular library and net_impl.c
+(registration queries, AT+QIDNSGIP, AT+QIOPEN/QISEND/QIRD/QICLOSE and the
++QIURC: "recv" URC) and bridges modem sockets to real UDP/TCP endpoints on
+the host, optionally adding latency and packet loss. Concatenated command
+lines ("AT+A;+B") are accepted like on the real modem, and a per-exchange
+processing delay can be set to model bring-up time.
+
+The emulator drives a serial port, e.g. a USB-UART adapter wired to the
+ESP32 in place of the BG96. On exit it prints what can be observed from the
+modem side: the number of AT exchanges, the time from the first command to
+the first successful registration query and socket open, and per-socket
+connect time, uplink/downlink volume and throughput, and the time from
+delivering downlink data to the next uplink send. It does not measure the
+client itself; net_send/net_receive and event loop figures come from the
+client's own statistics log.
+"""
+
+import argparse
+import os
+import random
+import re
+import selectors
+import socket
+import sys
+import time
+
+MAX_SOCKETS = 12
+DEFAULT_IMEI = '866425031234567'
+DEFAULT_REVISION = 'BG96MAR02A07M1G'
+LOCAL_IP = '10.0.0.2'
+
+
+class SimSocket:
+    def __init__(self, conn_id, service, host, port):
+        self.conn_id = conn_id
+        self.service = service
+        self.host = host
+        self.port = port
+        self.sock = None
+        self.rx = bytearray()
+        self.rx_datagrams = []
+        self.opened_at = time.monotonic()
+        self.connect_time = None
+        self.tx_bytes = 0
+        self.rx_bytes = 0
+        self.first_activity = None
+        self.last_activity = None
+        self.last_delivery = None
+        self.turnarounds = []
+
+    def note_activity(self):
+        now = time.monotonic()
+        if self.first_activity is None:
+            self.first_activity = now
+        self.last_activity = now
+
+    def unread(self):
+        if self.service == 'UDP':
+            return sum(len(d) for d in self.rx_datagrams)
+        return len(self.rx)
+
+
+class Emulator:
+    def __init__(self, args, fd):
+        self.args = args
+        self.fd = fd
+        self.selector = selectors.DefaultSelector()
+        self.selector.register(fd, selectors.EVENT_READ, self.on_serial)
+        self.line = bytearray()
+        self.sockets = {}
+        self.closed = []
+        self.pending = []
+        self.send_target = None
+        self.send_remaining = 0
+        self.send_buffer = bytearray()
+        self.capture = None
+        self.exchanges = 0
+        self.commands = 0
+        self.first_command_at = None
+        self.registered_at = None
+        self.first_open_at = None
+
+    # Serial side
+
+    def write(self, data):
+        if isinstance(data, str):
+            data = data.encode()
+        os.write(self.fd, data)
+        if self.args.verbose:
+            sys.stderr.write('<< %r\n' % data)
+
+    def respond(self, *lines):
+        if self.capture is not None:
+            self.capture.extend(lines)
+            return
+        for line in lines:
+            self.write('\r\n%s\r\n' % line)
+
+    def later(self, delay, callback):
+        self.pending.append((time.monotonic() + delay, callback))
+
+    def on_serial(self, _fd):
+        data = os.read(self.fd, 4096)
+        if not data:
+            raise EOFError
+        if self.args.verbose:
+            sys.stderr.write('>> %r\n' % data)
+        for byte in data:
+            if self.send_remaining:
+                self.send_buffer.append(byte)
+                self.send_remaining -= 1
+                if not self.send_remaining:
+                    self.finish_send()
+            elif byte in b'\r\n':
+                if self.line:
+                    self.on_command(self.line.decode(errors='replace'))
+                    self.line = bytearray()
+            else:
+                self.line.append(byte)
+
+    def on_command(self, line):
+        command = line.strip()
+        if not command.upper().startswith('AT'):
+            return
+        now = time.monotonic()
+        if self.first_command_at is None:
+            self.first_command_at = now
+        self.exchanges += 1
+        if self.args.command_delay_ms:
+            time.sleep(self.args.command_delay_ms / 1000.0)
+        parts = split_concatenated(command[2:])
+        if len(parts) == 1:
+            self.dispatch(parts[0])
+            return
+        # Concatenated commands share a single final result code and stop at
+        # the first failing one
+        lines = []
+        for part in parts:
+            self.capture = []
+            self.dispatch(part)
+            result, self.capture = self.capture, None
+            if result and result[-1] != 'OK':
+                self.respond(*(lines + result[-1:]))
+                return
+            lines.extend(result[:-1])
+        self.respond(*(lines + ['OK']))
+
+    def dispatch(self, body):
+        self.commands += 1
+        handler = None
+        for pattern, method in COMMANDS:
+            match = re.fullmatch(pattern, body, re.IGNORECASE)
+            if match:
+                handler = method
+                break
+        if handler:
+            handler(self, *match.groups())
+        else:
+            self.respond('OK')
+
+    # Generic queries used during bring-up
+
+    def cmd_ok(self):
+        self.respond('OK')
+
+    def cmd_cpin(self):
+        self.respond('+CPIN: READY', 'OK')
+
+    def cmd_reg(self, which):
+        if self.registered_at is None:
+            self.registered_at = time.monotonic()
+        self.respond('+C%sREG: 0,1' % which.upper(), 'OK')
+
+    def cmd_cops(self):
+        self.respond('+COPS: 0,0,"SIMULATOR",8', 'OK')
+
+    def cmd_csq(self):
+        self.respond('+CSQ: 20,99', 'OK')
+
+    def cmd_imei(self):
+        self.respond(DEFAULT_IMEI, 'OK')
+
+    def cmd_revision(self):
+        self.respond(DEFAULT_REVISION, 'OK')
+
+    def cmd_qiact_query(self):
+        self.respond('+QIACT: 1,1,1,"%s"' % LOCAL_IP, 'OK')
+
+    def cmd_cgpaddr(self, _args):
+        self.respond('+CGPADDR: 1,"%s"' % LOCAL_IP, 'OK')
+
+    # DNS
+
+    def cmd_dns(self, _ctx, host):
+        self.respond('OK')
+        try:
+            addresses = sorted({info[4][0] for info in socket.getaddrinfo(
+                host, None, socket.AF_INET)})
+        except socket.gaierror:
+            self.later(self.delay(), lambda: self.respond(
+                '+QIURC: "dnsgip",565'))
+            return
+
+        def deliver():
+            self.respond('+QIURC: "dnsgip",0,%d,600' % len(addresses))
+            for address in addresses:
+                self.respond('+QIURC: "dnsgip","%s"' % address)
+        self.later(self.delay(), deliver)
+
+    # Sockets
+
+    def cmd_qiopen(self, _ctx, conn_id, service, host, port, _rest):
+        conn_id = int(conn_id)
+        if conn_id >= MAX_SOCKETS or conn_id in self.sockets:
+            self.respond('ERROR')
+            return
+        self.respond('OK')
+        if self.first_open_at is None:
+            self.first_open_at = time.monotonic()
+        sim = SimSocket(conn_id, service.upper(), host, int(port))
+        try:
+            if sim.service == 'TCP':
+                sim.sock = socket.create_connection((host, sim.port),
+                                                    timeout=10)
+            else:
+                sim.sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+                sim.sock.connect((host, sim.port))
+            sim.sock.setblocking(False)
+        except OSError:
+            self.later(self.delay(), lambda: self.respond(
+                '+QIOPEN: %d,566' % conn_id))
+            return
+        self.sockets[conn_id] = sim
+        self.selector.register(sim.sock, selectors.EVENT_READ,
+                               lambda _s, sim=sim: self.on_network(sim))
+
+        def opened():
+            sim.connect_time = time.monotonic() - sim.opened_at
+            self.respond('+QIOPEN: %d,0' % conn_id)
+        self.later(self.delay(), opened)
+
+    def cmd_qisend(self, conn_id, length):
+        sim = self.sockets.get(int(conn_id))
+        if not sim:
+            self.respond('ERROR')
+            return
+        self.send_target = sim
+        self.send_remaining = int(length)
+        self.send_buffer = bytearray()
+        self.write('\r\n> ')
+
+    def finish_send(self):
+        sim = self.send_target
+        payload = bytes(self.send_buffer)
+        sim.tx_bytes += len(payload)
+        sim.note_activity()
+        if sim.last_delivery is not None:
+            sim.turnarounds.append(time.monotonic() - sim.last_delivery)
+            sim.last_delivery = None
+        self.respond('SEND OK')
+        if random.random() < self.args.loss:
+            return
+
+        def transmit():
+            try:
+                sim.sock.send(payload)
+            except OSError:
+                pass
+        self.later(self.delay(), transmit)
+
+    def cmd_qird(self, conn_id, length):
+        sim = self.sockets.get(int(conn_id))
+        if not sim:
+            self.respond('ERROR')
+            return
+        length = int(length)
+        if length == 0:
+            unread = sim.unread()
+            self.respond('+QIRD: %d,%d,%d' % (sim.rx_bytes, sim.rx_bytes
+                                              - unread, unread), 'OK')
+            return
+        if sim.service == 'UDP':
+            data = sim.rx_datagrams.pop(0)[:length] \
+                if sim.rx_datagrams else b''
+        else:
+            data = bytes(sim.rx[:length])
+            del sim.rx[:length]
+        self.write('\r\n+QIRD: %d\r\n' % len(data))
+        self.write(data)
+        self.respond('OK')
+        if data:
+            sim.last_delivery = time.monotonic()
+
+    def cmd_qiclose(self, conn_id, _timeout):
+        sim = self.sockets.pop(int(conn_id), None)
+        if sim:
+            self.selector.unregister(sim.sock)
+            sim.sock.close()
+            self.closed.append(sim)
+        self.respond('OK')
+
+    def on_network(self, sim):
+        try:
+            data = sim.sock.recv(65535)
+        except OSError:
+            return
+        if not data and sim.service == 'TCP':
+            self.selector.unregister(sim.sock)
+            self.respond('+QIURC: "closed",%d' % sim.conn_id)
+            return
+        if random.random() < self.args.loss:
+            return
+
+        def deliver():
+            if sim.conn_id not in self.sockets:
+                return
+            notify = sim.unread() == 0
+            if sim.service == 'UDP':
+                sim.rx_datagrams.append(data)
+            else:
+                sim.rx += data
+            sim.rx_bytes += len(data)
+            sim.note_activity()
+            # Like the real modem, the URC is only repeated once the buffer
+            # has been drained
+            if notify:
+                self.respond('+QIURC: "recv",%d' % sim.conn_id)
+        self.later(self.delay(), deliver)
+
+    # Main loop
+
+    def delay(self):
+        return max(0.0, random.gauss(self.args.latency_ms,
+                                     self.args.jitter_ms) / 1000.0)
+
+    def run(self):
+        while True:
+            timeout = None
+            if self.pending:
+                timeout = max(0.0, min(t for t, _ in self.pending)
+                              - time.monotonic())
+            for key, _ in self.selector.select(timeout):
+                key.data(key.fileobj)
+            now = time.monotonic()
+            due = [p for p in self.pending if p[0] <= now]
+            self.pending = [p for p in self.pending if p[0] > now]
+            for _, callback in sorted(due, key=lambda p: p[0]):
+                callback()
+
+    def report(self):
+        def since_first(timestamp):
+            if timestamp is None or self.first_command_at is None:
+                return '-'
+            return '%.0fms' % ((timestamp - self.first_command_at) * 1000)
+
+        print('AT exchanges %d (%d commands), registered after %s, first '
+              'socket opened after %s' % (
+                  self.exchanges, self.commands,
+                  since_first(self.registered_at),
+                  since_first(self.first_open_at)))
+        print('%-4s %-5s %-22s %10s %10s %10s %12s %12s' % (
+            'id', 'type', 'remote', 'connect', 'tx', 'rx', 'throughput',
+            'turnaround'))
+        for sim in self.closed + list(self.sockets.values()):
+            active = (sim.last_activity or 0) - (sim.first_activity or 0)
+            throughput = (sim.tx_bytes + sim.rx_bytes) / active \
+                if active > 0 else 0
+            turnaround = sorted(sim.turnarounds)
+            median = turnaround[len(turnaround) // 2] * 1000 \
+                if turnaround else 0
+            print('%-4d %-5s %-22s %8.0fms %10d %10d %10.0fB/s %10.1fms' % (
+                sim.conn_id, sim.service, '%s:%d' % (sim.host, sim.port),
+                (sim.connect_time or 0) * 1000, sim.tx_bytes, sim.rx_bytes,
+                throughput, median))
+
+
+def split_concatenated(body):
+    """Splits "+A=1;+B" into commands, ignoring separators in quotes."""
+    parts = []
+    current = ''
+    quoted = False
+    for char in body:
+        if char == '"':
+            quoted = not quoted
+        if char == ';' and not quoted:
+            parts.append(current)
+            current = ''
+        else:
+            current += char
+    parts.append(current)
+    return parts
+
+
+COMMANDS = [
+    (r'', Emulator.cmd_ok),
+    (r'\+CPIN\?', Emulator.cmd_cpin),
+    (r'\+C(E|G|)REG\?', Emulator.cmd_reg),
+    (r'\+COPS\?', Emulator.cmd_cops),
+    (r'\+CSQ', Emulator.cmd_csq),
+    (r'\+(?:CGSN|GSN)', Emulator.cmd_imei),
+    (r'\+(?:CGMR|QGMR|GMR)', Emulator.cmd_revision),
+    (r'\+QIACT\?', Emulator.cmd_qiact_query),
+    (r'\+CGPADDR(.*)', Emulator.cmd_cgpaddr),
+    (r'\+QIDNSGIP=(\d+),"([^"]+)"', Emulator.cmd_dns),
+    (r'\+QIOPEN=(\d+),(\d+),"(UDP|TCP)","([^"]+)",(\d+)(.*)',
+     Emulator.cmd_qiopen),
+    (r'\+QISEND=(\d+),(\d+)', Emulator.cmd_qisend),
+    (r'\+QIRD=(\d+),(\d+)', Emulator.cmd_qird),
+    (r'\+QICLOSE=(\d+)(,\d+)?', Emulator.cmd_qiclose),
+]
+
+
+def open_port(args):
+    import serial  # pyserial
+    port = serial.Serial(args.serial, args.baud_rate, rtscts=args.rtscts)
+    return port.fileno(), port
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().split(
+        '\n')[0])
+    parser.add_argument('--serial', required=True,
+                        help='serial port wired to the ESP32 modem UART')
+    parser.add_argument('--baud-rate', type=int, default=115200)
+    parser.add_argument('--rtscts', action='store_true')
+    parser.add_argument('--latency-ms', type=float, default=0.0,
+                        help='one-way radio latency added to every event')
+    parser.add_argument('--jitter-ms', type=float, default=0.0)
+    parser.add_argument('--loss', type=float, default=0.0,
+                        help='probability of dropping a packet, 0..1')
+    parser.add_argument('--command-delay-ms', type=float, default=0.0,
+                        help='modem processing time of every AT exchange')
+    parser.add_argument('--seed', type=int)
+    parser.add_argument('-v', '--verbose', action='store_true')
+    args = parser.parse_args()
+    random.seed(args.seed)
+
+    fd, _keepalive = open_port(args)
+    emulator = Emulator(args, fd)
+    try:
+        emulator.run()
+    except (KeyboardInterrupt, EOFError):
+        pass
+    finally:
+        emulator.report()
+
+
+if __name__ == '__main__':
+    main()